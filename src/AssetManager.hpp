@@ -0,0 +1,320 @@
+#pragma once
+
+// --- Includes ---
+// sf::Image, sf::Texture and sf::Font, the assets loaded here.
+#include <SFML/Graphics.hpp>
+// Levels and the level file reader.
+#include "Level.hpp"
+#include "LevelFile.hpp"
+// TRACE_SCOPE and TRACE_THREAD_NAME, which show loading in traces.
+#include "Trace.hpp"
+// HeapTagScope, which charges a load's allocations to the subsystem that asked for it.
+#include "HeapStats.hpp"
+// This header provides std::chrono::steady_clock, which times the per-frame budget.
+#include <chrono>
+// This header provides std::uint8_t for file contents.
+#include <cstdint>
+// This header provides std::filesystem::path.
+#include <filesystem>
+// This header provides std::ifstream, used to read asset files.
+#include <fstream>
+// This header provides std::function, which holds generators and finishing steps.
+#include <functional>
+// This header provides std::async and std::future, which run the loads on worker threads.
+#include <future>
+// This header provides std::shared_ptr, which counts the references to each asset.
+#include <memory>
+// This header provides std::string.
+#include <string>
+// This header provides std::unordered_map, which finds assets by path.
+#include <unordered_map>
+// This header provides std::vector.
+#include <vector>
+
+// --- Asset Loading ---
+//
+// Loading an asset has a slow part that any thread can do (reading the file,
+// decoding a PNG, parsing a level) and, for textures, a part that must happen
+// on the thread that draws (uploading the pixels to the GPU). AssetManager
+// runs the first part on a worker thread as soon as an asset is asked for and
+// hands back a handle right away; update(), called once a frame on the main
+// thread, does the second part for the assets that are decoded, within a time
+// budget, so a burst of finished loads never stalls a frame. Until then the
+// handle's asset isn't ready and the game draws without it.
+//
+// Assets are shared: asking for a path that was asked for before returns the
+// same asset (loaded or still loading), and an asset lives as long as any
+// handle to it, until collectUnused() drops it.
+
+// Where an asset is: still loading, ready to use, or failed for good.
+enum class AssetState { Loading, Ready, Failed };
+
+// How a texture is sampled (applied when it is created).
+struct TextureSettings {
+    bool repeated = false;
+    bool smooth = false;
+};
+
+// The decoded form of each kind of asset, which the worker thread fills, and
+// the main thread's step that turns it into the asset.
+template <typename T>
+struct AssetData;
+
+template <>
+struct AssetData<sf::Texture> {
+    sf::Image image;
+    TextureSettings settings;
+
+    bool finish(sf::Texture& texture, std::string& error) {
+        if (!texture.loadFromImage(image)) {
+            error = "could not create a texture";
+            return false;
+        }
+        texture.setRepeated(settings.repeated);
+        texture.setSmooth(settings.smooth);
+        image = sf::Image(); // The pixels are on the GPU now.
+        return true;
+    }
+};
+
+template <>
+struct AssetData<sf::Font> {
+    // sf::Font reads glyphs from the file's contents for as long as it lives.
+    std::vector<std::uint8_t> bytes;
+
+    bool finish(sf::Font& font, std::string& error) {
+        if (!font.openFromMemory(bytes.data(), bytes.size())) {
+            error = "not a font file";
+            return false;
+        }
+        return true;
+    }
+};
+
+template <>
+struct AssetData<Level> {
+    Level level;
+
+    bool finish(Level& out, std::string&) {
+        out = std::move(level);
+        return true;
+    }
+};
+
+// One asset and its loading state, shared by the manager and the handles.
+template <typename T>
+struct AssetRecord {
+    std::string key;   // The normalized path (or a generator's name).
+    AssetState state = AssetState::Loading;
+    T asset;
+    AssetData<T> data; // Written by the worker thread while loading.
+    std::string error; // Why loading failed.
+};
+
+// A reference to a shared asset. Use it on the main thread only (that is
+// where update() changes the asset's state).
+template <typename T>
+class Asset {
+public:
+    Asset() = default;
+
+    // An empty handle counts as failed.
+    AssetState state() const { return record ? record->state : AssetState::Failed; }
+    bool ready() const { return state() == AssetState::Ready; }
+    bool failed() const { return state() == AssetState::Failed; }
+
+    // The asset, or nullptr while it isn't ready.
+    const T* get() const { return ready() ? &record->asset : nullptr; }
+
+    // Why the asset failed to load (empty unless failed()).
+    const std::string& error() const {
+        static const std::string NONE;
+        return record && record->state == AssetState::Failed ? record->error : NONE;
+    }
+
+    const std::string& key() const {
+        static const std::string NONE;
+        return record ? record->key : NONE;
+    }
+
+private:
+    friend class AssetManager;
+    explicit Asset(std::shared_ptr<AssetRecord<T>> record) : record(std::move(record)) {}
+
+    std::shared_ptr<AssetRecord<T>> record;
+};
+
+// Reads a whole file. On failure returns false and describes the problem in `error`.
+inline bool readAssetFile(const std::filesystem::path& path, std::vector<std::uint8_t>& bytes, std::string& error) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        error = "could not open '" + path.string() + "'";
+        return false;
+    }
+    bytes.resize((std::size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize)bytes.size())) {
+        error = "could not read '" + path.string() + "'";
+        return false;
+    }
+    return true;
+}
+
+// --- Asset Manager ---
+
+class AssetManager {
+public:
+    AssetManager() = default;
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+    // Waits for the loads still running (their futures do, when destroyed).
+    ~AssetManager() = default;
+
+    // Starts loading a texture from an image file (PNG, JPEG, BMP, ...).
+    Asset<sf::Texture> texture(const std::filesystem::path& path, TextureSettings settings = {}) {
+        return request<sf::Texture>(assetKey(path), [path, settings](AssetData<sf::Texture>& data, std::string& error) {
+            std::vector<std::uint8_t> bytes;
+            if (!readAssetFile(path, bytes, error)) return false;
+            data.settings = settings;
+            if (!data.image.loadFromMemory(bytes.data(), bytes.size())) {
+                error = "could not decode the image '" + path.string() + "'";
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Starts making a texture from a generated image; `key` names it, so asking
+    // for the same key again shares it. `generate` runs on a worker thread.
+    Asset<sf::Texture> generatedTexture(const std::string& key, std::function<sf::Image()> generate,
+                                        TextureSettings settings = {}) {
+        return request<sf::Texture>(key, [generate, settings](AssetData<sf::Texture>& data, std::string&) {
+            data.image = generate();
+            data.settings = settings;
+            return true;
+        });
+    }
+
+    // Starts loading a font file (TTF, OTF, ...).
+    Asset<sf::Font> font(const std::filesystem::path& path) {
+        return request<sf::Font>(assetKey(path), [path](AssetData<sf::Font>& data, std::string& error) {
+            return readAssetFile(path, data.bytes, error);
+        });
+    }
+
+    // Starts loading a level file (see LevelFile.hpp).
+    Asset<Level> level(const std::filesystem::path& path) {
+        return request<Level>(assetKey(path), [path](AssetData<Level>& data, std::string& error) {
+            return loadLevelFile(path, data.level, error);
+        });
+    }
+
+    // Finishes decoded assets (creating textures, opening fonts) in the order
+    // they were asked for, until `budget` is used up. At least one is finished
+    // per call if any is decoded, so even an upload larger than the budget
+    // gets done. Call once a frame on the main thread; returns how many
+    // assets it finished.
+    std::size_t update(std::chrono::microseconds budget) {
+        TRACE_SCOPE("finish assets");
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t finished = 0;
+        for (std::size_t i = 0; i < pending.size();) {
+            if (pending[i].decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++i;
+                continue;
+            }
+            pending[i].finish(pending[i].decoded.get());
+            pending.erase(pending.begin() + (std::ptrdiff_t)i);
+            ++finished;
+            if (std::chrono::steady_clock::now() - start >= budget) break;
+        }
+        return finished;
+    }
+
+    // Waits for every load in progress and finishes it, ignoring the budget
+    // (for tools and benchmarks, or a loading screen).
+    void finishAll() {
+        for (PendingAsset& job : pending) job.finish(job.decoded.get());
+        pending.clear();
+    }
+
+    // Drops the assets no handle refers to any more (a load in progress keeps
+    // its asset). Returns how many were dropped. A failed asset stays until
+    // then too, so asking for it again doesn't retry every frame.
+    std::size_t collectUnused() {
+        return collect(textures) + collect(fonts) + collect(levels);
+    }
+
+    // Assets still loading or waiting for update() to finish them.
+    std::size_t pendingCount() const { return pending.size(); }
+    // Assets held, in any state.
+    std::size_t assetCount() const { return textures.size() + fonts.size() + levels.size(); }
+
+private:
+    template <typename T>
+    using Table = std::unordered_map<std::string, std::shared_ptr<AssetRecord<T>>>;
+
+    // A load in progress: the worker's result and the main thread's step.
+    struct PendingAsset {
+        std::future<bool> decoded;
+        std::function<void(bool)> finish;
+    };
+
+    Table<sf::Texture> textures;
+    Table<sf::Font> fonts;
+    Table<Level> levels;
+    std::vector<PendingAsset> pending; // In the order they were asked for.
+
+    Table<sf::Texture>& table(sf::Texture*) { return textures; }
+    Table<sf::Font>& table(sf::Font*) { return fonts; }
+    Table<Level>& table(Level*) { return levels; }
+
+    // "levels/../levels/a.txt" and "levels/a.txt" are the same asset.
+    static std::string assetKey(const std::filesystem::path& path) {
+        return path.lexically_normal().generic_string();
+    }
+
+    // Returns the asset named `key`, starting a load with `decode` if there is
+    // none yet. `decode` fills the asset's AssetData on a worker thread.
+    template <typename T, typename Decode>
+    Asset<T> request(const std::string& key, Decode decode) {
+        Table<T>& assets = table((T*)nullptr);
+        const auto found = assets.find(key);
+        if (found != assets.end()) return Asset<T>(found->second);
+
+        auto record = std::make_shared<AssetRecord<T>>();
+        record->key = key;
+        assets.emplace(key, record);
+        // The worker and the finishing step charge their allocations to the
+        // caller's subsystem, as WorkerPool jobs do.
+        const HeapTag tag = currentHeapTag;
+        PendingAsset job;
+        job.decoded = std::async(std::launch::async, [record, decode, tag]() {
+            TRACE_THREAD_NAME("asset loader");
+            TRACE_SCOPE("decode asset");
+            HeapTagScope heapTag(tag);
+            return decode(record->data, record->error);
+        });
+        job.finish = [record, tag](bool decoded) {
+            HeapTagScope heapTag(tag);
+            const bool finished = decoded && record->data.finish(record->asset, record->error);
+            record->state = finished ? AssetState::Ready : AssetState::Failed;
+        };
+        pending.push_back(std::move(job));
+        return Asset<T>(record);
+    }
+
+    template <typename T>
+    static std::size_t collect(Table<T>& assets) {
+        std::size_t dropped = 0;
+        for (auto it = assets.begin(); it != assets.end();) {
+            if (it->second.use_count() == 1) {
+                it = assets.erase(it);
+                ++dropped;
+            } else {
+                ++it;
+            }
+        }
+        return dropped;
+    }
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+// --- Includes ---
+// Tile types, CHUNK_SIZE and the dense Level (for conversions).
+#include "Level.hpp"
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides std::array, the tile storage of one chunk.
+#include <array>
+// This header provides fixed-width integer types for the hash map keys.
+#include <cstdint>
+// This header provides std::unique_ptr; chunks never move once allocated.
+#include <memory>
+// This header provides std::vector.
+#include <vector>
+
+// --- Chunked World ---
+
+// Tile storage for levels without fixed bounds. The world is split into
+// CHUNK_SIZE x CHUNK_SIZE chunks, and only chunks that contain at least one
+// non-Air tile exist: open sky costs nothing, and the world can grow in any
+// direction, including negative coordinates.
+//
+// Chunks are found through an open-addressing hash map keyed by chunk
+// coordinate (linear probing in one flat array, no per-entry allocation).
+// Gameplay code mostly reads tiles close to the last one it read, so getTile
+// first checks a one-entry cache of the last chunk it looked up (including
+// "no chunk here"), which skips the hash lookup most of the time.
+//
+// The cache makes getTile a write to the world, so one world must not be read
+// from several threads at once.
+class ChunkedWorld {
+public:
+    // CHUNK_SIZE as a shift, so world -> chunk coordinates is a shift and a
+    // mask that round towards negative infinity (-1 is in chunk -1, not 0).
+    static constexpr int CHUNK_SHIFT = 4;
+    static_assert((1 << CHUNK_SHIFT) == CHUNK_SIZE, "CHUNK_SHIFT must match CHUNK_SIZE");
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr int CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+
+    // One allocated chunk.
+    struct Chunk {
+        std::array<TileType, CHUNK_TILES> tiles{}; // Row by row; all Air to start with.
+        int cx = 0;                // Chunk coordinates.
+        int cy = 0;
+        int nonAirCount = 0;       // The chunk is freed when this drops to 0.
+        unsigned int revision = 0; // See getChunkRevision.
+    };
+
+    // Returns the tile at (x, y); Air anywhere no chunk exists.
+    TileType getTile(int x, int y) const {
+        const Chunk* chunk = findChunkCached(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+        if (chunk == nullptr) return Air;
+        return chunk->tiles[(y & CHUNK_MASK) * CHUNK_SIZE + (x & CHUNK_MASK)];
+    }
+
+    // Changes the tile at (x, y), allocating its chunk if needed and freeing
+    // the chunk when its last non-Air tile is removed.
+    void setTile(int x, int y, TileType type) {
+        const int cx = x >> CHUNK_SHIFT;
+        const int cy = y >> CHUNK_SHIFT;
+        Chunk* chunk = const_cast<Chunk*>(findChunkCached(cx, cy));
+        if (chunk == nullptr) {
+            if (type == Air) return; // Already Air; nothing to store.
+            chunk = createChunk(cx, cy);
+        }
+        TileType& cell = chunk->tiles[(y & CHUNK_MASK) * CHUNK_SIZE + (x & CHUNK_MASK)];
+        if (cell == type) return;
+        chunk->nonAirCount += (type != Air) - (cell != Air);
+        cell = type;
+        chunk->revision = ++revisionCounter;
+        if (chunk->nonAirCount == 0) eraseChunk(cx, cy);
+    }
+
+    // Returns the change counter of chunk (cx, cy), like Level::getChunkRevision.
+    // Chunks that don't exist report 0, so a cache that built a chunk before it
+    // was freed sees a different revision and rebuilds it (as empty).
+    unsigned int getChunkRevision(int cx, int cy) const {
+        const Chunk* chunk = findChunkCached(cx, cy);
+        return chunk != nullptr ? chunk->revision : 0;
+    }
+
+    // Number of allocated (non-empty) chunks.
+    std::size_t chunkCount() const { return chunks.size(); }
+
+    // Number of non-Air tiles in the whole world.
+    std::size_t nonAirTiles() const {
+        std::size_t count = 0;
+        for (const auto& chunk : chunks) count += (std::size_t)chunk->nonAirCount;
+        return count;
+    }
+
+    // Calls `visit(const Chunk&)` for every allocated chunk, in no particular order.
+    template <typename Visitor>
+    void forEachChunk(Visitor&& visit) const {
+        for (const auto& chunk : chunks) visit(*chunk);
+    }
+
+    // Tile coordinates of the smallest chunk-aligned box that contains every
+    // allocated chunk: [min, max). Both are {0, 0} for an empty world.
+    void getBounds(sf::Vector2i& min, sf::Vector2i& max) const {
+        if (chunks.empty()) {
+            min = max = {0, 0};
+            return;
+        }
+        min = {chunks[0]->cx, chunks[0]->cy};
+        max = min;
+        for (const auto& chunk : chunks) {
+            min = {std::min(min.x, chunk->cx), std::min(min.y, chunk->cy)};
+            max = {std::max(max.x, chunk->cx), std::max(max.y, chunk->cy)};
+        }
+        min *= CHUNK_SIZE;
+        max = (max + sf::Vector2i(1, 1)) * CHUNK_SIZE;
+    }
+
+    // Approximate heap memory used by the world, in bytes.
+    std::size_t memoryBytes() const {
+        return chunks.size() * sizeof(Chunk) + chunks.capacity() * sizeof(chunks[0]) + slots.size() * sizeof(Slot);
+    }
+
+    // Removes every chunk.
+    void clear() {
+        chunks.clear();
+        slots.clear();
+        cachedChunk = nullptr;
+        cachedKey = NO_KEY;
+    }
+
+private:
+    // One entry of the hash map: a packed chunk coordinate and the index of
+    // the chunk in `chunks`.
+    struct Slot {
+        std::uint64_t key = 0;
+        std::uint32_t index = EMPTY;
+    };
+    static constexpr std::uint32_t EMPTY = 0xFFFFFFFFu;
+    // Marks the last-chunk cache as empty. No chunk coordinate packs to this
+    // (it would need cy = INT_MAX, far beyond any tile coordinate / 16).
+    static constexpr std::uint64_t NO_KEY = ~0ull;
+
+    std::vector<std::unique_ptr<Chunk>> chunks; // Live chunks, densely packed.
+    std::vector<Slot> slots;                    // Power-of-two sized, at most half full.
+    unsigned int revisionCounter = 0;
+    // The last-chunk cache: the key last looked up and its chunk (or nullptr).
+    mutable std::uint64_t cachedKey = NO_KEY;
+    mutable const Chunk* cachedChunk = nullptr;
+
+    static std::uint64_t packKey(int cx, int cy) {
+        // The top bit of the y half is flipped so that no real key equals NO_KEY.
+        return ((std::uint64_t)(std::uint32_t)cx << 32) | ((std::uint32_t)cy ^ 0x80000000u);
+    }
+
+    // Fibonacci hashing: multiplying by 2^64 / golden ratio spreads nearby
+    // chunk coordinates across the upper bits, which pick the slot.
+    std::size_t slotFor(std::uint64_t key) const {
+        const std::uint64_t mixed = key * 0x9E3779B97F4A7C15ull;
+        return (std::size_t)(mixed >> 32) & (slots.size() - 1);
+    }
+
+    const Chunk* findChunkCached(int cx, int cy) const {
+        const std::uint64_t key = packKey(cx, cy);
+        if (key == cachedKey) return cachedChunk;
+        cachedKey = key;
+        cachedChunk = findChunk(key);
+        return cachedChunk;
+    }
+
+    const Chunk* findChunk(std::uint64_t key) const {
+        if (slots.empty()) return nullptr;
+        for (std::size_t i = slotFor(key);; i = (i + 1) & (slots.size() - 1)) {
+            const Slot& slot = slots[i];
+            if (slot.index == EMPTY) return nullptr;
+            if (slot.key == key) return chunks[slot.index].get();
+        }
+    }
+
+    // Returns the slot holding `key` (which must be present).
+    std::size_t findSlot(std::uint64_t key) const {
+        std::size_t i = slotFor(key);
+        while (slots[i].key != key || slots[i].index == EMPTY) i = (i + 1) & (slots.size() - 1);
+        return i;
+    }
+
+    void insertSlot(std::uint64_t key, std::uint32_t index) {
+        std::size_t i = slotFor(key);
+        while (slots[i].index != EMPTY) i = (i + 1) & (slots.size() - 1);
+        slots[i] = {key, index};
+    }
+
+    Chunk* createChunk(int cx, int cy) {
+        // Keep the table at most half full so probe sequences stay short.
+        if ((chunks.size() + 1) * 2 > slots.size()) {
+            slots.assign(slots.empty() ? 64 : slots.size() * 2, Slot());
+            for (std::uint32_t i = 0; i < chunks.size(); ++i) insertSlot(packKey(chunks[i]->cx, chunks[i]->cy), i);
+        }
+        auto chunk = std::make_unique<Chunk>();
+        chunk->cx = cx;
+        chunk->cy = cy;
+        const std::uint64_t key = packKey(cx, cy);
+        insertSlot(key, (std::uint32_t)chunks.size());
+        chunks.push_back(std::move(chunk));
+        cachedKey = key;
+        cachedChunk = chunks.back().get();
+        return chunks.back().get();
+    }
+
+    void eraseChunk(int cx, int cy) {
+        const std::uint64_t key = packKey(cx, cy);
+        std::size_t hole = findSlot(key);
+        const std::uint32_t index = slots[hole].index;
+
+        // Backward-shift deletion: move later entries of the probe sequence
+        // into the hole, so lookups never need tombstones.
+        slots[hole].index = EMPTY;
+        for (std::size_t i = (hole + 1) & (slots.size() - 1); slots[i].index != EMPTY; i = (i + 1) & (slots.size() - 1)) {
+            const std::size_t home = slotFor(slots[i].key);
+            // Move the entry if its home slot is not between the hole and i (cyclically).
+            const bool homeInRange = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+            if (!homeInRange) {
+                slots[hole] = slots[i];
+                slots[i].index = EMPTY;
+                hole = i;
+            }
+        }
+
+        // Swap-remove the chunk itself and point its replacement's slot at the new index.
+        if (index + 1 != chunks.size()) {
+            chunks[index] = std::move(chunks.back());
+            slots[findSlot(packKey(chunks[index]->cx, chunks[index]->cy))].index = index;
+        }
+        chunks.pop_back();
+        if (cachedKey == key) cachedChunk = nullptr;
+    }
+};
+
+// --- Conversions ---
+
+// Copies a dense level into a chunked world, with the level's top-left tile
+// at `origin` (which may be negative).
+inline ChunkedWorld worldFromLevel(const Level& level, sf::Vector2i origin = {0, 0}) {
+    ChunkedWorld world;
+    for (unsigned int y = 0; y < level.size.y; ++y) {
+        for (unsigned int x = 0; x < level.size.x; ++x) {
+            const TileType tile = level.tiles[(std::size_t)y * level.size.x + x];
+            if (tile != Air) world.setTile(origin.x + (int)x, origin.y + (int)y, tile);
+        }
+    }
+    return world;
+}
+
+// Copies the part of a chunked world that contains tiles into a dense level.
+// `origin` receives the world coordinates of the level's top-left tile.
+inline Level levelFromWorld(const ChunkedWorld& world, sf::Vector2i& origin) {
+    sf::Vector2i max;
+    world.getBounds(origin, max);
+    Level level;
+    level.resize({(unsigned int)(max.x - origin.x), (unsigned int)(max.y - origin.y)});
+    world.forEachChunk([&](const ChunkedWorld::Chunk& chunk) {
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (int x = 0; x < CHUNK_SIZE; ++x) {
+                const int lx = chunk.cx * CHUNK_SIZE + x - origin.x;
+                const int ly = chunk.cy * CHUNK_SIZE + y - origin.y;
+                level.tiles[(std::size_t)ly * level.size.x + lx] = chunk.tiles[y * CHUNK_SIZE + x];
+            }
+        }
+    });
+    return level;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+// --- Includes ---
+// This header provides std::atomic for the lock-free queue indices.
+#include <atomic>
+// This header provides std::size_t.
+#include <cstddef>
+// This header provides std::function, used to store subscribers.
+#include <functional>
+// This header provides std::unique_ptr; queues never move once created.
+#include <memory>
+// This header provides std::tuple, which holds one batch/subscriber list per event type.
+#include <tuple>
+// This header provides std::decay_t.
+#include <type_traits>
+// This header provides std::variant, which holds any one event in a queue slot.
+#include <variant>
+// This header provides std::vector.
+#include <vector>
+
+// --- Event Bus ---
+
+// A typed event bus for gameplay events. Producers (the player simulation,
+// worker threads, ...) push events during the tick; consumers (particles,
+// HUD, telemetry, audio, ...) subscribe to the event types they care about
+// and receive them in batches when the owner calls dispatch() at a fixed
+// point of the frame. Neither side knows about the other.
+//
+// Every producing thread gets its own Queue: a fixed-size single-producer /
+// single-consumer ring buffer, so pushing an event is a copy and two atomic
+// operations, with no locks and no allocation. dispatch() (on the consumer
+// thread) drains all queues into one batch per event type, reusing the same
+// vectors every frame, and hands each subscriber its whole batch at once.
+//
+// Events pushed by subscribers while dispatch() runs are delivered at the
+// next dispatch().
+template <typename... Events>
+class EventBus {
+public:
+    // Any one event.
+    using Event = std::variant<Events...>;
+
+    // The queue of one producing thread. Only that thread may push.
+    class Queue {
+    public:
+        explicit Queue(std::size_t capacityPowerOfTwo) : slots(capacityPowerOfTwo), mask(capacityPowerOfTwo - 1) {}
+
+        // Appends an event. When the queue is full (the consumer fell far
+        // behind) the event is dropped and counted instead of blocking.
+        template <typename E>
+        bool push(const E& event) {
+            const std::size_t tail = tailIndex.load(std::memory_order_relaxed);
+            if (tail - headIndex.load(std::memory_order_acquire) == slots.size()) {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            slots[tail & mask] = event;
+            tailIndex.store(tail + 1, std::memory_order_release); // Publish the slot.
+            return true;
+        }
+
+        // Number of events dropped because the queue was full.
+        std::size_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+    private:
+        friend class EventBus;
+
+        // Consumer side: calls `visit(event)` for every queued event.
+        template <typename Visitor>
+        void drain(Visitor&& visit) {
+            std::size_t head = headIndex.load(std::memory_order_relaxed);
+            const std::size_t tail = tailIndex.load(std::memory_order_acquire);
+            for (; head != tail; ++head) visit(slots[head & mask]);
+            headIndex.store(head, std::memory_order_release); // Free the slots.
+        }
+
+        std::vector<Event> slots;
+        std::size_t mask;
+        // Producer and consumer indices on separate cache lines, so the two
+        // threads don't keep stealing the line from each other.
+        alignas(64) std::atomic<std::size_t> tailIndex{0};
+        alignas(64) std::atomic<std::size_t> headIndex{0};
+        std::atomic<std::size_t> droppedCount{0};
+    };
+
+    // Creates a queue for one producing thread. Call during setup, before
+    // any thread produces or dispatch() runs. `capacity` must be a power of two.
+    Queue& createQueue(std::size_t capacity = 1024) {
+        queues.push_back(std::make_unique<Queue>(capacity));
+        return *queues.back();
+    }
+
+    // Registers `handler(const E* events, std::size_t count)`, called once per
+    // dispatch() that has at least one E, with all of them in push order per queue.
+    template <typename E, typename Handler>
+    void subscribe(Handler&& handler) {
+        std::get<std::vector<BatchHandler<E>>>(subscribers).emplace_back(std::forward<Handler>(handler));
+    }
+
+    // Delivers everything queued since the last call. Call from one thread only.
+    void dispatch() {
+        for (auto& queue : queues) {
+            queue->drain([this](const Event& event) {
+                std::visit([this](const auto& e) { batchFor<std::decay_t<decltype(e)>>().push_back(e); }, event);
+            });
+        }
+        (deliver<Events>(), ...);
+    }
+
+    // Total events dropped by all queues (see Queue::push).
+    std::size_t dropped() const {
+        std::size_t count = 0;
+        for (const auto& queue : queues) count += queue->dropped();
+        return count;
+    }
+
+private:
+    template <typename E>
+    using BatchHandler = std::function<void(const E*, std::size_t)>;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::tuple<std::vector<Events>...> batches;                    // Reused every dispatch.
+    std::tuple<std::vector<BatchHandler<Events>>...> subscribers;
+
+    template <typename E>
+    std::vector<E>& batchFor() { return std::get<std::vector<E>>(batches); }
+
+    template <typename E>
+    void deliver() {
+        std::vector<E>& batch = batchFor<E>();
+        if (batch.empty()) return;
+        for (const auto& handler : std::get<std::vector<BatchHandler<E>>>(subscribers)) handler(batch.data(), batch.size());
+        batch.clear(); // Keeps the capacity: no allocation next frame.
+    }
+};
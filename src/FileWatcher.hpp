@@ -0,0 +1,93 @@
+#pragma once
+
+// --- Includes ---
+// This header provides std::filesystem for paths and (on non-Linux systems)
+// file modification times.
+#include <filesystem>
+// This header provides std::string.
+#include <string>
+// This header provides std::error_code, so missing files don't throw.
+#include <system_error>
+
+#ifdef __linux__
+// Linux's inotify API: the kernel tells us when a file changes, so checking
+// for changes costs a single non-blocking read() per frame.
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// --- File Watcher ---
+
+// Reports when a file has been modified, e.g. a level file saved from a text
+// editor. Call changed() once per frame; it never blocks.
+//
+// On Linux this uses inotify on the file's directory (editors often save by
+// writing a new file and renaming it over the old one, which a watch on the
+// file itself would miss). On other systems it falls back to checking the
+// file's modification time a couple of times per second.
+class FileWatcher {
+public:
+    explicit FileWatcher(const std::filesystem::path& file) : path(file) {
+#ifdef __linux__
+        fileName = path.filename().string();
+        std::filesystem::path directory = path.parent_path();
+        if (directory.empty()) directory = ".";
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0) {
+            inotify_add_watch(inotifyFd, directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        }
+#else
+        std::error_code ignored;
+        lastWriteTime = std::filesystem::last_write_time(path, ignored);
+#endif
+    }
+
+    ~FileWatcher() {
+#ifdef __linux__
+        if (inotifyFd >= 0) close(inotifyFd);
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Returns true if the file was written since the last call.
+    bool changed() {
+#ifdef __linux__
+        if (inotifyFd < 0) return false;
+        bool result = false;
+        // Each read returns as many queued events as fit in the buffer.
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) break; // Nothing (more) queued.
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0 && fileName == event->name) result = true;
+                offset += (ssize_t)sizeof(inotify_event) + event->len;
+            }
+        }
+        return result;
+#else
+        // Checking the file system every frame would be wasteful; every 30th
+        // call is twice per second at 60 FPS.
+        if (++callsSinceCheck < 30) return false;
+        callsSinceCheck = 0;
+        std::error_code error;
+        const auto writeTime = std::filesystem::last_write_time(path, error);
+        if (error || writeTime == lastWriteTime) return false;
+        lastWriteTime = writeTime;
+        return true;
+#endif
+    }
+
+private:
+    std::filesystem::path path;
+#ifdef __linux__
+    std::string fileName;
+    int inotifyFd = -1;
+#else
+    std::filesystem::file_time_type lastWriteTime;
+    int callsSinceCheck = 0;
+#endif
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+// --- Includes ---
+// This header provides std::floor, used by the float versions of the helpers.
+#include <cmath>
+// This header provides fixed-width integer types for the raw fixed-point value.
+#include <cstdint>
+
+// --- Fixed-Point Numbers ---
+
+// A signed fixed-point number with 20 integer and 12 fraction bits, stored in
+// one 32-bit integer: 1/4096 pixel resolution over +-524288 pixels (13107
+// tiles). Additions, comparisons and tile lookups are plain integer
+// operations, and products and quotients go through 64-bit integers, so the
+// same inputs give the same bits with any compiler, optimization level or CPU.
+// That is what replays and lockstep networking need, and what `float` can't
+// promise (contracted multiply-adds, x87 excess precision, different library
+// rounding, ...).
+//
+// Only what the player physics uses is provided. Conversions from float round
+// to the nearest step; they are exact for the constants we use at compile time.
+struct Fixed {
+    static constexpr int FRACTION_BITS = 12;
+    static constexpr std::int32_t ONE = 1 << FRACTION_BITS;
+
+    std::int32_t raw = 0;
+
+    constexpr Fixed() = default;
+    constexpr explicit Fixed(int value) : raw(value * ONE) {}
+    constexpr explicit Fixed(float value)
+        : raw((std::int32_t)(value * (float)ONE + (value >= 0.f ? 0.5f : -0.5f))) {}
+
+    static constexpr Fixed fromRaw(std::int32_t raw) {
+        Fixed result;
+        result.raw = raw;
+        return result;
+    }
+
+    constexpr explicit operator float() const { return (float)raw / (float)ONE; }
+    // Rounds towards zero, like converting a float to int.
+    constexpr explicit operator int() const { return raw / ONE; }
+
+    constexpr Fixed operator-() const { return fromRaw(-raw); }
+    constexpr Fixed operator+(Fixed other) const { return fromRaw(raw + other.raw); }
+    constexpr Fixed operator-(Fixed other) const { return fromRaw(raw - other.raw); }
+    constexpr Fixed operator*(Fixed other) const {
+        return fromRaw((std::int32_t)(((std::int64_t)raw * other.raw) >> FRACTION_BITS));
+    }
+    constexpr Fixed operator/(Fixed other) const {
+        return fromRaw((std::int32_t)(((std::int64_t)raw * ONE) / other.raw));
+    }
+    constexpr Fixed operator*(int factor) const { return fromRaw(raw * factor); }
+    constexpr Fixed operator/(int divisor) const { return fromRaw(raw / divisor); }
+    Fixed& operator+=(Fixed other) { raw += other.raw; return *this; }
+    Fixed& operator-=(Fixed other) { raw -= other.raw; return *this; }
+
+    constexpr bool operator==(Fixed other) const { return raw == other.raw; }
+    constexpr bool operator!=(Fixed other) const { return raw != other.raw; }
+    constexpr bool operator<(Fixed other) const { return raw < other.raw; }
+    constexpr bool operator>(Fixed other) const { return raw > other.raw; }
+    constexpr bool operator<=(Fixed other) const { return raw <= other.raw; }
+    constexpr bool operator>=(Fixed other) const { return raw >= other.raw; }
+};
+
+static_assert(sizeof(Fixed) == sizeof(float), "Fixed replaces float in packed state (snapshots)");
+
+inline constexpr Fixed abs(Fixed value) { return value.raw < 0 ? -value : value; }
+
+// --- Physics Scalar ---
+
+// The number type of positions and velocities in the simulation. Building with
+// PLATFORMER_FIXED_POINT defined (CMake option of the same name) switches the
+// simulation to Fixed for bit-exact results across builds; the default stays
+// `float`.
+#ifdef PLATFORMER_FIXED_POINT
+using PhysicsScalar = Fixed;
+#else
+using PhysicsScalar = float;
+#endif
+
+// Name of the number format, for logs and benchmark output.
+inline const char* physicsScalarName() {
+#ifdef PLATFORMER_FIXED_POINT
+    return "fixed-point Q20.12";
+#else
+    return "float";
+#endif
+}
+
+// A position or velocity in the simulation's number type.
+template <typename T>
+struct PhysicsVector {
+    T x{};
+    T y{};
+};
+
+// --- Conversions ---
+// The same operations written once for both number types, so the physics code
+// can be templated on the scalar.
+
+inline float toFloat(float value) { return value; }
+inline float toFloat(Fixed value) { return (float)value; }
+
+// Index of the tile (of size `tileSize`) containing `value`, rounding towards
+// zero like the original float code did.
+inline int tileIndex(float value, int tileSize) { return static_cast<int>(value / tileSize); }
+inline int tileIndex(Fixed value, int tileSize) { return value.raw / (tileSize * Fixed::ONE); }
+
+// The same, rounding towards negative infinity.
+inline int tileIndexFloor(float value, int tileSize) { return static_cast<int>(std::floor(value / tileSize)); }
+inline int tileIndexFloor(Fixed value, int tileSize) {
+    const std::int32_t step = tileSize * Fixed::ONE;
+    return value.raw >= 0 ? value.raw / step : -((-value.raw + step - 1) / step);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+// --- Includes ---
+// This header provides std::size_t and std::max_align_t.
+#include <cstddef>
+// This header provides std::uintptr_t, used to align pointers.
+#include <cstdint>
+// This header provides std::unique_ptr, which owns the arena's memory block.
+#include <memory>
+// This header provides std::align_val_t for over-aligned overflow blocks.
+#include <new>
+// This header provides std::basic_string, used for the FrameString alias.
+#include <string>
+// This header provides std::vector, used for the FrameVector alias and to keep
+// track of overflow blocks.
+#include <vector>
+
+// --- Frame Arena ---
+
+// A "bump" (linear) allocator for data that only lives for one frame: cull
+// lists, contact lists, formatted debug strings and so on.
+//
+// The arena owns one big block of memory allocated at startup. Allocating just
+// moves an offset forward (no locks, no searching for free blocks), freeing
+// individual allocations does nothing, and `reset()` at the end of the frame
+// makes the whole block available again in one step. Once the game has run a
+// few frames, transient data therefore never touches the general heap.
+//
+// If a frame ever needs more than the block holds, the extra requests fall back
+// to the heap so the game keeps running; they are counted in
+// `overflowAllocations()` (which should stay at zero) and released on reset.
+class FrameArena {
+public:
+    // Allocates the arena's memory block of `capacityBytes` bytes.
+    explicit FrameArena(std::size_t capacityBytes)
+        : buffer(new unsigned char[capacityBytes]), capacityBytes(capacityBytes) {}
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    ~FrameArena() { releaseOverflow(); }
+
+    // Returns `bytes` bytes of memory aligned to `alignment` (a power of two).
+    // The memory stays valid until the next reset().
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+        const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(buffer.get());
+        // Round the current position up to the requested alignment.
+        const std::uintptr_t aligned = (base + offset + (alignment - 1)) & ~(std::uintptr_t)(alignment - 1);
+        const std::size_t newOffset = (std::size_t)(aligned - base) + bytes;
+        ++allocationsThisFrame;
+        if (newOffset > capacityBytes) {
+            // Out of arena space: fall back to the heap and remember the block
+            // (and its alignment, which its delete has to be given again).
+            ++overflowCount;
+            void* block = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                              ? ::operator new(bytes, std::align_val_t(alignment))
+                              : ::operator new(bytes);
+            overflowBlocks.push_back({block, alignment});
+            return block;
+        }
+        offset = newOffset;
+        if (offset > peakBytes) peakBytes = offset;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Makes the whole arena available again. Everything allocated from it since
+    // the previous reset must no longer be used.
+    void reset() {
+        releaseOverflow();
+        offset = 0;
+        allocationsThisFrame = 0;
+    }
+
+    // Bytes handed out since the last reset.
+    std::size_t used() const { return offset; }
+    // Total size of the arena's memory block.
+    std::size_t capacity() const { return capacityBytes; }
+    // Highest value used() has ever reached.
+    std::size_t peak() const { return peakBytes; }
+    // Number of allocate() calls since the last reset.
+    std::size_t allocations() const { return allocationsThisFrame; }
+    // Number of requests that did not fit and went to the heap (ever).
+    std::size_t overflowAllocations() const { return overflowCount; }
+
+private:
+    std::unique_ptr<unsigned char[]> buffer; // The arena's memory block.
+    std::size_t capacityBytes;               // Size of `buffer`.
+    std::size_t offset = 0;                  // First free byte in `buffer`.
+    std::size_t peakBytes = 0;
+    std::size_t allocationsThisFrame = 0;
+    std::size_t overflowCount = 0;
+    struct OverflowBlock {
+        void* memory;
+        std::size_t alignment;
+    };
+    std::vector<OverflowBlock> overflowBlocks; // Heap blocks to free on reset.
+
+    void releaseOverflow() {
+        for (const OverflowBlock& block : overflowBlocks) {
+            if (block.alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(block.memory, std::align_val_t(block.alignment));
+            } else {
+                ::operator delete(block.memory);
+            }
+        }
+        overflowBlocks.clear();
+    }
+};
+
+// --- STL Adaptor ---
+
+// Lets standard containers take their memory from a FrameArena:
+//
+//     FrameVector<sf::Vector2i> visibleCoins{FrameAllocator<sf::Vector2i>(frameArena)};
+//
+// deallocate() is a no-op; the memory comes back when the arena is reset, so
+// a container using this allocator must not outlive the current frame.
+template <typename T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameArena* arena;
+
+    explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+
+    // Containers "rebind" allocators to allocate their internal node types.
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+};
+
+// Convenience aliases for the containers most often needed per frame.
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
@@ -0,0 +1,40 @@
+#pragma once
+
+// --- Includes ---
+// The generic event bus.
+#include "EventBus.hpp"
+// Tile types, for pickups.
+#include "TileTraits.hpp"
+// sf::Vector2f / sf::Vector2i for event positions.
+#include <SFML/System/Vector2.hpp>
+
+// --- Gameplay Events ---
+// The events gameplay code reports. Each is a small plain struct, copied into
+// a queue slot when pushed; add a type here and to GameEventBus to add an event.
+
+// The player touched down after being in the air.
+struct PlayerLandedEvent {
+    sf::Vector2f position; // The player's feet.
+    float speed;           // Downward speed at impact (pixels/frame).
+};
+
+// The player fell off the bottom of the level and was sent back to the start.
+struct PlayerFellOutEvent {
+    sf::Vector2f position; // Where the player left the level.
+};
+
+// The player picked up a collectible tile.
+struct ItemCollectedEvent {
+    sf::Vector2i tile; // Tile coordinates of the item (now Air).
+    TileType type;     // What it was.
+};
+
+// The score changed.
+struct ScoreChangedEvent {
+    int score; // New total.
+    int delta; // Change from the previous total.
+};
+
+// The bus carrying all of the above, and the per-thread queue producers push into.
+using GameEventBus = EventBus<PlayerLandedEvent, PlayerFellOutEvent, ItemCollectedEvent, ScoreChangedEvent>;
+using GameEventQueue = GameEventBus::Queue;
@@ -0,0 +1,244 @@
+#pragma once
+
+// --- Includes ---
+// The state that goes into a snapshot.
+#include "Level.hpp"
+#include "Player.hpp"
+// This header provides fixed-width integer types: the layout must not depend
+// on the compiler's idea of `int` or `long`.
+#include <cstdint>
+// This header provides std::FILE, std::fopen, std::fread and std::fwrite.
+#include <cstdio>
+// This header provides std::memcpy.
+#include <cstring>
+// This header provides std::filesystem::path.
+#include <filesystem>
+// This header provides std::string for error messages.
+#include <string>
+// This header provides std::vector.
+#include <vector>
+
+// --- Snapshot Layout ---
+// A snapshot is one flat block of bytes with no pointers in it:
+//
+//   SnapshotHeader | SnapshotEntity x entityCount | TileType x (width * height)
+//
+// Saving is building that block and one write(); loading is one read() (or a
+// memory map) followed by a check of the header, after which the entity and
+// tile arrays are used where they are, without parsing field by field. The
+// same blocks in memory serve as rollback and time-travel states.
+//
+// All fields have fixed sizes and the file stores them in the machine's byte
+// order; `byteOrderMark` lets a machine with the other order reject the file
+// instead of misreading it. Entity positions and velocities are stored in the
+// simulation's number type (float or Fixed), recorded in `numberFormat`, so a
+// snapshot restores the exact bits the simulation had.
+
+// Identifies a snapshot file: "PLSS" (platformer snapshot).
+const std::uint32_t SNAPSHOT_MAGIC = 0x53534C50u;
+// Bumped whenever the layout below changes; older snapshots are rejected.
+const std::uint32_t SNAPSHOT_VERSION = 2;
+// Written as-is; reads back as a different number with the other byte order.
+const std::uint32_t SNAPSHOT_BYTE_ORDER_MARK = 0x01020304u;
+// Which number type the entity fields use.
+enum SnapshotNumberFormat : std::uint32_t {
+    SNAPSHOT_NUMBERS_FLOAT = 0,
+    SNAPSHOT_NUMBERS_FIXED = 1, // Fixed (Q20.12) raw values.
+};
+#ifdef PLATFORMER_FIXED_POINT
+const std::uint32_t SNAPSHOT_NUMBER_FORMAT = SNAPSHOT_NUMBERS_FIXED;
+#else
+const std::uint32_t SNAPSHOT_NUMBER_FORMAT = SNAPSHOT_NUMBERS_FLOAT;
+#endif
+
+// Fixed-size block at the start of every snapshot.
+struct SnapshotHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t headerSize;     // sizeof(SnapshotHeader) when written.
+    std::uint64_t tick;           // Simulation tick the snapshot was taken at.
+    std::uint64_t totalSize;      // Size of the whole snapshot in bytes.
+    std::uint32_t rngState;       // Random generator state (particle effects).
+    std::int32_t score;
+    std::uint32_t levelWidth;     // In tiles.
+    std::uint32_t levelHeight;
+    std::uint32_t entityCount;
+    std::uint32_t entitySize;     // sizeof(SnapshotEntity) when written.
+    std::uint64_t entitiesOffset; // Byte offset of the entity array.
+    std::uint64_t tilesOffset;    // Byte offset of the tile array.
+    std::uint32_t numberFormat;   // SnapshotNumberFormat of the entities.
+    std::uint32_t reserved;       // Zero.
+};
+
+// One simulated entity (currently: players).
+struct SnapshotEntity {
+    PhysicsScalar x, y;    // Centre position (pixels).
+    PhysicsScalar vx, vy;  // Velocity (pixels/frame).
+    PhysicsScalar landingSpeed;
+    std::uint8_t onGround; // 0 or 1.
+    std::uint8_t padding[3];
+};
+
+static_assert(sizeof(SnapshotHeader) == 80, "SnapshotHeader layout changed: bump SNAPSHOT_VERSION");
+static_assert(sizeof(SnapshotEntity) == 24, "SnapshotEntity layout changed: bump SNAPSHOT_VERSION");
+static_assert(sizeof(TileType) == 1, "tiles are stored as single bytes");
+
+// --- Entities ---
+
+inline SnapshotEntity snapshotEntityFromPlayer(const Player& player) {
+    SnapshotEntity entity{};
+    entity.x = player.position.x;
+    entity.y = player.position.y;
+    entity.vx = player.velocity.x;
+    entity.vy = player.velocity.y;
+    entity.landingSpeed = player.landingSpeed;
+    entity.onGround = player.isOnGround ? 1 : 0;
+    return entity;
+}
+
+inline void applySnapshotEntity(const SnapshotEntity& entity, Player& player) {
+    player.position = {entity.x, entity.y};
+    player.velocity = {entity.vx, entity.vy};
+    player.landingSpeed = entity.landingSpeed;
+    player.isOnGround = entity.onGround != 0;
+    player.syncShape();
+}
+
+// --- Writing ---
+
+// The parts of the game state that are not tiles or entities.
+struct SnapshotGlobals {
+    std::uint64_t tick = 0;
+    std::uint32_t rngState = 0;
+    std::int32_t score = 0;
+};
+
+// Builds a snapshot in `buffer` (reusing its capacity). The tiles are copied
+// as one block.
+inline void writeSnapshot(std::vector<std::uint8_t>& buffer, const SnapshotGlobals& globals, const Level& level,
+                          const SnapshotEntity* entities, std::uint32_t entityCount) {
+    SnapshotHeader header{};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrderMark = SNAPSHOT_BYTE_ORDER_MARK;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.tick = globals.tick;
+    header.rngState = globals.rngState;
+    header.score = globals.score;
+    header.levelWidth = level.size.x;
+    header.levelHeight = level.size.y;
+    header.entityCount = entityCount;
+    header.entitySize = sizeof(SnapshotEntity);
+    header.entitiesOffset = sizeof(SnapshotHeader);
+    header.tilesOffset = header.entitiesOffset + (std::uint64_t)entityCount * sizeof(SnapshotEntity);
+    header.totalSize = header.tilesOffset + level.tiles.size();
+    header.numberFormat = SNAPSHOT_NUMBER_FORMAT;
+
+    buffer.resize((std::size_t)header.totalSize);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (entityCount > 0) {
+        std::memcpy(buffer.data() + header.entitiesOffset, entities, (std::size_t)entityCount * sizeof(SnapshotEntity));
+    }
+    if (!level.tiles.empty()) {
+        std::memcpy(buffer.data() + header.tilesOffset, level.tiles.data(), level.tiles.size());
+    }
+}
+
+// --- Reading ---
+
+// A validated snapshot, pointing into the bytes it was read from (which must
+// stay alive while the view is used).
+struct SnapshotView {
+    SnapshotHeader header;
+    const SnapshotEntity* entities = nullptr;
+    const TileType* tiles = nullptr;
+};
+
+// Checks that `data` holds a complete snapshot this build understands and
+// fills `view`. On failure returns false and describes the problem in `error`.
+inline bool readSnapshot(const std::uint8_t* data, std::size_t size, SnapshotView& view, std::string& error) {
+    if (size < sizeof(SnapshotHeader)) {
+        error = "the snapshot is truncated";
+        return false;
+    }
+    std::memcpy(&view.header, data, sizeof(SnapshotHeader));
+    const SnapshotHeader& header = view.header;
+    if (header.magic != SNAPSHOT_MAGIC) {
+        error = "not a snapshot file";
+        return false;
+    }
+    if (header.byteOrderMark != SNAPSHOT_BYTE_ORDER_MARK) {
+        error = "the snapshot was written on a machine with a different byte order";
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION || header.headerSize != sizeof(SnapshotHeader) ||
+        header.entitySize != sizeof(SnapshotEntity)) {
+        error = "unsupported snapshot version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.numberFormat != SNAPSHOT_NUMBER_FORMAT) {
+        error = "the snapshot was saved by a build with a different physics number format";
+        return false;
+    }
+    const std::uint64_t tileCount = (std::uint64_t)header.levelWidth * header.levelHeight;
+    if (header.totalSize != size || header.entitiesOffset != sizeof(SnapshotHeader) ||
+        header.tilesOffset != header.entitiesOffset + (std::uint64_t)header.entityCount * sizeof(SnapshotEntity) ||
+        header.tilesOffset + tileCount != size) {
+        error = "the snapshot is truncated or corrupt";
+        return false;
+    }
+    // The offsets keep every array aligned for its type (the header and entity
+    // sizes are multiples of 4), as long as `data` itself is.
+    view.entities = reinterpret_cast<const SnapshotEntity*>(data + header.entitiesOffset);
+    view.tiles = reinterpret_cast<const TileType*>(data + header.tilesOffset);
+    return true;
+}
+
+// Copies the snapshot's tiles into `level` (one block copy), resizing it if
+// needed, and marks every chunk as changed so caches rebuild.
+inline void applySnapshotTiles(const SnapshotView& view, Level& level) {
+    const sf::Vector2u size = {view.header.levelWidth, view.header.levelHeight};
+    if (level.size != size) level.resize(size);
+    std::memcpy(level.tiles.data(), view.tiles, level.tiles.size());
+    for (unsigned int cy = 0; cy < level.chunkCount.y; ++cy) {
+        for (unsigned int cx = 0; cx < level.chunkCount.x; ++cx) level.markChunkChanged((int)cx, (int)cy);
+    }
+}
+
+// --- Files ---
+
+// Writes a snapshot to disk with a single write.
+inline bool saveSnapshotFile(const std::filesystem::path& path, const std::vector<std::uint8_t>& buffer, std::string& error) {
+    std::FILE* file = std::fopen(path.string().c_str(), "wb");
+    if (file == nullptr) {
+        error = "could not create '" + path.string() + "'";
+        return false;
+    }
+    const bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    if (std::fclose(file) != 0 || !ok) {
+        error = "could not write '" + path.string() + "'";
+        return false;
+    }
+    return true;
+}
+
+// Reads a whole snapshot file into `buffer` with a single read. The bytes
+// still have to be checked with readSnapshot.
+inline bool loadSnapshotFile(const std::filesystem::path& path, std::vector<std::uint8_t>& buffer, std::string& error) {
+    std::error_code sizeError;
+    const std::uintmax_t size = std::filesystem::file_size(path, sizeError);
+    std::FILE* file = sizeError ? nullptr : std::fopen(path.string().c_str(), "rb");
+    if (file == nullptr) {
+        error = "could not open '" + path.string() + "'";
+        return false;
+    }
+    buffer.resize((std::size_t)size);
+    const bool ok = std::fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    std::fclose(file);
+    if (!ok) {
+        error = "could not read '" + path.string() + "'";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,214 @@
+// --- Includes ---
+#include "HeapStats.hpp"
+// This header provides std::atomic; the counters may be updated from any thread.
+#include <atomic>
+// This header provides std::snprintf, used to format the report.
+#include <cstdio>
+// This header provides std::malloc and std::free, which do the actual allocating.
+#include <cstdlib>
+// This header provides std::bad_alloc and the declarations of operator new/delete.
+#include <new>
+
+// --- Counters ---
+// Counting has to be cheap, since every allocation in the program pays for
+// it. The counts only ever grow, so each thread keeps its own in a slot that
+// only it writes (a load and a store, no locked instruction), and reading adds
+// up the slots. Live bytes go up and down across threads, and their peak must
+// be exact, so those are shared atomics: one per tag and one for the whole
+// heap, whose peak is not the sum of the tags' peaks. Relaxed atomics are
+// enough: we only need each counter to be exact, not to be ordered with
+// respect to other memory operations.
+namespace {
+
+enum SlotCounter { SLOT_ALLOCATIONS, SLOT_FREES, SLOT_BYTES, SLOT_COUNTERS };
+
+// One thread's counts. Slots are allocated with malloc (not counted) and never
+// freed: a finished thread's counts stay in its slot, and the next new thread
+// takes the slot over and adds to them.
+struct ThreadSlot {
+    // constexpr, so the shared slot is ready before any static constructor allocates.
+    constexpr explicit ThreadSlot(bool isShared = false) : shared(isShared) {}
+
+    std::atomic<std::uint64_t> counts[HEAP_TAG_COUNT][SLOT_COUNTERS] = {};
+    std::atomic<bool> inUse{true};
+    ThreadSlot* next = nullptr;
+    bool shared = false; // The fallback slot, which any thread may update.
+
+    void add(HeapTag tag, SlotCounter counter, std::uint64_t amount) {
+        std::atomic<std::uint64_t>& count = counts[(std::size_t)tag][counter];
+        if (shared) {
+            count.fetch_add(amount, std::memory_order_relaxed);
+        } else {
+            count.store(count.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Every slot ever created, newest first.
+std::atomic<ThreadSlot*> slots{nullptr};
+// Used by threads that are exiting (after their slot was handed back) or
+// couldn't get one.
+ThreadSlot sharedSlot(true);
+
+// The live bytes (and their peaks) of each tag, each on its own cache line so
+// threads working for different subsystems don't slow each other down, and of
+// the whole heap.
+struct alignas(64) LiveBytes {
+    std::atomic<std::uint64_t> live{0};
+    std::atomic<std::uint64_t> peak{0};
+
+    void add(std::uint64_t size) {
+        const std::uint64_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+        // Usually a single load: the peak only moves while memory use grows.
+        std::uint64_t seen = peak.load(std::memory_order_relaxed);
+        while (now > seen && !peak.compare_exchange_weak(seen, now, std::memory_order_relaxed)) {}
+    }
+    void remove(std::uint64_t size) { live.fetch_sub(size, std::memory_order_relaxed); }
+};
+LiveBytes tagLiveBytes[HEAP_TAG_COUNT];
+LiveBytes totalLiveBytes;
+
+// Takes over a slot of a finished thread, or creates one.
+ThreadSlot* acquireSlot() {
+    for (ThreadSlot* slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        bool expected = false;
+        if (slot->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) return slot;
+    }
+    void* memory = std::malloc(sizeof(ThreadSlot));
+    if (memory == nullptr) return &sharedSlot;
+    ThreadSlot* slot = new (memory) ThreadSlot();
+    slot->next = slots.load(std::memory_order_relaxed);
+    while (!slots.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {}
+    return slot;
+}
+
+// The calling thread's slot. Set on its first allocation; when the thread
+// exits, the slot is handed back and anything the thread still frees while
+// shutting down is counted in the shared slot.
+thread_local ThreadSlot* threadSlot = nullptr;
+thread_local bool threadExiting = false;
+
+struct ThreadSlotOwner {
+    ~ThreadSlotOwner() {
+        threadExiting = true;
+        if (threadSlot != nullptr && threadSlot != &sharedSlot) threadSlot->inUse.store(false, std::memory_order_release);
+        threadSlot = &sharedSlot;
+    }
+};
+
+ThreadSlot& currentSlot() {
+    if (threadSlot == nullptr) {
+        if (threadExiting) return sharedSlot;
+        threadSlot = acquireSlot();
+        // Hands the slot back when the thread exits.
+        thread_local ThreadSlotOwner owner;
+        (void)owner;
+    }
+    return *threadSlot;
+}
+
+// Every block starts with the size it was requested with and the tag it was
+// charged to, so operator delete can give both back. The header is as big as
+// the alignment operator new guarantees, so the memory after it keeps it.
+struct alignas(std::max_align_t) BlockHeader {
+    std::uint64_t size;
+    HeapTag tag;
+};
+
+// Adds up the slots' counts of `tag` into `counters`.
+void addSlotCounts(HeapTag tag, HeapCounters& counters) {
+    auto addSlot = [&](const ThreadSlot& slot) {
+        counters.allocations += slot.counts[(std::size_t)tag][SLOT_ALLOCATIONS].load(std::memory_order_relaxed);
+        counters.frees += slot.counts[(std::size_t)tag][SLOT_FREES].load(std::memory_order_relaxed);
+        counters.bytes += slot.counts[(std::size_t)tag][SLOT_BYTES].load(std::memory_order_relaxed);
+    };
+    for (const ThreadSlot* slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) addSlot(*slot);
+    addSlot(sharedSlot);
+}
+
+} // namespace
+
+HeapCounters readHeapCounters() {
+    HeapCounters counters;
+    for (std::size_t tag = 0; tag < HEAP_TAG_COUNT; ++tag) addSlotCounts((HeapTag)tag, counters);
+    counters.liveBytes = totalLiveBytes.live.load(std::memory_order_relaxed);
+    counters.peakBytes = totalLiveBytes.peak.load(std::memory_order_relaxed);
+    return counters;
+}
+
+HeapUsage readHeapUsage() {
+    HeapUsage usage;
+    for (std::size_t tag = 0; tag < HEAP_TAG_COUNT; ++tag) {
+        HeapCounters& counters = usage.tags[tag];
+        addSlotCounts((HeapTag)tag, counters);
+        counters.liveBytes = tagLiveBytes[tag].live.load(std::memory_order_relaxed);
+        counters.peakBytes = tagLiveBytes[tag].peak.load(std::memory_order_relaxed);
+        usage.total.allocations += counters.allocations;
+        usage.total.frees += counters.frees;
+        usage.total.bytes += counters.bytes;
+    }
+    usage.total.liveBytes = totalLiveBytes.live.load(std::memory_order_relaxed);
+    usage.total.peakBytes = totalLiveBytes.peak.load(std::memory_order_relaxed);
+    return usage;
+}
+
+std::string formatHeapReport(const HeapUsage& current, const HeapUsage& previous, std::uint64_t frames) {
+    std::string report;
+    char line[160];
+    auto addRow = [&](const char* name, const HeapCounters& now, const HeapCounters& before) {
+        const double perFrame = frames > 0 ? (double)(now.allocations - before.allocations) / (double)frames : 0.0;
+        std::snprintf(line, sizeof(line), "%-11s %11.1f %11.1f %11llu %13llu %11.2f\n", name, now.liveBytes / 1024.0,
+                      now.peakBytes / 1024.0, (unsigned long long)(now.allocations - now.frees),
+                      (unsigned long long)now.allocations, perFrame);
+        report += line;
+    };
+    std::snprintf(line, sizeof(line), "%-11s %11s %11s %11s %13s %11s\n", "heap", "live KB", "peak KB", "live blocks",
+                  "allocations", "allocs/frame");
+    report += line;
+    for (std::size_t tag = 0; tag < HEAP_TAG_COUNT; ++tag) {
+        addRow(heapTagName((HeapTag)tag), current.tags[tag], previous.tags[tag]);
+    }
+    addRow("total", current.total, previous.total);
+    // What the bookkeeping itself costs, on top of the requested bytes.
+    std::snprintf(line, sizeof(line), "(plus %.1f KB of block headers; allocs/frame over the last %llu frames)\n",
+                  (double)((current.total.allocations - current.total.frees) * sizeof(BlockHeader)) / 1024.0,
+                  (unsigned long long)frames);
+    report += line;
+    return report;
+}
+
+// --- Global Operator New/Delete Replacements ---
+// Defining these functions in the program replaces the standard library's
+// versions everywhere (including inside SFML). The array and nothrow forms of
+// operator new call these by default, so they are counted as well. (The
+// over-aligned forms are not replaced; they are neither counted nor given a
+// header, and their deletes don't come here.)
+
+void* operator new(std::size_t size) {
+    // malloc(0) may return nullptr, but operator new must return a unique pointer.
+    void* memory = std::malloc(sizeof(BlockHeader) + size);
+    if (memory == nullptr) throw std::bad_alloc();
+    BlockHeader* header = static_cast<BlockHeader*>(memory);
+    header->size = size;
+    header->tag = currentHeapTag;
+    ThreadSlot& slot = currentSlot();
+    slot.add(header->tag, SLOT_ALLOCATIONS, 1);
+    slot.add(header->tag, SLOT_BYTES, size);
+    tagLiveBytes[(std::size_t)header->tag].add(size);
+    totalLiveBytes.add(size);
+    return header + 1;
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory != nullptr) {
+        BlockHeader* header = static_cast<BlockHeader*>(memory) - 1;
+        currentSlot().add(header->tag, SLOT_FREES, 1);
+        tagLiveBytes[(std::size_t)header->tag].remove(header->size);
+        totalLiveBytes.remove(header->size);
+        std::free(header);
+    }
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// --- Includes ---
+// This header provides std::size_t.
+#include <cstddef>
+// This header provides std::uint64_t for the counters.
+#include <cstdint>
+// This header provides std::string, which holds the text report.
+#include <string>
+
+// --- Heap Statistics ---
+
+// Running totals of every allocation made through the global operator new
+// (which is what std::vector, std::string, `new` and most libraries use).
+// HeapStats.cpp replaces the global operator new/delete to keep these counters,
+// so comparing two readings tells us exactly how many heap allocations a piece
+// of code (for example one frame of the game loop) performed.
+struct HeapCounters {
+    std::uint64_t allocations = 0; // Number of operator new calls.
+    std::uint64_t frees = 0;       // Number of operator delete calls (non-null).
+    std::uint64_t bytes = 0;       // Total bytes requested from operator new.
+    std::uint64_t liveBytes = 0;   // Bytes allocated and not yet freed.
+    std::uint64_t peakBytes = 0;   // The most liveBytes has ever been.
+};
+
+// Returns the current totals. Safe to call from any thread.
+HeapCounters readHeapCounters();
+
+// --- Tagged Allocations ---
+
+// The subsystem an allocation is charged to. Every allocation is charged to
+// the tag its thread has at the time (see HeapTagScope), and its free is
+// charged to the same tag later, whichever thread frees it. So the counters
+// below show how the heap splits between the subsystems, and which of them
+// allocate every frame.
+enum class HeapTag : std::uint8_t {
+    Other,      // Anything not tagged: SFML internals, iostreams, ...
+    Level,      // Level tiles, chunk hashes, level files and reloads.
+    Lighting,   // The light map.
+    Simulation, // The game tick: player, sand, events.
+    Rendering,  // The window, render caches, mipmap textures, drawing.
+    Effects,    // Particles.
+    Snapshots,  // Quicksaves and quickloads.
+    Tracing,    // Trace ring buffers (Trace.hpp).
+};
+
+const std::size_t HEAP_TAG_COUNT = 8;
+
+// Display name of a tag, for reports.
+inline const char* heapTagName(HeapTag tag) {
+    static const char* const NAMES[HEAP_TAG_COUNT] = {"other",     "level",   "lighting",  "simulation",
+                                                      "rendering", "effects", "snapshots", "tracing"};
+    return NAMES[(std::size_t)tag];
+}
+
+// The calling thread's current tag. Plain thread-local data, so setting it
+// costs a store and works in programs that don't link HeapStats.cpp (where
+// nothing reads it).
+inline thread_local HeapTag currentHeapTag = HeapTag::Other;
+
+// Charges the calling thread's allocations to `tag` until the scope ends (or
+// change() picks another tag), then restores the previous tag.
+class HeapTagScope {
+public:
+    explicit HeapTagScope(HeapTag tag) : previous(currentHeapTag) { currentHeapTag = tag; }
+    ~HeapTagScope() { currentHeapTag = previous; }
+    HeapTagScope(const HeapTagScope&) = delete;
+    HeapTagScope& operator=(const HeapTagScope&) = delete;
+
+    void change(HeapTag tag) { currentHeapTag = tag; }
+
+private:
+    HeapTag previous;
+};
+
+// The counters of every tag at one moment.
+struct HeapUsage {
+    HeapCounters tags[HEAP_TAG_COUNT];
+    HeapCounters total;
+};
+
+// Returns the current counters of every tag. Safe to call from any thread.
+HeapUsage readHeapUsage();
+
+// A table of live and peak bytes, live blocks and allocations per tag, plus
+// the allocations per frame of each tag since `previous` (a reading taken
+// `frames` frames earlier).
+std::string formatHeapReport(const HeapUsage& current, const HeapUsage& previous, std::uint64_t frames);
@@ -0,0 +1,386 @@
+#pragma once
+
+// --- Includes ---
+// SFML's small vector types (sf::Vector2u, sf::Vector2f) are all the level data
+// needs. Including only the System header keeps this file usable by programs
+// that never open a window (the benchmark executable, for example).
+#include <SFML/System/Vector2.hpp>
+// This header provides std::vector, a dynamic array container. We use it
+// to store the tile grid of our level map.
+#include <vector>
+// This header provides std::size_t, the unsigned type used for array indices.
+#include <cstddef>
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides fixed-width integer types for the occupancy bit words.
+#include <cstdint>
+// This header provides std::memcpy, which reads eight tiles as one word.
+#include <cstring>
+// The tile types and their property tables.
+#include "TileTraits.hpp"
+
+// --- Global Constants ---
+// Using constants makes the code easier to read and modify. If we want to
+// change gravity, we only need to change it in one place.
+
+// Downward acceleration applied to the player each frame (pixels/frame^2).
+// Simulates gravity pulling the player down.
+const float GRAVITY = 0.8f;
+// Horizontal speed when the left/right keys are held (pixels/frame).
+const float PLAYER_MOVE_SPEED = 5.0f;
+// Initial vertical velocity when the jump key is pressed (pixels/frame).
+// Negative because SFML's Y-axis points downwards (0 is top, height is bottom).
+const float PLAYER_JUMP_VELOCITY = -18.0f;
+// The dimension (width and height) of a single square tile in pixels.
+// This links the grid-based level data to the pixel-based screen coordinates.
+const int TILE_SIZE = 40;
+// A small value used to prevent floating-point inaccuracies during collision checks,
+// especially when the player is exactly aligned with a tile edge. It helps avoid
+// getting stuck by checking slightly *inside* the player's bounds.
+const float COLLISION_EPSILON = 0.01f;
+// Window dimensions defined as constants for clarity and easy reference,
+// particularly when setting up the initial view size.
+const unsigned int WINDOW_WIDTH = 800;
+const unsigned int WINDOW_HEIGHT = 600;
+// The level is divided into square chunks of this many tiles per side. Systems
+// that cache data derived from the tiles (render batches, reload diffs, ...)
+// work chunk by chunk, so a change only invalidates the chunks it touches.
+const int CHUNK_SIZE = 16;
+
+
+// --- Tile Occupancy ---
+
+// Which parts of a level contain anything but Air, at two coarser levels than
+// the tiles themselves: one bit per chunk (CHUNK_SIZE x CHUNK_SIZE tiles) and
+// one bit per super-chunk (SUPER_CHUNK_CHUNKS x SUPER_CHUNK_CHUNKS chunks).
+// Loops over tile ranges test these first, so a stretch of open sky costs one
+// bit test per super-chunk instead of a load per tile: the raycasts jump over
+// empty chunks, collision skips its checks in mid-air, and drawing skips empty
+// chunks.
+//
+// The bits are conservative: a clear bit guarantees that every tile under it
+// is Air, a set bit only says it *may* hold something. Marking a chunk (what
+// Level::markChunkChanged does for every write) sets its bits at once, which
+// keeps the guarantee without looking at the tiles; refresh() later rescans
+// the marked chunks and clears the bits of the ones that turned out empty.
+// Until then a chunk whose last coin was collected is merely tested tile by
+// tile, as before.
+//
+// Bits are stored row by row, 64 to a word, so testing a horizontal run of
+// chunks (or super-chunks) is a mask and a test per word.
+class TileOccupancy {
+public:
+    // Chunks per super-chunk along each axis; 8 keeps a super-chunk's chunks
+    // in one byte of each row's bit words.
+    static constexpr int SUPER_CHUNK_CHUNKS = 8;
+    // Tiles per super-chunk along each axis.
+    static constexpr int SUPER_CHUNK_TILES = SUPER_CHUNK_CHUNKS * CHUNK_SIZE;
+
+    // Starts over for a level of `levelSize` tiles. Every chunk counts as
+    // occupied until the next refresh() has looked at them all, so code that
+    // fills a freshly resized level by writing its tiles directly needs no
+    // marking.
+    void reset(sf::Vector2u levelSize) {
+        size = levelSize;
+        chunkCount = {(size.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE};
+        superCount = {(chunkCount.x + SUPER_CHUNK_CHUNKS - 1) / SUPER_CHUNK_CHUNKS,
+                      (chunkCount.y + SUPER_CHUNK_CHUNKS - 1) / SUPER_CHUNK_CHUNKS};
+        chunkWords = (chunkCount.x + 63) / 64;
+        superWords = (superCount.x + 63) / 64;
+        chunkBits.assign(chunkWords * chunkCount.y, ~std::uint64_t(0));
+        superBits.assign(superWords * superCount.y, ~std::uint64_t(0));
+        dirtyFlags.assign((std::size_t)chunkCount.x * chunkCount.y, 0);
+        dirty.clear();
+        rescanAll = true;
+    }
+
+    // Chunk (cx, cy) may have gained tiles: sets its bits now and rescans it
+    // on the next refresh().
+    void markOccupied(int cx, int cy) {
+        if (rescanAll) return;
+        chunkBits[(std::size_t)cy * chunkWords + cx / 64] |= std::uint64_t(1) << (cx % 64);
+        superBits[(std::size_t)(cy / SUPER_CHUNK_CHUNKS) * superWords + cx / SUPER_CHUNK_CHUNKS / 64] |=
+            std::uint64_t(1) << (cx / SUPER_CHUNK_CHUNKS % 64);
+        markMaybeEmpty(cx, cy);
+    }
+
+    // Chunk (cx, cy) only lost tiles (a tile in it became Air): its bits stay
+    // correct as they are, but the next refresh() may be able to clear them.
+    void markMaybeEmpty(int cx, int cy) {
+        if (rescanAll) return;
+        const std::size_t index = (std::size_t)cy * chunkCount.x + cx;
+        if (dirtyFlags[index]) return;
+        dirtyFlags[index] = 1;
+        dirty.push_back((std::uint32_t)index);
+    }
+
+    // Rescans the chunks marked since the last call (all of them after
+    // reset()) and brings every bit up to date. `tiles` is the level's grid.
+    void refresh(const std::vector<TileType>& tiles) {
+        if (rescanAll) {
+            std::fill(chunkBits.begin(), chunkBits.end(), 0);
+            for (unsigned int cy = 0; cy < chunkCount.y; ++cy) {
+                for (unsigned int cx = 0; cx < chunkCount.x; ++cx) {
+                    if (scanChunk(tiles, (int)cx, (int)cy)) chunkBits[cy * chunkWords + cx / 64] |= std::uint64_t(1) << (cx % 64);
+                }
+            }
+            for (unsigned int sy = 0; sy < superCount.y; ++sy) {
+                for (unsigned int sx = 0; sx < superCount.x; ++sx) updateSuperChunk((int)sx, (int)sy);
+            }
+            rescanAll = false;
+            return;
+        }
+        if (dirty.empty()) return;
+        for (std::uint32_t index : dirty) {
+            const int cx = (int)(index % chunkCount.x);
+            const int cy = (int)(index / chunkCount.x);
+            std::uint64_t& word = chunkBits[(std::size_t)cy * chunkWords + cx / 64];
+            const std::uint64_t bit = std::uint64_t(1) << (cx % 64);
+            word = scanChunk(tiles, cx, cy) ? (word | bit) : (word & ~bit);
+        }
+        // Super-chunks after all their chunks are done (several dirty chunks
+        // usually share one, so the same one may be recomputed a few times).
+        for (std::uint32_t index : dirty) {
+            dirtyFlags[index] = 0;
+            updateSuperChunk((int)(index % chunkCount.x) / SUPER_CHUNK_CHUNKS, (int)(index / chunkCount.x) / SUPER_CHUNK_CHUNKS);
+        }
+        dirty.clear();
+    }
+
+    // True if chunk (cx, cy), which must be inside the level, is all Air.
+    bool chunkEmpty(int cx, int cy) const {
+        return ((chunkBits[(std::size_t)cy * chunkWords + cx / 64] >> (cx % 64)) & 1) == 0;
+    }
+
+    // True if super-chunk (sx, sy), which must be inside the level, is all Air.
+    bool superChunkEmpty(int sx, int sy) const {
+        return ((superBits[(std::size_t)sy * superWords + sx / 64] >> (sx % 64)) & 1) == 0;
+    }
+
+    // True if every tile from (x0, y0) to (x1, y1) (inclusive) is known to be
+    // Air; tiles outside the level count as Air, like Level::getTile. False
+    // means "maybe not": the region touches an occupied chunk.
+    bool regionEmpty(int x0, int y0, int x1, int y1) const {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, (int)size.x - 1);
+        y1 = std::min(y1, (int)size.y - 1);
+        if (x0 > x1 || y0 > y1) return true;
+        const int cx0 = x0 / CHUNK_SIZE, cx1 = x1 / CHUNK_SIZE;
+        const int cy0 = y0 / CHUNK_SIZE, cy1 = y1 / CHUNK_SIZE;
+        const int sx0 = cx0 / SUPER_CHUNK_CHUNKS, sx1 = cx1 / SUPER_CHUNK_CHUNKS;
+        for (int sy = cy0 / SUPER_CHUNK_CHUNKS; sy <= cy1 / SUPER_CHUNK_CHUNKS; ++sy) {
+            // A whole band of chunk rows is settled by one test of its super-chunks.
+            if (!anyBits(&superBits[(std::size_t)sy * superWords], sx0, sx1)) continue;
+            const int rowEnd = std::min(cy1, sy * SUPER_CHUNK_CHUNKS + SUPER_CHUNK_CHUNKS - 1);
+            for (int cy = std::max(cy0, sy * SUPER_CHUNK_CHUNKS); cy <= rowEnd; ++cy) {
+                if (anyBits(&chunkBits[(std::size_t)cy * chunkWords], cx0, cx1)) return false;
+            }
+        }
+        return true;
+    }
+
+    // Number of chunks whose bit is set (for statistics).
+    std::size_t occupiedChunks() const {
+        std::size_t count = 0;
+        for (unsigned int cy = 0; cy < chunkCount.y; ++cy) {
+            for (unsigned int cx = 0; cx < chunkCount.x; ++cx) count += chunkEmpty((int)cx, (int)cy) ? 0 : 1;
+        }
+        return count;
+    }
+
+private:
+    sf::Vector2u size;       // Level size in tiles.
+    sf::Vector2u chunkCount; // Chunks along each axis.
+    sf::Vector2u superCount; // Super-chunks along each axis.
+    std::size_t chunkWords = 0; // Bit words per row of chunks.
+    std::size_t superWords = 0; // Bit words per row of super-chunks.
+    std::vector<std::uint64_t> chunkBits;
+    std::vector<std::uint64_t> superBits;
+    std::vector<std::uint8_t> dirtyFlags; // Per chunk: already in `dirty`.
+    std::vector<std::uint32_t> dirty;     // Chunks to rescan, by index.
+    bool rescanAll = true;                // reset() since the last refresh().
+
+    // True if any of bits a to b (inclusive) of a row of words is set.
+    static bool anyBits(const std::uint64_t* row, int a, int b) {
+        for (int w = a / 64; w <= b / 64; ++w) {
+            std::uint64_t mask = ~std::uint64_t(0);
+            if (w == a / 64) mask &= ~std::uint64_t(0) << (a % 64);
+            if (w == b / 64) mask &= ~std::uint64_t(0) >> (63 - b % 64);
+            if (row[w] & mask) return true;
+        }
+        return false;
+    }
+
+    // True if chunk (cx, cy) holds any tile but Air. Full-width chunk rows are
+    // read as two words (Air is 0, so a row is empty when their OR is 0).
+    bool scanChunk(const std::vector<TileType>& tiles, int cx, int cy) const {
+        static_assert(Air == 0, "the word test relies on Air being 0");
+        static_assert(CHUNK_SIZE % 8 == 0, "chunk rows are read in words of 8 tiles");
+        const int x0 = cx * CHUNK_SIZE;
+        const int x1 = std::min(x0 + CHUNK_SIZE, (int)size.x);
+        const int y1 = std::min((cy + 1) * CHUNK_SIZE, (int)size.y);
+        for (int y = cy * CHUNK_SIZE; y < y1; ++y) {
+            const TileType* row = tiles.data() + (std::size_t)y * size.x;
+            int x = x0;
+            std::uint64_t any = 0;
+            for (; x + 8 <= x1; x += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, row + x, sizeof(word));
+                any |= word;
+            }
+            for (; x < x1; ++x) any |= row[x];
+            if (any != 0) return true;
+        }
+        return false;
+    }
+
+    // Recomputes the bit of super-chunk (sx, sy) from its chunks' bits.
+    void updateSuperChunk(int sx, int sy) {
+        const int cx0 = sx * SUPER_CHUNK_CHUNKS;
+        const int cx1 = std::min(cx0 + SUPER_CHUNK_CHUNKS, (int)chunkCount.x) - 1;
+        const int cy1 = std::min((sy + 1) * SUPER_CHUNK_CHUNKS, (int)chunkCount.y);
+        bool occupied = false;
+        for (int cy = sy * SUPER_CHUNK_CHUNKS; cy < cy1 && !occupied; ++cy) {
+            occupied = anyBits(&chunkBits[(std::size_t)cy * chunkWords], cx0, cx1);
+        }
+        std::uint64_t& word = superBits[(std::size_t)sy * superWords + sx / 64];
+        const std::uint64_t bit = std::uint64_t(1) << (sx % 64);
+        word = occupied ? (word | bit) : (word & ~bit);
+    }
+};
+
+
+// --- Level Representation ---
+
+// The tile types themselves (TileType) and their properties live in TileTraits.hpp.
+
+// Structure (`struct`) to group together all data related to a game level.
+struct Level {
+    // The core level data: a 2D grid stored row by row in one flat vector.
+    // The tile at column x and row y lives at index `y * size.x + x`.
+    // Keeping all rows in a single allocation means neighbouring rows are
+    // neighbours in memory too, which matters for code that walks the grid
+    // in arbitrary directions (like the raycasts in Raycast.hpp).
+    std::vector<TileType> tiles;
+    // The dimensions of the level grid in number of tiles (e.g., 40 tiles wide).
+    sf::Vector2u size; // sf::Vector2u holds two unsigned integers (x, y).
+    // The dimensions of the level converted to pixels. Calculated once for efficiency.
+    // Useful for boundary checks involving pixel coordinates (like the view).
+    sf::Vector2f sizePixels; // sf::Vector2f holds two floats (x, y).
+    // Number of chunks (CHUNK_SIZE x CHUNK_SIZE tiles) along each axis; the
+    // last row/column of chunks may be partially outside the level.
+    sf::Vector2u chunkCount;
+    // A counter per chunk that goes up every time a tile in that chunk changes.
+    // Caches remember the revision they were built from and rebuild a chunk
+    // when the level's revision differs, without the level having to know
+    // which caches exist.
+    std::vector<unsigned int> chunkRevisions;
+    // Which chunks hold anything but Air (see TileOccupancy above). Kept
+    // conservative by markChunkChanged; refreshOccupancy() tightens it.
+    TileOccupancy occupancy;
+
+    // Sets the grid dimensions, recomputes the pixel size and fills every
+    // cell with the given tile type (Air by default).
+    void resize(sf::Vector2u newSize, TileType fill = Air) {
+        size = newSize;
+        sizePixels = {(float)size.x * TILE_SIZE, (float)size.y * TILE_SIZE};
+        tiles.assign((std::size_t)size.x * size.y, fill);
+        chunkCount = {(size.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE};
+        // Start at 1 so that caches initialised with revision 0 rebuild everything.
+        chunkRevisions.assign((std::size_t)chunkCount.x * chunkCount.y, 1);
+        occupancy.reset(size);
+    }
+
+    // Returns true if (x, y) is a valid cell of the grid.
+    bool inBounds(int x, int y) const {
+        return x >= 0 && x < (int)size.x && y >= 0 && y < (int)size.y;
+    }
+
+    // Member function to safely retrieve the tile type at given grid coordinates (x, y).
+    // `const` indicates this function doesn't modify the Level object's data.
+    TileType getTile(int x, int y) const {
+        // Boundary check: Ensure x and y are within the valid range of the grid.
+        if (inBounds(x, y)) {
+            // Valid coordinates: return the tile type from the flat vector.
+            return tiles[(std::size_t)y * size.x + x];
+        }
+        // Invalid coordinates (outside the map): Treat as Air to prevent errors
+        // and simplify collision logic near the level edges.
+        return Air;
+    }
+
+    // Changes the tile at (x, y). Writes outside the grid are ignored.
+    void setTile(int x, int y, TileType type) {
+        if (inBounds(x, y)) {
+            tiles[(std::size_t)y * size.x + x] = type;
+            if (type != Air) {
+                markChunkChanged(x / CHUNK_SIZE, y / CHUNK_SIZE);
+            } else {
+                // Clearing a tile cannot make an empty chunk occupied.
+                ++chunkRevisions[(std::size_t)(y / CHUNK_SIZE) * chunkCount.x + x / CHUNK_SIZE];
+                occupancy.markMaybeEmpty(x / CHUNK_SIZE, y / CHUNK_SIZE);
+            }
+        }
+    }
+
+    // Returns the change counter of chunk (cx, cy).
+    unsigned int getChunkRevision(int cx, int cy) const {
+        return chunkRevisions[(std::size_t)cy * chunkCount.x + cx];
+    }
+
+    // Bumps the change counter of chunk (cx, cy). setTile does this itself;
+    // code that writes `tiles` directly must call it for every chunk it edits.
+    void markChunkChanged(int cx, int cy) {
+        ++chunkRevisions[(std::size_t)cy * chunkCount.x + cx];
+        occupancy.markOccupied(cx, cy);
+    }
+
+    // Rescans the chunks changed since the last call so the occupancy bits of
+    // chunks that became empty are cleared. Cheap when nothing changed; the
+    // game calls it once per tick.
+    void refreshOccupancy() {
+        occupancy.refresh(tiles);
+    }
+
+    // True if every tile from (x0, y0) to (x1, y1) (inclusive) is known to be
+    // Air, tested chunk by chunk rather than tile by tile.
+    bool regionEmpty(int x0, int y0, int x1, int y1) const {
+        return occupancy.regionEmpty(x0, y0, x1, y1);
+    }
+};
+
+// --- Level Creation ---
+
+// Creates a simple, hardcoded level map for demonstration.
+inline Level createSimpleLevel() {
+    Level level;
+    // Set level dimensions in tiles (made wider to demonstrate scrolling),
+    // which also calculates the pixel size and fills the grid with Air.
+    level.resize({40, 15});
+
+    // --- Define Solid Tiles ---
+    // Floor
+    for (int x = 0; x < level.size.x; ++x) {
+        level.setTile(x, level.size.y - 1, Solid);
+    }
+    // Platforms
+    for (int x = 5; x < 10; ++x) level.setTile(x, 10, Solid);
+    for (int x = 12; x < 16; ++x) level.setTile(x, 8, Solid);
+    level.setTile(15, 6, Solid);
+    level.setTile(16, 6, Solid);
+    for (int x = 25; x < 30; ++x) level.setTile(x, 10, Solid);
+    for (int x = 32; x < 36; ++x) level.setTile(x, 7, Solid);
+    level.setTile(21, 12, Solid);
+    level.setTile(22, 12, Solid);
+    // Walls
+    for (int y = 11; y < level.size.y -1; ++y) level.setTile(2, y, Solid);
+    for (int y = 6; y < 11; ++y) level.setTile(18, y, Solid);
+    for (int y = 8; y < level.size.y -1; ++y) level.setTile(38, y, Solid);
+
+    // Coins
+    level.setTile(7, 9, Coin);
+    level.setTile(14, 7, Coin);
+
+    return level; // Return the fully defined level structure.
+}
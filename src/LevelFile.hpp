@@ -0,0 +1,206 @@
+#pragma once
+
+// --- Includes ---
+// The level structure that files are loaded into.
+#include "Level.hpp"
+// This header provides std::min.
+#include <algorithm>
+// This header provides std::uint64_t for the chunk hashes.
+#include <cstdint>
+// This header provides std::filesystem::path for file locations.
+#include <filesystem>
+// This header provides std::ifstream for reading level files.
+#include <fstream>
+// This header provides std::ostringstream, used to read a whole file at once.
+#include <sstream>
+// This header provides std::string.
+#include <string>
+// This header provides std::vector.
+#include <vector>
+
+// --- Level Text Format ---
+// Levels are plain text files, one line per row of tiles and one character
+// per tile, so they can be edited in any text editor. The character of each
+// tile kind is its `symbol` in TileTraits.hpp, for example:
+//
+//   .  Air        #  Solid      o  Coin
+//   B  Brick      ^  Spikes     *  Gem
+//
+// Lines starting with ';' are comments. Shorter lines are padded with Air up
+// to the width of the longest line.
+
+// Converts a level file character into a tile type. Returns false for
+// characters that don't mean anything.
+inline bool charToTile(char c, TileType& tile) {
+    if (c == ' ') {
+        tile = Air; // Spaces are accepted as Air too.
+        return true;
+    }
+    const unsigned char index = (unsigned char)c;
+    if (index >= TILES_BY_SYMBOL.size() || !TILE_SYMBOL_VALID[index]) {
+        return false;
+    }
+    tile = TILES_BY_SYMBOL[index];
+    return true;
+}
+
+// Converts a tile type into its level file character ('?' for kinds that
+// have no symbol).
+inline char tileToChar(TileType tile) {
+    const char symbol = TILE_DEFINITIONS[tile].symbol;
+    return symbol != 0 ? symbol : '?';
+}
+
+// Builds a level from the text of a level file. On failure returns false and
+// describes the problem in `error`.
+inline bool parseLevelText(const std::string& text, Level& level, std::string& error) {
+    // Split into rows, dropping comments and carriage returns (Windows files).
+    std::vector<std::string> rows;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty() && line[0] == ';') continue;
+        rows.push_back(line);
+    }
+    // Ignore blank lines at the end of the file.
+    while (!rows.empty() && rows.back().empty()) rows.pop_back();
+    if (rows.empty()) {
+        error = "the level file contains no rows";
+        return false;
+    }
+
+    std::size_t width = 0;
+    for (const std::string& row : rows) width = std::max(width, row.size());
+    level.resize({(unsigned int)width, (unsigned int)rows.size()});
+    for (std::size_t y = 0; y < rows.size(); ++y) {
+        for (std::size_t x = 0; x < rows[y].size(); ++x) {
+            TileType tile;
+            if (!charToTile(rows[y][x], tile)) {
+                error = "unknown tile '" + std::string(1, rows[y][x]) + "' at row " +
+                        std::to_string(y + 1) + ", column " + std::to_string(x + 1);
+                return false;
+            }
+            level.tiles[y * width + x] = tile;
+        }
+    }
+    return true;
+}
+
+// Loads a level file from disk. On failure returns false and describes the
+// problem in `error`.
+inline bool loadLevelFile(const std::filesystem::path& path, Level& level, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "could not open '" + path.string() + "'";
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return parseLevelText(contents.str(), level, error);
+}
+
+// --- Chunk Hashes ---
+
+// Computes a 64-bit FNV-1a hash of the tiles in chunk (cx, cy). Two chunks with
+// the same tiles always have the same hash, so comparing hashes is a cheap way
+// to find out which chunks differ between two versions of a level.
+inline std::uint64_t hashChunk(const Level& level, int cx, int cy) {
+    std::uint64_t hash = 14695981039346656037ull;
+    const int x0 = cx * CHUNK_SIZE;
+    const int y0 = cy * CHUNK_SIZE;
+    const int x1 = std::min(x0 + CHUNK_SIZE, (int)level.size.x);
+    const int y1 = std::min(y0 + CHUNK_SIZE, (int)level.size.y);
+    for (int y = y0; y < y1; ++y) {
+        const TileType* row = &level.tiles[(std::size_t)y * level.size.x];
+        for (int x = x0; x < x1; ++x) {
+            hash ^= (std::uint64_t)row[x];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// The hash of every chunk of a level. `update` only rehashes chunks whose
+// revision changed since they were last hashed (e.g. a collected coin), so
+// keeping the hashes of the running level current is almost free. A level of
+// a different size is hashed from scratch, even with the same chunk count:
+// its revisions start over and could match the ones the old hashes were
+// computed at.
+struct LevelChunkHashes {
+    sf::Vector2u levelSize;
+    sf::Vector2u chunkCount;
+    std::vector<std::uint64_t> hashes;
+    std::vector<unsigned int> hashedRevisions;
+
+    void update(const Level& level) {
+        if (chunkCount != level.chunkCount || levelSize != level.size) {
+            levelSize = level.size;
+            chunkCount = level.chunkCount;
+            hashes.assign(level.chunkRevisions.size(), 0);
+            hashedRevisions.assign(level.chunkRevisions.size(), 0);
+        }
+        for (unsigned int cy = 0; cy < chunkCount.y; ++cy) {
+            for (unsigned int cx = 0; cx < chunkCount.x; ++cx) {
+                const std::size_t i = (std::size_t)cy * chunkCount.x + cx;
+                if (hashedRevisions[i] != level.chunkRevisions[i]) {
+                    hashes[i] = hashChunk(level, (int)cx, (int)cy);
+                    hashedRevisions[i] = level.chunkRevisions[i];
+                }
+            }
+        }
+    }
+};
+
+// --- Applying a Reloaded Level ---
+
+// What applyLevelReload changed.
+struct LevelReloadResult {
+    bool resized = false;         // Dimensions changed: the whole level was replaced.
+    std::size_t chunksChanged = 0;
+    std::size_t chunksTotal = 0;
+    // The chunks that were copied (chunk coordinates); empty if resized.
+    std::vector<sf::Vector2i> changedChunks;
+};
+
+// Brings `current` up to date with `incoming` (a freshly loaded version of the
+// same level file). Only chunks whose hashes differ are copied, and only their
+// revisions are bumped, so render caches and other derived data rebuild just
+// those chunks. `currentHashes` must describe `current` and is kept up to date.
+inline LevelReloadResult applyLevelReload(Level& current, LevelChunkHashes& currentHashes,
+                                          const Level& incoming, const LevelChunkHashes& incomingHashes) {
+    LevelReloadResult result;
+    currentHashes.update(current);
+    result.chunksTotal = incoming.chunkRevisions.size();
+
+    if (current.size != incoming.size) {
+        // A different size changes every chunk's extent: replace everything.
+        current = incoming;
+        result.resized = true;
+        result.chunksChanged = result.chunksTotal;
+        currentHashes.update(current);
+        return result;
+    }
+
+    for (unsigned int cy = 0; cy < current.chunkCount.y; ++cy) {
+        for (unsigned int cx = 0; cx < current.chunkCount.x; ++cx) {
+            const std::size_t i = (std::size_t)cy * current.chunkCount.x + cx;
+            if (currentHashes.hashes[i] == incomingHashes.hashes[i]) continue;
+            // Copy the chunk row by row.
+            const unsigned int x0 = cx * CHUNK_SIZE;
+            const unsigned int x1 = std::min(x0 + CHUNK_SIZE, current.size.x);
+            const unsigned int y0 = cy * CHUNK_SIZE;
+            const unsigned int y1 = std::min(y0 + CHUNK_SIZE, current.size.y);
+            for (unsigned int y = y0; y < y1; ++y) {
+                const std::size_t rowStart = (std::size_t)y * current.size.x;
+                std::copy(incoming.tiles.begin() + rowStart + x0, incoming.tiles.begin() + rowStart + x1,
+                          current.tiles.begin() + rowStart + x0);
+            }
+            current.markChunkChanged((int)cx, (int)cy);
+            ++result.chunksChanged;
+            result.changedChunks.push_back({(int)cx, (int)cy});
+        }
+    }
+    currentHashes.update(current);
+    return result;
+}
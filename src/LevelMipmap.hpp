@@ -0,0 +1,297 @@
+#pragma once
+
+// --- Includes ---
+// Tile types, their colors and the level storages.
+#include "Level.hpp"
+#include "RleLevel.hpp"
+// sf::Texture, which holds one mip level for drawing.
+#include <SFML/Graphics.hpp>
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides fixed-width integer types.
+#include <cstdint>
+// This header provides std::numeric_limits for empty rectangles.
+#include <limits>
+// This header provides std::vector.
+#include <vector>
+
+// --- Level Mipmap ---
+
+// A pyramid of ever smaller summaries of the level, for the minimap and for
+// zoomed-out views, where drawing individual tiles would cost a vertex per
+// tile for details smaller than a pixel.
+//
+// Mip 0 is the level itself. Every cell of mip k summarizes 2x2 cells of mip
+// k - 1 (so 2^k x 2^k tiles) as its dominant tile type (the non-Air type that
+// covers the most of it) and its coverage (how much of it is not Air, 0-255).
+// The pyramid ends at a single cell.
+//
+// tileChanged() updates the cells above one changed tile, one per mip, and
+// stops as soon as a cell comes out unchanged, so editing a tile costs a few
+// dozen operations; regionChanged() does the same for a whole rectangle of
+// changed tiles. getTexture() turns a mip into a texture (one texel per
+// cell, the tile's color faded by coverage), drawn with a single sprite; after
+// edits only the changed rectangle of it is uploaded again.
+class LevelMipmap {
+public:
+    // One cell of a mip level.
+    struct Cell {
+        TileType type = Air;        // Dominant non-Air tile type (Air if empty).
+        std::uint8_t coverage = 0;  // Share of the cell that is not Air, 0-255.
+        bool operator==(const Cell& other) const { return type == other.type && coverage == other.coverage; }
+        bool operator!=(const Cell& other) const { return !(*this == other); }
+    };
+
+    // Largest texture getTexture() creates (every GPU supports at least this).
+    static constexpr unsigned int MAX_TEXTURE_SIZE = 4096;
+
+    // Builds every mip of `level` from scratch. The textures are kept if the
+    // level's size didn't change (and uploaded again as a whole).
+    template <typename LevelT>
+    void rebuild(const LevelT& level) {
+        const bool resized = level.size != size || textures.empty();
+        size = level.size;
+        mips.clear();
+        sf::Vector2u mipSize = size;
+        while (mipSize.x > 1 || mipSize.y > 1) {
+            mipSize = {(mipSize.x + 1) / 2, (mipSize.y + 1) / 2};
+            mips.push_back({mipSize, std::vector<Cell>((std::size_t)mipSize.x * mipSize.y), Rect()});
+        }
+        if (!mips.empty()) buildFirstMip(level);
+        for (int mip = 2; mip <= (int)mips.size(); ++mip) buildMip(mip);
+        for (Mip& mip : mips) mip.dirty = {0, 0, (int)mip.size.x - 1, (int)mip.size.y - 1};
+        tileDirty = {0, 0, (int)size.x - 1, (int)size.y - 1};
+        if (resized) {
+            textures.clear();
+            textures.resize(mips.size() + 1);
+        }
+    }
+
+    // Updates the mips after the tile at (x, y) of `level` changed (call it
+    // after Level::setTile).
+    template <typename LevelT>
+    void tileChanged(const LevelT& level, int x, int y) {
+        if (level.size != size) {
+            rebuild(level); // Resized (or never built): start over.
+            return;
+        }
+        if (x < 0 || y < 0 || x >= (int)size.x || y >= (int)size.y) return;
+        markDirty(0, x, y);
+        for (int mip = 1; mip <= (int)mips.size(); ++mip) {
+            x /= 2;
+            y /= 2;
+            Mip& current = mips[mip - 1];
+            Cell& cell = current.cells[(std::size_t)y * current.size.x + x];
+            const Cell updated = summarize(level, mip, x, y);
+            if (updated == cell) return; // Nothing changes further up either.
+            cell = updated;
+            markDirty(mip, x, y);
+        }
+    }
+
+    // Updates the mips after any number of tiles within the rectangle
+    // (x0, y0)-(x1, y1) (inclusive) changed: every cell above the rectangle is
+    // summarized again, one mip at a time, until a mip comes out unchanged.
+    // The textures are kept; only the changed cells are uploaded again.
+    template <typename LevelT>
+    void regionChanged(const LevelT& level, int x0, int y0, int x1, int y1) {
+        if (level.size != size) {
+            rebuild(level); // Resized (or never built): start over.
+            return;
+        }
+        Rect region = {std::max(x0, 0), std::max(y0, 0), std::min(x1, (int)size.x - 1), std::min(y1, (int)size.y - 1)};
+        if (region.empty()) return;
+        tileDirty.add(region);
+        for (int mip = 1; mip <= (int)mips.size(); ++mip) {
+            region = {region.x0 / 2, region.y0 / 2, region.x1 / 2, region.y1 / 2};
+            Mip& current = mips[mip - 1];
+            bool anyChanged = false;
+            for (int y = region.y0; y <= region.y1; ++y) {
+                for (int x = region.x0; x <= region.x1; ++x) {
+                    Cell& cell = current.cells[(std::size_t)y * current.size.x + x];
+                    const Cell updated = summarize(level, mip, x, y);
+                    if (updated == cell) continue;
+                    cell = updated;
+                    markDirty(mip, x, y);
+                    anyChanged = true;
+                }
+            }
+            if (!anyChanged) return; // Nothing changes further up either.
+        }
+    }
+
+    // Number of mips, including mip 0 (the level).
+    int levelCount() const { return (int)mips.size() + 1; }
+
+    // Size of mip `mip` in cells.
+    sf::Vector2u getMipSize(int mip) const { return mip == 0 ? size : mips[mip - 1].size; }
+
+    // Cell (x, y) of mip `mip`; for mip 0 that is the tile itself.
+    template <typename LevelT>
+    Cell getCell(const LevelT& level, int mip, int x, int y) const {
+        if (mip == 0) {
+            const TileType tile = level.getTile(x, y);
+            return {tile, (std::uint8_t)(tile == Air ? 0 : 255)};
+        }
+        const Mip& current = mips[mip - 1];
+        return current.cells[(std::size_t)y * current.size.x + x];
+    }
+
+    // The finest mip that still has at least `tilesPerPixel` tiles per cell
+    // (so no more than one cell per screen pixel) and fits in a texture.
+    int mipForScale(float tilesPerPixel) const {
+        int mip = 0;
+        while (mip + 1 < levelCount() &&
+               ((float)(1 << mip) < tilesPerPixel || getMipSize(mip).x > MAX_TEXTURE_SIZE || getMipSize(mip).y > MAX_TEXTURE_SIZE)) {
+            ++mip;
+        }
+        return mip;
+    }
+
+    // Mip `mip` as a texture, one texel per cell. Created on first use; after
+    // that only the cells changed since the last call are uploaded.
+    template <typename LevelT>
+    const sf::Texture& getTexture(const LevelT& level, int mip) {
+        MipTexture& entry = textures[mip];
+        const sf::Vector2u mipSize = getMipSize(mip);
+        Rect& dirty = mip == 0 ? tileDirty : mips[mip - 1].dirty;
+        if (!entry.created) {
+            entry.created = entry.texture.resize(mipSize);
+            dirty = {0, 0, (int)mipSize.x - 1, (int)mipSize.y - 1};
+        }
+        const Rect region = dirty;
+        dirty = Rect();
+        if (region.empty() || !entry.created) return entry.texture;
+
+        const sf::Vector2u regionSize((unsigned int)(region.x1 - region.x0 + 1), (unsigned int)(region.y1 - region.y0 + 1));
+        pixels.resize((std::size_t)regionSize.x * regionSize.y * 4);
+        std::uint8_t* out = pixels.data();
+        for (int y = region.y0; y <= region.y1; ++y) {
+            for (int x = region.x0; x <= region.x1; ++x) {
+                const Cell cell = getCell(level, mip, x, y);
+                const sf::Color color = TILE_DEFINITIONS[cell.type].color;
+                *out++ = color.r;
+                *out++ = color.g;
+                *out++ = color.b;
+                *out++ = (std::uint8_t)(color.a * cell.coverage / 255);
+            }
+        }
+        entry.texture.update(pixels.data(), regionSize, {(unsigned int)region.x0, (unsigned int)region.y0});
+        return entry.texture;
+    }
+
+private:
+    // A rectangle of cells, inclusive.
+    struct Rect {
+        int x0 = std::numeric_limits<int>::max(), y0 = std::numeric_limits<int>::max();
+        int x1 = std::numeric_limits<int>::min(), y1 = std::numeric_limits<int>::min();
+        bool empty() const { return x0 > x1 || y0 > y1; }
+        void add(const Rect& other) {
+            x0 = std::min(x0, other.x0);
+            y0 = std::min(y0, other.y0);
+            x1 = std::max(x1, other.x1);
+            y1 = std::max(y1, other.y1);
+        }
+    };
+
+    struct Mip {
+        sf::Vector2u size;
+        std::vector<Cell> cells;
+        Rect dirty; // Cells changed since the mip's texture was last updated.
+    };
+
+    struct MipTexture {
+        sf::Texture texture;
+        bool created = false;
+    };
+
+    sf::Vector2u size;
+    std::vector<Mip> mips; // mips[k - 1] is mip k.
+    Rect tileDirty;        // Changed tiles (mip 0) since its texture was updated.
+    std::vector<MipTexture> textures; // Per mip, created when first drawn.
+    std::vector<std::uint8_t> pixels; // Upload buffer, kept to reuse its memory.
+
+    void markDirty(int mip, int x, int y) {
+        (mip == 0 ? tileDirty : mips[mip - 1].dirty).add({x, y, x, y});
+    }
+
+    // Computes cell (x, y) of mip `mip` from its (up to) four children in the
+    // mip below. Children past the edge of an odd-sized mip don't count.
+    template <typename LevelT>
+    Cell summarize(const LevelT& level, int mip, int x, int y) const {
+        const sf::Vector2u below = getMipSize(mip - 1);
+        Cell children[4];
+        int count = 0;
+        for (int cy = 2 * y; cy <= 2 * y + 1 && cy < (int)below.y; ++cy) {
+            for (int cx = 2 * x; cx <= 2 * x + 1 && cx < (int)below.x; ++cx) children[count++] = getCell(level, mip - 1, cx, cy);
+        }
+        return combine(children, count);
+    }
+
+    // Fills mip 1 from the tiles, two rows of tiles per row of cells.
+    template <typename LevelT>
+    void buildFirstMip(const LevelT& level) {
+        Mip& first = mips[0];
+        std::vector<TileType> rows[2] = {std::vector<TileType>(size.x), std::vector<TileType>(size.x)};
+        for (int y = 0; y < (int)first.size.y; ++y) {
+            const int rowCount = std::min(2, (int)size.y - 2 * y);
+            for (int r = 0; r < rowCount; ++r) {
+                for (int x = 0; x < (int)size.x; ++x) rows[r][x] = level.getTile(x, 2 * y + r);
+            }
+            Cell* out = &first.cells[(std::size_t)y * first.size.x];
+            for (int x = 0; x < (int)first.size.x; ++x) {
+                Cell children[4];
+                int count = 0;
+                for (int r = 0; r < rowCount; ++r) {
+                    for (int cx = 2 * x; cx <= 2 * x + 1 && cx < (int)size.x; ++cx) {
+                        children[count++] = {rows[r][cx], (std::uint8_t)(rows[r][cx] == Air ? 0 : 255)};
+                    }
+                }
+                out[x] = combine(children, count);
+            }
+        }
+    }
+
+    // Fills mip `mip` (2 or more) from the cells of the mip below.
+    void buildMip(int mip) {
+        const Mip& below = mips[mip - 2];
+        Mip& current = mips[mip - 1];
+        for (int y = 0; y < (int)current.size.y; ++y) {
+            for (int x = 0; x < (int)current.size.x; ++x) {
+                Cell children[4];
+                int count = 0;
+                for (int cy = 2 * y; cy <= 2 * y + 1 && cy < (int)below.size.y; ++cy) {
+                    for (int cx = 2 * x; cx <= 2 * x + 1 && cx < (int)below.size.x; ++cx) {
+                        children[count++] = below.cells[(std::size_t)cy * below.size.x + cx];
+                    }
+                }
+                current.cells[(std::size_t)y * current.size.x + x] = combine(children, count);
+            }
+        }
+    }
+
+    // The summary of `count` (1 to 4) child cells.
+    static Cell combine(const Cell* children, int count) {
+        // Most of a level is uniform (open air, solid ground).
+        if (count == 4 && children[0] == children[1] && children[0] == children[2] && children[0] == children[3]) {
+            return children[0];
+        }
+        // The dominant type is the one whose children add up to the most coverage.
+        Cell result;
+        int coverage = 0, best = 0;
+        for (int i = 0; i < count; ++i) {
+            coverage += children[i].coverage;
+            if (children[i].type == Air) continue;
+            int weight = 0;
+            for (int j = 0; j < count; ++j) {
+                if (children[j].type == children[i].type) weight += children[j].coverage;
+            }
+            if (weight > best) {
+                best = weight;
+                result.type = children[i].type;
+            }
+        }
+        result.coverage = (std::uint8_t)((coverage + count / 2) / count);
+        return result;
+    }
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+// --- Includes ---
+// SFML's graphics module: each chunk is drawn from one sf::VertexArray.
+#include <SFML/Graphics.hpp>
+// The level whose tiles are drawn, in either storage (forEachTileRun).
+#include "Level.hpp"
+#include "RleLevel.hpp"
+// Tile lighting, applied as vertex colors.
+#include "LightMap.hpp"
+// This header provides std::min.
+#include <algorithm>
+// This header provides std::cos and std::sin for the coin outline.
+#include <cmath>
+// This header provides std::vector.
+#include <vector>
+
+// --- Level Render Cache ---
+
+// Keeps the tiles of every level chunk pre-built as triangles in one
+// sf::VertexArray per chunk, so drawing a visible chunk is a single draw call
+// instead of one call per tile.
+//
+// A chunk's vertices are rebuilt only when its revision in the Level changes
+// (see Level::chunkRevisions): collecting a coin or hot-reloading part of the
+// level rebuilds just the chunks that were touched, the next time they are drawn.
+//
+// With a LightMap, every vertex is tinted by the light around it: each corner
+// of a square takes the average light of the four tiles that meet there, so
+// light fades smoothly across tiles, and unlit Air is covered by a dark quad.
+// The chunk is then also rebuilt when its lighting revision changes.
+class LevelRenderCache {
+public:
+    // Returns the vertices for chunk (cx, cy), rebuilding them first if the
+    // chunk (or its lighting) changed since they were built. Works with Level
+    // and RleLevel. `lights` is optional; it must have been built for `level`.
+    template <typename LevelT>
+    const sf::VertexArray& getChunk(const LevelT& level, int cx, int cy, const LightMap* lights = nullptr) {
+        // A level of a different size (e.g. a resized reload or quickload)
+        // invalidates everything, even with the same chunk count: its
+        // revisions start over and could match the ones the old chunks were
+        // built from.
+        if (chunkCount != level.chunkCount || levelSize != level.size) {
+            chunkCount = level.chunkCount;
+            levelSize = level.size;
+            chunks.assign(level.chunkRevisions.size(), sf::VertexArray(sf::PrimitiveType::Triangles));
+            builtRevisions.assign(level.chunkRevisions.size(), 0);
+            builtLightRevisions.assign(level.chunkRevisions.size(), 0);
+        }
+        if (lights != nullptr && lights->getSize() != level.size) lights = nullptr;
+        const std::size_t i = (std::size_t)cy * chunkCount.x + cx;
+        // 0 stands for "unlit"; a light map's revisions start at 1.
+        const unsigned int lightRevision = lights != nullptr ? lights->getChunkRevision(cx, cy) : 0;
+        if (builtRevisions[i] != level.chunkRevisions[i] || builtLightRevisions[i] != lightRevision) {
+            buildChunk(level, lights, cx, cy, chunks[i]);
+            builtRevisions[i] = level.chunkRevisions[i];
+            builtLightRevisions[i] = lightRevision;
+            ++rebuildCount;
+        }
+        return chunks[i];
+    }
+
+    // Total number of chunk rebuilds so far (for statistics).
+    std::size_t rebuilds() const { return rebuildCount; }
+
+private:
+    sf::Vector2u chunkCount;
+    sf::Vector2u levelSize;                    // Size of the level the chunks were built for.
+    std::vector<sf::VertexArray> chunks;       // Pre-built triangles per chunk.
+    std::vector<unsigned int> builtRevisions;  // Level revision each chunk was built from.
+    std::vector<unsigned int> builtLightRevisions; // Light map revision (0 = built unlit).
+    std::size_t rebuildCount = 0;
+
+    // Number of segments used to approximate a coin's circle.
+    static constexpr int COIN_SEGMENTS = 10;
+
+    // Brightness of the darkest light level; caves are dim, not pitch black.
+    static constexpr int MIN_BRIGHTNESS = 24;
+
+    // Brightness (0-255) of a vertex whose four surrounding tiles have a total
+    // light of `sum` (0 to 4 * MAX_LIGHT).
+    static std::uint8_t cornerBrightness(int sum) {
+        return (std::uint8_t)(MIN_BRIGHTNESS + (255 - MIN_BRIGHTNESS) * sum / (4 * LightMap::MAX_LIGHT));
+    }
+
+    // Brightness of the four corners of tile (x, y): top-left, top-right,
+    // bottom-left, bottom-right. Tiles outside the level repeat the edge.
+    static void tileCorners(const LightMap& lights, int x, int y, std::uint8_t corners[4]) {
+        const sf::Vector2u size = lights.getSize();
+        const int xs[3] = {std::max(x - 1, 0), x, std::min(x + 1, (int)size.x - 1)};
+        const int ys[3] = {std::max(y - 1, 0), y, std::min(y + 1, (int)size.y - 1)};
+        int around[3][3];
+        for (int j = 0; j < 3; ++j) {
+            for (int i = 0; i < 3; ++i) around[j][i] = lights.getLight(xs[i], ys[j]);
+        }
+        for (int j = 0; j < 2; ++j) {
+            for (int i = 0; i < 2; ++i) {
+                corners[j * 2 + i] = cornerBrightness(around[j][i] + around[j][i + 1] + around[j + 1][i] + around[j + 1][i + 1]);
+            }
+        }
+    }
+
+    static sf::Color shade(sf::Color color, std::uint8_t brightness) {
+        return {(std::uint8_t)(color.r * brightness / 255), (std::uint8_t)(color.g * brightness / 255),
+                (std::uint8_t)(color.b * brightness / 255), color.a};
+    }
+
+    // Fills `vertices` with the triangles for every visible tile in chunk (cx, cy).
+    // Rows are walked run by run, so a stretch of Air is skipped in one step
+    // (unless it is lit and has to be checked for darkness).
+    template <typename LevelT>
+    static void buildChunk(const LevelT& level, const LightMap* lights, int cx, int cy, sf::VertexArray& vertices) {
+        vertices.clear();
+        const int x0 = cx * CHUNK_SIZE;
+        const int y0 = cy * CHUNK_SIZE;
+        const int x1 = std::min(x0 + CHUNK_SIZE, (int)level.size.x);
+        const int y1 = std::min(y0 + CHUNK_SIZE, (int)level.size.y);
+        for (int y = y0; y < y1; ++y) {
+            forEachTileRun(level, y, x0, x1, [&](int begin, int end, TileType type) {
+                // The tile's render style and color come from its definition.
+                const TileDefinition& definition = TILE_DEFINITIONS[type];
+                if (lights != nullptr) {
+                    for (int x = begin; x < end; ++x) appendLitTile(vertices, definition, *lights, x, y);
+                    return;
+                }
+                if (definition.style == TileRenderStyle::None) return;
+                for (int x = begin; x < end; ++x) appendTile(vertices, definition, x, y);
+            });
+        }
+    }
+
+    // Appends one tile tinted by the light map. Squares and unlit Air get
+    // smooth per-corner light; other shapes take the light of their tile.
+    static void appendLitTile(sf::VertexArray& vertices, const TileDefinition& definition, const LightMap& lights,
+                              int x, int y) {
+        const sf::Vector2f topLeft = {(float)x * TILE_SIZE, (float)y * TILE_SIZE};
+        const sf::Vector2f tileSize = {(float)TILE_SIZE, (float)TILE_SIZE};
+        if (definition.style == TileRenderStyle::Square || definition.style == TileRenderStyle::None) {
+            std::uint8_t corners[4];
+            tileCorners(lights, x, y, corners);
+            sf::Color colors[4];
+            for (int i = 0; i < 4; ++i) {
+                // Air is drawn as a black quad that is as opaque as it is dark.
+                colors[i] = definition.style == TileRenderStyle::None ? sf::Color(0, 0, 0, (std::uint8_t)(255 - corners[i]))
+                                                                      : shade(definition.color, corners[i]);
+            }
+            const bool fullyLit = corners[0] == 255 && corners[1] == 255 && corners[2] == 255 && corners[3] == 255;
+            if (definition.style == TileRenderStyle::None && fullyLit) return;
+            appendQuad(vertices, topLeft, tileSize, colors);
+            return;
+        }
+        TileDefinition shaded = definition;
+        shaded.color = shade(definition.color, cornerBrightness(4 * lights.getLight(x, y)));
+        appendTile(vertices, shaded, x, y);
+    }
+
+    // Appends the triangles of one tile at tile coordinates (x, y).
+    static void appendTile(sf::VertexArray& vertices, const TileDefinition& definition, int x, int y) {
+        const float left = (float)x * TILE_SIZE;
+        const float top = (float)y * TILE_SIZE;
+        switch (definition.style) {
+            case TileRenderStyle::None:
+                break;
+            case TileRenderStyle::Square:
+                // A full tile square (two triangles).
+                appendQuad(vertices, {left, top}, {(float)TILE_SIZE, (float)TILE_SIZE}, definition.color);
+                break;
+            case TileRenderStyle::Circle:
+                // A circle, slightly smaller than the tile, centred in it.
+                appendCircle(vertices, {left + TILE_SIZE / 2.f, top + TILE_SIZE / 2.f}, TILE_SIZE * 0.3f, definition.color);
+                break;
+            case TileRenderStyle::Spikes:
+                // Triangles pointing up along the bottom half of the tile.
+                appendSpikes(vertices, {left, top}, definition.color);
+                break;
+            case TileRenderStyle::Profile:
+                // One thin column per entry of the tile's height profile,
+                // so what you see is exactly what the player stands on.
+                appendProfile(vertices, {left, top}, TILE_HEIGHT_PROFILES[definition.profile], definition.color);
+                break;
+            case TileRenderStyle::Platform:
+                // A thin bar along the top edge, the only part that collides.
+                appendQuad(vertices, {left, top}, {(float)TILE_SIZE, TILE_SIZE * 0.2f}, definition.color);
+                break;
+        }
+    }
+
+    static void appendQuad(sf::VertexArray& vertices, sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+        const sf::Color colors[4] = {color, color, color, color};
+        appendQuad(vertices, position, size, colors);
+    }
+
+    // A quad with its own color at each corner (top-left, top-right,
+    // bottom-left, bottom-right), blended across it by the GPU.
+    static void appendQuad(sf::VertexArray& vertices, sf::Vector2f position, sf::Vector2f size, const sf::Color (&colors)[4]) {
+        const sf::Vector2f topRight = {position.x + size.x, position.y};
+        const sf::Vector2f bottomLeft = {position.x, position.y + size.y};
+        const sf::Vector2f bottomRight = position + size;
+        vertices.append({position, colors[0]});
+        vertices.append({topRight, colors[1]});
+        vertices.append({bottomLeft, colors[2]});
+        vertices.append({bottomLeft, colors[2]});
+        vertices.append({topRight, colors[1]});
+        vertices.append({bottomRight, colors[3]});
+    }
+
+    static void appendSpikes(sf::VertexArray& vertices, sf::Vector2f tileTopLeft, sf::Color color) {
+        const int spikeCount = 4;
+        const float width = (float)TILE_SIZE / spikeCount;
+        const float base = tileTopLeft.y + TILE_SIZE;
+        const float tip = tileTopLeft.y + TILE_SIZE * 0.5f;
+        for (int i = 0; i < spikeCount; ++i) {
+            const float left = tileTopLeft.x + width * i;
+            vertices.append({{left, base}, color});
+            vertices.append({{left + width / 2.f, tip}, color});
+            vertices.append({{left + width, base}, color});
+        }
+    }
+
+    static void appendProfile(sf::VertexArray& vertices, sf::Vector2f tileTopLeft,
+                              const std::array<std::uint8_t, TILE_PROFILE_COLUMNS>& heights, sf::Color color) {
+        const float unit = (float)TILE_SIZE / TILE_PROFILE_COLUMNS;
+        const float bottom = tileTopLeft.y + TILE_SIZE;
+        for (int column = 0; column < TILE_PROFILE_COLUMNS; ++column) {
+            const float height = heights[column] * unit;
+            appendQuad(vertices, {tileTopLeft.x + column * unit, bottom - height}, {unit, height}, color);
+        }
+    }
+
+    static void appendCircle(sf::VertexArray& vertices, sf::Vector2f center, float radius, sf::Color color) {
+        const float step = 6.2831853f / COIN_SEGMENTS;
+        for (int i = 0; i < COIN_SEGMENTS; ++i) {
+            const float a0 = step * i;
+            const float a1 = step * (i + 1);
+            vertices.append({center, color});
+            vertices.append({{center.x + std::cos(a0) * radius, center.y + std::sin(a0) * radius}, color});
+            vertices.append({{center.x + std::cos(a1) * radius, center.y + std::sin(a1) * radius}, color});
+        }
+    }
+};
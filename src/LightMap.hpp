@@ -0,0 +1,356 @@
+#pragma once
+
+// --- Includes ---
+// Tile types, their light tables, CHUNK_SIZE and the level storages.
+#include "Level.hpp"
+#include "RleLevel.hpp"
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides fixed-width integer types.
+#include <cstdint>
+// This header provides std::async and std::future for the parallel rebuild.
+#include <future>
+// This header provides std::thread::hardware_concurrency.
+#include <thread>
+// This header provides std::vector.
+#include <vector>
+
+// --- Light Map ---
+
+// One light level (0 = dark, MAX_LIGHT = full daylight) per tile.
+//
+// Light comes from two kinds of sources: daylight, which fills every tile of a
+// column from the top of the level down to the first tile that blocks light,
+// and tiles that emit light themselves (torches, see TILE_LIGHTS). From the
+// sources it spreads by flood fill (breadth-first) to the four neighbours,
+// losing one level per tile, so caves get darker the further they are from an
+// opening or a torch. Tiles that block light (everything TILE_SOLID) are lit
+// from their neighbours, so walls show the light falling on them, but don't
+// pass it on.
+//
+// Because a source reaches at most MAX_LIGHT - 1 tiles, a change only affects
+// the light nearby: tileChanged() removes the light that depended on the
+// changed tile and floods it back in from the surrounding tiles, touching a
+// few hundred tiles instead of the whole map. When many tiles change at once
+// (an avalanche of sand), regionChanged() relights a rectangle around them in
+// one go instead. rebuild() computes everything, in horizontal bands of
+// chunks on several threads.
+//
+// Like the level, the light map keeps a revision counter per chunk, so the
+// render cache rebuilds only chunks whose lighting changed.
+class LightMap {
+public:
+    static constexpr int MAX_LIGHT = 15;
+
+    // Computes the light of every tile of `level` from scratch. The level is
+    // split into bands of chunk rows that are lit in parallel on `threadCount`
+    // threads (0 = one per CPU core).
+    template <typename LevelT>
+    void rebuild(const LevelT& level, unsigned int threadCount = 0) {
+        size = level.size;
+        chunkCount = level.chunkCount;
+        light.assign((std::size_t)size.x * size.y, 0);
+        chunkRevisions.resize(level.chunkRevisions.size());
+        for (unsigned int& revision : chunkRevisions) ++revision;
+        skyDepth.assign(size.x, 0);
+        for (int x = 0; x < (int)size.x; ++x) skyDepth[x] = findSkyDepth(level, x, 0);
+
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const int bandCount = (int)std::min<unsigned int>(threadCount, std::max(1u, chunkCount.y));
+        std::vector<std::future<void>> bands;
+        for (int band = 0; band < bandCount; ++band) {
+            // Whole chunk rows per band.
+            const int y0 = (int)(chunkCount.y * band / bandCount) * CHUNK_SIZE;
+            const int y1 = std::min((int)(chunkCount.y * (band + 1) / bandCount) * CHUNK_SIZE, (int)size.y);
+            if (band + 1 == bandCount) {
+                RectWork work;
+                lightRect(level, 0, y0, (int)size.x, y1, work); // The calling thread takes the last band.
+            } else {
+                bands.push_back(std::async(std::launch::async, [this, &level, y0, y1] {
+                    RectWork work;
+                    lightRect(level, 0, y0, (int)size.x, y1, work);
+                }));
+            }
+        }
+        for (auto& band : bands) band.get();
+    }
+
+    // Updates the light after the tile at (x, y) of `level` changed (call it
+    // after Level::setTile). Only the light around the tile is recomputed.
+    template <typename LevelT>
+    void tileChanged(const LevelT& level, int x, int y) {
+        if (level.size != size) {
+            rebuild(level); // Resized (or never built): start over.
+            return;
+        }
+        if (x < 0 || y < 0 || x >= (int)size.x || y >= (int)size.y) return;
+        updatedTiles = 0;
+
+        // Tiles whose own light may change: the tile itself and, if it opened
+        // or closed the column to the sky, the tiles that gained or lost daylight.
+        const int oldDepth = skyDepth[x];
+        int newDepth = oldDepth;
+        if (blocksLight(level.getTile(x, y))) {
+            newDepth = std::min(oldDepth, y);
+        } else if (y == oldDepth) {
+            newDepth = findSkyDepth(level, x, y + 1);
+        }
+        skyDepth[x] = newDepth;
+        changed.clear();
+        changed.push_back(index(x, y));
+        for (int row = std::min(oldDepth, newDepth); row < std::max(oldDepth, newDepth); ++row) {
+            if (row != y) changed.push_back(index(x, row));
+        }
+
+        // 1. Remove the light that may have come from the changed tiles: walk
+        // outwards while the light keeps getting dimmer (it came from here);
+        // brighter tiles have another source and are queued to fill back in.
+        removeQueue.clear();
+        addQueue.clear();
+        for (std::uint32_t i : changed) {
+            removeQueue.push_back({i, light[i]});
+            setLight(i, 0);
+        }
+        for (std::size_t head = 0; head < removeQueue.size(); ++head) {
+            const Removal removal = removeQueue[head];
+            forEachNeighbour(removal.index, [&](std::uint32_t n) {
+                const std::uint8_t neighbourLight = light[n];
+                if (neighbourLight == 0) return;
+                if (neighbourLight < removal.light) {
+                    removeQueue.push_back({n, neighbourLight});
+                    setLight(n, 0);
+                    const std::uint8_t emitted = emission(level, n);
+                    if (emitted > 0) {
+                        setLight(n, emitted);
+                        addQueue.push_back(n);
+                    }
+                } else {
+                    addQueue.push_back(n);
+                }
+            });
+        }
+
+        // 2. The changed tiles' own light, then flood everything back in.
+        for (std::uint32_t i : changed) {
+            const std::uint8_t emitted = emission(level, i);
+            if (emitted > light[i]) {
+                setLight(i, emitted);
+                addQueue.push_back(i);
+            }
+        }
+        spread(level, addQueue);
+    }
+
+    // Updates the light after any number of tiles within the rectangle
+    // (x0, y0)-(x1, y1) (inclusive) changed. Cheaper than tileChanged() per
+    // tile once more than a few tiles of the rectangle changed: the light
+    // around the rectangle is recomputed once, like a band of rebuild().
+    template <typename LevelT>
+    void regionChanged(const LevelT& level, int x0, int y0, int x1, int y1) {
+        if (level.size != size) {
+            rebuild(level); // Resized (or never built): start over.
+            return;
+        }
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, (int)size.x - 1);
+        y1 = std::min(y1, (int)size.y - 1);
+        if (x0 > x1 || y0 > y1) return;
+
+        // Columns whose first blocking tile moved gained or lost daylight
+        // between the old and the new depth, which may lie outside the rectangle.
+        int top = y0, bottom = y1;
+        for (int x = x0; x <= x1; ++x) {
+            const int oldDepth = skyDepth[x];
+            const int newDepth = findSkyDepth(level, x, 0);
+            if (newDepth == oldDepth) continue;
+            skyDepth[x] = newDepth;
+            top = std::min(top, std::min(oldDepth, newDepth));
+            bottom = std::max(bottom, std::max(oldDepth, newDepth) - 1);
+        }
+
+        // A change reaches at most MAX_LIGHT - 1 tiles.
+        const int reach = MAX_LIGHT - 1;
+        updatedTiles = lightRect(level, std::max(x0 - reach, 0), std::max(top - reach, 0),
+                                 std::min(x1 + reach + 1, (int)size.x), std::min(bottom + reach + 1, (int)size.y),
+                                 regionWork);
+    }
+
+    // Light level at (x, y); tiles outside the level count as daylight.
+    std::uint8_t getLight(int x, int y) const {
+        if (x < 0 || y < 0 || x >= (int)size.x || y >= (int)size.y) return MAX_LIGHT;
+        return light[index(x, y)];
+    }
+
+    // Change counter of the lighting in chunk (cx, cy), like Level::getChunkRevision.
+    unsigned int getChunkRevision(int cx, int cy) const {
+        return chunkRevisions[(std::size_t)cy * chunkCount.x + cx];
+    }
+
+    // Size of the level the map was built for (tiles).
+    sf::Vector2u getSize() const { return size; }
+
+    // Number of tiles whose light changed in the last tileChanged() or
+    // regionChanged() call.
+    std::size_t lastUpdateTiles() const { return updatedTiles; }
+
+private:
+    struct Removal {
+        std::uint32_t index;
+        std::uint8_t light; // The tile's light before it was removed.
+    };
+
+    sf::Vector2u size;
+    sf::Vector2u chunkCount;
+    std::vector<std::uint8_t> light;
+    // Per column: the first row that blocks light (rows above it get daylight).
+    std::vector<int> skyDepth;
+    std::vector<unsigned int> chunkRevisions;
+    std::size_t updatedTiles = 0;
+    // Work lists of tileChanged, kept to reuse their memory.
+    std::vector<std::uint32_t> changed;
+    std::vector<Removal> removeQueue;
+    std::vector<std::uint32_t> addQueue;
+
+    // Buffers of one lightRect() call.
+    struct RectWork {
+        std::vector<std::uint8_t> local;
+        std::vector<std::uint8_t> blocks;
+        std::vector<std::uint32_t> queue;
+    };
+    RectWork regionWork; // For regionChanged(), kept to reuse its memory.
+
+    static bool blocksLight(TileType tile) { return tileHas<TILE_SOLID>(tile); }
+
+    std::uint32_t index(int x, int y) const { return (std::uint32_t)y * size.x + (std::uint32_t)x; }
+
+    template <typename LevelT>
+    static int findSkyDepth(const LevelT& level, int x, int fromRow) {
+        int y = fromRow;
+        while (y < (int)level.size.y && !blocksLight(level.getTile(x, y))) ++y;
+        return y;
+    }
+
+    // The light tile i produces by itself: daylight or its own glow.
+    template <typename LevelT>
+    std::uint8_t emission(const LevelT& level, std::uint32_t i) const {
+        const int x = (int)(i % size.x);
+        const int y = (int)(i / size.x);
+        if (y < skyDepth[x]) return MAX_LIGHT;
+        return TILE_LIGHTS[level.getTile(x, y)];
+    }
+
+    void setLight(std::uint32_t i, std::uint8_t value) {
+        if (light[i] == value) return;
+        light[i] = value;
+        ++updatedTiles;
+        ++chunkRevisions[(i / size.x / CHUNK_SIZE) * chunkCount.x + (i % size.x) / CHUNK_SIZE];
+    }
+
+    template <typename Visitor>
+    void forEachNeighbour(std::uint32_t i, Visitor&& visit) const {
+        const std::uint32_t x = i % size.x;
+        if (x > 0) visit(i - 1);
+        if (x + 1 < size.x) visit(i + 1);
+        if (i >= size.x) visit(i - size.x);
+        if (i + size.x < light.size()) visit(i + size.x);
+    }
+
+    // Flood fill from the queued tiles: every tile that doesn't block light
+    // passes its light minus one to any dimmer neighbour.
+    template <typename LevelT>
+    void spread(const LevelT& level, std::vector<std::uint32_t>& queue) {
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const std::uint32_t i = queue[head];
+            const std::uint8_t value = light[i];
+            if (value <= 1 || blocksLight(level.getTile((int)(i % size.x), (int)(i / size.x)))) continue;
+            forEachNeighbour(i, [&](std::uint32_t n) {
+                if (light[n] + 1 < value) {
+                    setLight(n, (std::uint8_t)(value - 1));
+                    queue.push_back(n);
+                }
+            });
+        }
+    }
+
+    // Lights the tiles [x0, x1) x [y0, y1) from scratch. Light reaches at most
+    // MAX_LIGHT - 1 tiles from its source, so the rectangle only needs the
+    // sources within MAX_LIGHT tiles of it: the flood fill runs on a private
+    // copy of the rectangle plus that margin, and only the rectangle itself is
+    // written back (bumping the revisions of the chunks whose light changed).
+    // Returns the number of tiles whose light changed.
+    // rebuild() lights bands of whole chunk rows this way, which never write
+    // the same tiles or chunk revisions, so they can run at the same time.
+    template <typename LevelT>
+    std::size_t lightRect(const LevelT& level, int x0, int y0, int x1, int y1, RectWork& work) {
+        const int left = std::max(0, x0 - MAX_LIGHT);
+        const int right = std::min((int)size.x, x1 + MAX_LIGHT);
+        const int top = std::max(0, y0 - MAX_LIGHT);
+        const int bottom = std::min((int)size.y, y1 + MAX_LIGHT);
+        const int width = right - left;
+        const std::size_t count = (std::size_t)width * (bottom - top);
+        work.local.assign(count, 0);
+        work.blocks.assign(count, 0);
+        work.queue.clear();
+        std::uint8_t* local = work.local.data();
+        std::uint8_t* blocks = work.blocks.data();
+        std::vector<std::uint32_t>& queue = work.queue;
+
+        // Seed the sources. Daylight tiles surrounded by daylight on all sides
+        // have nothing to add, so only the edges of the daylit area are queued.
+        for (int y = top; y < bottom; ++y) {
+            std::uint8_t* localRow = &local[(std::size_t)(y - top) * width];
+            std::uint8_t* blockRow = &blocks[(std::size_t)(y - top) * width];
+            forEachTileRun(level, y, left, right, [&](int begin, int end, TileType type) {
+                const std::uint8_t glow = TILE_LIGHTS[type];
+                const bool blocking = blocksLight(type);
+                for (int x = begin; x < end; ++x) {
+                    blockRow[x - left] = blocking;
+                    const std::uint32_t i = (std::uint32_t)((y - top) * width + (x - left));
+                    if (y < skyDepth[x]) {
+                        localRow[x - left] = MAX_LIGHT;
+                        const bool edge = y + 1 >= skyDepth[x] || (x > 0 && skyDepth[x - 1] <= y) ||
+                                          (x + 1 < (int)size.x && skyDepth[x + 1] <= y);
+                        if (edge) queue.push_back(i);
+                    } else if (glow > 0) {
+                        localRow[x - left] = glow;
+                        queue.push_back(i);
+                    }
+                }
+            });
+        }
+
+        // Flood fill within the rectangle and its margin.
+        const std::uint32_t stride = (std::uint32_t)width;
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const std::uint32_t i = queue[head];
+            const std::uint8_t value = local[i];
+            if (value <= 1 || blocks[i]) continue;
+            const std::uint8_t dimmer = (std::uint8_t)(value - 1);
+            const std::uint32_t x = i % stride;
+            auto visit = [&](std::uint32_t n) {
+                if (local[n] < dimmer) {
+                    local[n] = dimmer;
+                    queue.push_back(n);
+                }
+            };
+            if (x > 0) visit(i - 1);
+            if (x + 1 < stride) visit(i + 1);
+            if (i >= stride) visit(i - stride);
+            if (i + stride < count) visit(i + stride);
+        }
+
+        std::size_t changedTiles = 0;
+        for (int y = y0; y < y1; ++y) {
+            const std::uint8_t* from = &local[(std::size_t)(y - top) * width + (x0 - left)];
+            std::uint8_t* to = &light[index(x0, y)];
+            for (int x = 0; x < x1 - x0; ++x) {
+                if (to[x] == from[x]) continue;
+                to[x] = from[x];
+                ++changedTiles;
+                ++chunkRevisions[(std::size_t)(y / CHUNK_SIZE) * chunkCount.x + (x0 + x) / CHUNK_SIZE];
+            }
+        }
+        return changedTiles;
+    }
+};
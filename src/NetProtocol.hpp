@@ -0,0 +1,331 @@
+#pragma once
+
+// --- Includes ---
+// The player whose state is sent over the network.
+#include "Player.hpp"
+// This header provides std::array, used for the snapshot history ring.
+#include <array>
+// This header provides std::lower_bound, used to find entities by id.
+#include <algorithm>
+// This header provides std::lround, used to quantize positions and velocities.
+#include <cmath>
+// This header provides fixed-width integer types used on the wire.
+#include <cstdint>
+// This header provides std::vector.
+#include <vector>
+
+// --- Network Constants ---
+// The server and its clients talk over UDP on this machine (localhost).
+
+// UDP port the server listens on.
+const unsigned short SERVER_PORT = 53000;
+// Simulation ticks (and snapshots) per second on the server.
+const int SERVER_TICK_RATE = 60;
+// Number of past snapshots kept on both sides for delta compression. A client
+// whose last acknowledged snapshot is older than this gets a full snapshot.
+const std::size_t SNAPSHOT_HISTORY = 64;
+// Clients that have not sent anything for this many ticks are dropped.
+const std::uint32_t CLIENT_TIMEOUT_TICKS = 5 * SERVER_TICK_RATE;
+// Positions travel as fixed-point integers in 1/8 pixel steps, velocities in
+// 1/16 pixel-per-frame steps. That is far finer than anything visible and
+// makes small, frame-to-frame changes encode into one or two bytes.
+const float POSITION_QUANTUM = 8.f;
+const float VELOCITY_QUANTUM = 16.f;
+
+// The first byte of every datagram says what kind of message it is.
+enum class PacketType : std::uint8_t {
+    Connect = 1,    // Client -> server: "let me join".
+    Welcome = 2,    // Server -> client: "you control entity <id>".
+    Input = 3,      // Client -> server: buttons held + last snapshot received.
+    Snapshot = 4,   // Server -> client: world state, delta compressed.
+    Disconnect = 5  // Client -> server: "I am leaving".
+};
+
+// Bits of the `buttons` byte in an Input packet.
+enum InputButton : std::uint8_t {
+    ButtonLeft = 1 << 0,
+    ButtonRight = 1 << 1,
+    ButtonJump = 1 << 2
+};
+
+// --- Byte Streams ---
+
+// Writes values into a caller-provided buffer (e.g. a datagram on the stack).
+// Integers use a variable-length encoding: 7 bits per byte, with the high bit
+// meaning "more bytes follow". Small numbers, which is what deltas usually
+// are, take a single byte.
+class ByteWriter {
+public:
+    ByteWriter(std::uint8_t* buffer, std::size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+    void writeU8(std::uint8_t value) {
+        if (length < capacity) buffer[length] = value;
+        else overflowed = true;
+        ++length;
+    }
+
+    // Unsigned variable-length integer (1-5 bytes).
+    void writeVarint(std::uint32_t value) {
+        while (value >= 0x80) {
+            writeU8((std::uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        writeU8((std::uint8_t)value);
+    }
+
+    // Signed variable-length integer. "Zigzag" maps 0, -1, 1, -2, ... to
+    // 0, 1, 2, 3, ... so small negative numbers stay small too.
+    void writeSigned(std::int32_t value) {
+        writeVarint(((std::uint32_t)value << 1) ^ (std::uint32_t)(value >> 31));
+    }
+
+    // Number of bytes written (only valid if !overflow()).
+    std::size_t size() const { return length; }
+    // True if more was written than fits in the buffer.
+    bool overflow() const { return overflowed; }
+
+private:
+    std::uint8_t* buffer;
+    std::size_t capacity;
+    std::size_t length = 0;
+    bool overflowed = false;
+};
+
+// Reads values written by ByteWriter. Reading past the end returns zeros and
+// sets the error flag instead of crashing, so malformed datagrams are harmless.
+class ByteReader {
+public:
+    ByteReader(const std::uint8_t* data, std::size_t length) : data(data), length(length) {}
+
+    std::uint8_t readU8() {
+        if (position >= length) {
+            failed = true;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    std::uint32_t readVarint() {
+        std::uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            const std::uint8_t byte = readU8();
+            value |= (std::uint32_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        failed = true; // More than 5 bytes: not a valid 32-bit varint.
+        return 0;
+    }
+
+    std::int32_t readSigned() {
+        const std::uint32_t raw = readVarint();
+        return (std::int32_t)(raw >> 1) ^ -(std::int32_t)(raw & 1);
+    }
+
+    // True if every read so far was within the data.
+    bool ok() const { return !failed; }
+
+private:
+    const std::uint8_t* data;
+    std::size_t length;
+    std::size_t position = 0;
+    bool failed = false;
+};
+
+// --- Snapshots ---
+
+// Bits of NetEntity::flags.
+enum EntityFlag : std::uint8_t {
+    FlagOnGround = 1 << 0
+};
+
+// The quantized, network form of one player.
+struct NetEntity {
+    std::uint16_t id = 0; // Unique id, assigned by the server (never 0).
+    std::int32_t x = 0;   // Position in 1/POSITION_QUANTUM pixels.
+    std::int32_t y = 0;
+    std::int32_t vx = 0;  // Velocity in 1/VELOCITY_QUANTUM pixels per frame.
+    std::int32_t vy = 0;
+    std::uint8_t flags = 0;
+
+    bool operator==(const NetEntity& other) const {
+        return id == other.id && x == other.x && y == other.y && vx == other.vx &&
+               vy == other.vy && flags == other.flags;
+    }
+    bool operator!=(const NetEntity& other) const { return !(*this == other); }
+
+    // Quantizes a simulated player.
+    static NetEntity fromPlayer(std::uint16_t id, const Player& player) {
+        NetEntity entity;
+        entity.id = id;
+        entity.x = (std::int32_t)std::lround(toFloat(player.position.x) * POSITION_QUANTUM);
+        entity.y = (std::int32_t)std::lround(toFloat(player.position.y) * POSITION_QUANTUM);
+        entity.vx = (std::int32_t)std::lround(toFloat(player.velocity.x) * VELOCITY_QUANTUM);
+        entity.vy = (std::int32_t)std::lround(toFloat(player.velocity.y) * VELOCITY_QUANTUM);
+        entity.flags = player.isOnGround ? FlagOnGround : 0;
+        return entity;
+    }
+
+    // Back to pixel units, e.g. for drawing.
+    sf::Vector2f position() const { return {x / POSITION_QUANTUM, y / POSITION_QUANTUM}; }
+};
+
+// The state of the whole world at one server tick. Entities are kept sorted
+// by id so two snapshots can be compared in a single merge-like pass.
+struct Snapshot {
+    std::uint32_t tick = 0; // Server tick (0 means "no snapshot").
+    std::vector<NetEntity> entities;
+};
+
+// The last SNAPSHOT_HISTORY snapshots, indexed by tick. The server keeps one of
+// these for the world; every client keeps one of the snapshots it received.
+// The slots are reused, so after warming up storing a snapshot only copies
+// entities into already allocated vectors.
+struct SnapshotHistory {
+    std::array<Snapshot, SNAPSHOT_HISTORY> slots;
+
+    void store(const Snapshot& snapshot) {
+        Snapshot& slot = slots[snapshot.tick % SNAPSHOT_HISTORY];
+        slot.tick = snapshot.tick;
+        slot.entities.assign(snapshot.entities.begin(), snapshot.entities.end());
+    }
+
+    // Returns the snapshot for `tick`, or nullptr if it is unknown or has
+    // already been overwritten by a newer one.
+    const Snapshot* find(std::uint32_t tick) const {
+        if (tick == 0) return nullptr;
+        const Snapshot& slot = slots[tick % SNAPSHOT_HISTORY];
+        return slot.tick == tick ? &slot : nullptr;
+    }
+};
+
+// --- Delta Compression ---
+// A snapshot is encoded relative to a "baseline": an older snapshot that the
+// client has confirmed it received. Only entities that changed since the
+// baseline are written, and only their changed fields, as (small) differences.
+// Entities that stand still cost nothing at all. Without a baseline the same
+// format is used against an empty world, which makes it a full snapshot.
+//
+// Layout after the PacketType byte:
+//   tick, baselineTick                      (varints, baselineTick 0 = none)
+//   per changed entity:
+//     id - previous written id              (varint, always >= 1)
+//     field mask                            (byte, ENTITY_FIELD_* bits)
+//     each changed field: new - old         (zigzag varint; flags as a byte)
+//   0                                       (end of changed entities)
+//   removed count, then id deltas           (varints)
+
+// Bits of the per-entity field mask.
+const std::uint8_t ENTITY_FIELD_X = 1 << 0;
+const std::uint8_t ENTITY_FIELD_Y = 1 << 1;
+const std::uint8_t ENTITY_FIELD_VX = 1 << 2;
+const std::uint8_t ENTITY_FIELD_VY = 1 << 3;
+const std::uint8_t ENTITY_FIELD_FLAGS = 1 << 4;
+const std::uint8_t ENTITY_FIELD_NEW = 1 << 5; // Not in the baseline.
+
+// Writes a Snapshot packet for `current`, delta compressed against `baseline`
+// (which may be nullptr for a full snapshot).
+inline void encodeSnapshot(const Snapshot& current, const Snapshot* baseline, ByteWriter& out) {
+    static const std::vector<NetEntity> emptyWorld;
+    const std::vector<NetEntity>& old = baseline ? baseline->entities : emptyWorld;
+
+    out.writeU8((std::uint8_t)PacketType::Snapshot);
+    out.writeVarint(current.tick);
+    out.writeVarint(baseline ? baseline->tick : 0);
+
+    // Changed and new entities: walk both sorted lists together.
+    std::size_t o = 0;
+    std::uint16_t previousId = 0;
+    for (const NetEntity& entity : current.entities) {
+        while (o < old.size() && old[o].id < entity.id) ++o;
+        const bool existed = (o < old.size() && old[o].id == entity.id);
+        const NetEntity base = existed ? old[o] : NetEntity{};
+        if (existed && base == entity) {
+            continue; // Unchanged: the client already has it.
+        }
+        std::uint8_t mask = existed ? 0 : ENTITY_FIELD_NEW;
+        if (entity.x != base.x) mask |= ENTITY_FIELD_X;
+        if (entity.y != base.y) mask |= ENTITY_FIELD_Y;
+        if (entity.vx != base.vx) mask |= ENTITY_FIELD_VX;
+        if (entity.vy != base.vy) mask |= ENTITY_FIELD_VY;
+        if (entity.flags != base.flags) mask |= ENTITY_FIELD_FLAGS;
+
+        out.writeVarint((std::uint32_t)(entity.id - previousId));
+        out.writeU8(mask);
+        if (mask & ENTITY_FIELD_X) out.writeSigned(entity.x - base.x);
+        if (mask & ENTITY_FIELD_Y) out.writeSigned(entity.y - base.y);
+        if (mask & ENTITY_FIELD_VX) out.writeSigned(entity.vx - base.vx);
+        if (mask & ENTITY_FIELD_VY) out.writeSigned(entity.vy - base.vy);
+        if (mask & ENTITY_FIELD_FLAGS) out.writeU8(entity.flags);
+        previousId = entity.id;
+    }
+    out.writeVarint(0); // End of changed entities.
+
+    // Removed entities: in the baseline but not in the current snapshot.
+    // First count them, then write their ids.
+    auto forEachRemoved = [&](auto&& visit) {
+        std::size_t c = 0;
+        for (const NetEntity& entity : old) {
+            while (c < current.entities.size() && current.entities[c].id < entity.id) ++c;
+            if (c >= current.entities.size() || current.entities[c].id != entity.id) visit(entity.id);
+        }
+    };
+    std::uint32_t removedCount = 0;
+    forEachRemoved([&](std::uint16_t) { ++removedCount; });
+    out.writeVarint(removedCount);
+    previousId = 0;
+    forEachRemoved([&](std::uint16_t id) {
+        out.writeVarint((std::uint32_t)(id - previousId));
+        previousId = id;
+    });
+}
+
+// Reads a Snapshot packet (after its PacketType byte) into `result`, using
+// `history` to find the baseline it was encoded against. Returns false if the
+// packet is malformed or its baseline is no longer known.
+inline bool decodeSnapshot(ByteReader& in, const SnapshotHistory& history, Snapshot& result) {
+    const std::uint32_t tick = in.readVarint();
+    const std::uint32_t baselineTick = in.readVarint();
+    result.tick = tick;
+    result.entities.clear();
+    if (baselineTick != 0) {
+        const Snapshot* baseline = history.find(baselineTick);
+        if (baseline == nullptr) return false;
+        result.entities = baseline->entities;
+    }
+
+    // Apply the changed entities.
+    std::uint16_t id = 0;
+    while (true) {
+        const std::uint32_t idDelta = in.readVarint();
+        if (idDelta == 0 || !in.ok()) break;
+        id = (std::uint16_t)(id + idDelta);
+        const std::uint8_t mask = in.readU8();
+
+        auto found = std::lower_bound(result.entities.begin(), result.entities.end(), id,
+                                      [](const NetEntity& e, std::uint16_t value) { return e.id < value; });
+        if (mask & ENTITY_FIELD_NEW) {
+            NetEntity entity;
+            entity.id = id;
+            found = result.entities.insert(found, entity);
+        } else if (found == result.entities.end() || found->id != id) {
+            return false; // Changes an entity the baseline doesn't have.
+        }
+        NetEntity& entity = *found;
+        if (mask & ENTITY_FIELD_X) entity.x += in.readSigned();
+        if (mask & ENTITY_FIELD_Y) entity.y += in.readSigned();
+        if (mask & ENTITY_FIELD_VX) entity.vx += in.readSigned();
+        if (mask & ENTITY_FIELD_VY) entity.vy += in.readSigned();
+        if (mask & ENTITY_FIELD_FLAGS) entity.flags = in.readU8();
+    }
+
+    // Remove the entities that left.
+    const std::uint32_t removedCount = in.readVarint();
+    id = 0;
+    for (std::uint32_t i = 0; i < removedCount && in.ok(); ++i) {
+        id = (std::uint16_t)(id + in.readVarint());
+        auto found = std::lower_bound(result.entities.begin(), result.entities.end(), id,
+                                      [](const NetEntity& e, std::uint16_t value) { return e.id < value; });
+        if (found != result.entities.end() && found->id == id) result.entities.erase(found);
+    }
+    return in.ok();
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+// --- Includes ---
+// sf::Texture, sf::Image and sf::Vertex for the layers and their quads.
+#include <SFML/Graphics.hpp>
+// Asset handles: a layer's texture may still be loading.
+#include "AssetManager.hpp"
+// Tile colors, for strips made of tiles.
+#include "TileTraits.hpp"
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides std::sin, std::floor and std::sqrt for the generated images.
+#include <cmath>
+// This header provides std::uint32_t for the generators' seeds.
+#include <cstdint>
+// This header provides std::vector.
+#include <vector>
+
+// --- Parallax Background ---
+
+// Background layers behind the level that scroll slower than the camera, so
+// they look further away: distant mountains, hills, clouds, a wall of tiles.
+//
+// Every layer is one repeating texture, drawn as a single quad that covers
+// just the part of the view the layer is visible in. The texture coordinates
+// run past the texture's edge and the texture repeats, so a layer costs one
+// draw call of two triangles however wide the level is and however far the
+// camera is zoomed out. A layer whose band is entirely above or below the view
+// isn't drawn at all, nor is one whose texture is still loading.
+//
+// A layer's `factor` is how fast it moves with the camera: 1 moves with the
+// level, 0 stays fixed on the screen, 0.2 scrolls at a fifth of the speed.
+// Layers are placed relative to the background's anchor, a camera centre:
+// with the camera there, a layer's band starts `top` world pixels below it
+// (above it if negative). From there a layer with factor f shifts by (1 - f)
+// times the distance the camera moved.
+class ParallaxBackground {
+public:
+    // How one layer is placed and drawn.
+    struct LayerSettings {
+        sf::Vector2f factor{0.5f, 0.5f}; // Scroll rate relative to the camera.
+        float top = 0.f;                 // The band's top edge, relative to the anchor.
+        float height = 0.f;              // Band height in world pixels; 0 repeats vertically too.
+        float scale = 1.f;               // World pixels per texel.
+        sf::Color tint = sf::Color::White;
+    };
+
+    // The camera centre at which every layer is where its settings put it
+    // (e.g. where the level starts; move it when the level is resized).
+    void setAnchor(sf::Vector2f cameraCenter) { anchor = cameraCenter; }
+
+    // Adds a layer in front of the ones added before. It appears once
+    // `texture` is ready; the texture must be repeated (see TextureSettings).
+    void addLayer(Asset<sf::Texture> texture, const LayerSettings& settings) {
+        layers.push_back({settings, std::move(texture)});
+    }
+
+    // Draws the layers visible in `view`, back to front (call it with `view`
+    // set on the target, before the level).
+    void draw(sf::RenderTarget& target, const sf::View& view) {
+        const sf::Vector2f viewTopLeft = view.getCenter() - view.getSize() / 2.f;
+        const sf::Vector2f viewBottomRight = view.getCenter() + view.getSize() / 2.f;
+        const sf::Vector2f cameraMoved = view.getCenter() - anchor;
+        drawnLayers = 0;
+        for (const Layer& layer : layers) {
+            const sf::Texture* texture = layer.texture.get();
+            if (texture == nullptr) continue; // Not loaded (yet).
+            const LayerSettings& settings = layer.settings;
+            // Where the layer's band is now, and the part of it in view.
+            const sf::Vector2f shift = {cameraMoved.x * (1.f - settings.factor.x),
+                                        anchor.y + cameraMoved.y * (1.f - settings.factor.y)};
+            float y0 = viewTopLeft.y, y1 = viewBottomRight.y;
+            if (settings.height > 0.f) {
+                y0 = std::max(y0, settings.top + shift.y);
+                y1 = std::min(y1, settings.top + settings.height + shift.y);
+                if (y0 >= y1) continue; // Above or below the view.
+            }
+            const float x0 = viewTopLeft.x, x1 = viewBottomRight.x;
+            // Texture coordinates of the corners: texels from the layer's
+            // origin, which the repeating texture wraps.
+            const float texels = 1.f / settings.scale;
+            const float u0 = (x0 - shift.x) * texels, u1 = (x1 - shift.x) * texels;
+            const float v0 = (y0 - settings.top - shift.y) * texels, v1 = (y1 - settings.top - shift.y) * texels;
+            sf::Vertex quad[6];
+            quad[0] = {{x0, y0}, settings.tint, {u0, v0}};
+            quad[1] = {{x1, y0}, settings.tint, {u1, v0}};
+            quad[2] = {{x0, y1}, settings.tint, {u0, v1}};
+            quad[3] = quad[2];
+            quad[4] = quad[1];
+            quad[5] = {{x1, y1}, settings.tint, {u1, v1}};
+            target.draw(quad, 6, sf::PrimitiveType::Triangles, sf::RenderStates(texture));
+            ++drawnLayers;
+        }
+    }
+
+    // Layers in total, and how many the last draw() drew (for statistics).
+    std::size_t layerCount() const { return layers.size(); }
+    std::size_t lastDrawnLayers() const { return drawnLayers; }
+
+private:
+    struct Layer {
+        LayerSettings settings;
+        Asset<sf::Texture> texture;
+    };
+
+    std::vector<Layer> layers;
+    sf::Vector2f anchor;
+    std::size_t drawnLayers = 0;
+};
+
+// --- Generated Layer Images ---
+// The game ships no image files, so its layers are generated at startup (on
+// worker threads, see AssetManager::generatedTexture).
+// Every image wraps around horizontally without a seam, since everything in
+// it is built from whole periods across the image's width.
+
+// A silhouette (mountains, hills): `color` below a ridge line made of a few
+// sine waves, transparent above. `roughness` (0-1) weights the shorter waves.
+inline sf::Image makeRidgeImage(sf::Vector2u size, sf::Color color, float ridgeHeight, float roughness, std::uint32_t seed) {
+    sf::Image image(size, sf::Color::Transparent);
+    const float tau = 6.2831853f;
+    // A few harmonics with pseudo-random phases (from the seed).
+    float phases[5];
+    for (float& phase : phases) {
+        seed = seed * 1664525u + 1013904223u;
+        phase = (float)(seed >> 8) / (float)(1u << 24) * tau;
+    }
+    for (unsigned int x = 0; x < size.x; ++x) {
+        const float t = (float)x / (float)size.x;
+        float ridge = 0.f, weight = 1.f, total = 0.f;
+        for (int k = 0; k < 5; ++k) {
+            ridge += weight * std::sin(tau * (float)(1 << k) * t + phases[k]);
+            total += weight;
+            weight *= roughness;
+        }
+        // Ridge from 0 (top of the image) to ridgeHeight of the image below it.
+        const float top = (float)size.y * (1.f - ridgeHeight * (0.5f + 0.5f * ridge / total));
+        for (unsigned int y = (unsigned int)std::max(0.f, std::floor(top)); y < size.y; ++y) {
+            sf::Color pixel = color;
+            // Soften the one pixel the ridge line crosses.
+            const float coverage = std::min(1.f, (float)y + 1.f - top);
+            pixel.a = (std::uint8_t)(color.a * coverage);
+            image.setPixel({x, y}, pixel);
+        }
+    }
+    return image;
+}
+
+// Soft white clouds scattered across a transparent image.
+inline sf::Image makeCloudImage(sf::Vector2u size, int cloudCount, std::uint32_t seed) {
+    sf::Image image(size, sf::Color::Transparent);
+    std::vector<float> alpha((std::size_t)size.x * size.y, 0.f);
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1u << 24);
+    };
+    for (int cloud = 0; cloud < cloudCount; ++cloud) {
+        const float cx = next() * size.x, cy = (0.3f + 0.4f * next()) * size.y;
+        // Every cloud is a row of overlapping puffs.
+        const int puffs = 3 + (int)(next() * 4);
+        for (int puff = 0; puff < puffs; ++puff) {
+            const float px = cx + (puff - puffs / 2.f) * size.y * 0.12f;
+            const float py = cy + (next() - 0.5f) * size.y * 0.1f;
+            const float radius = size.y * (0.1f + 0.08f * next());
+            for (int y = (int)(py - radius); y <= (int)(py + radius); ++y) {
+                if (y < 0 || y >= (int)size.y) continue;
+                for (int x = (int)(px - radius); x <= (int)(px + radius); ++x) {
+                    const float dx = (float)x - px, dy = (float)y - py;
+                    const float falloff = 1.f - std::sqrt(dx * dx + dy * dy) / radius;
+                    if (falloff <= 0.f) continue;
+                    // Wrap around the image's width.
+                    const int wrapped = ((x % (int)size.x) + (int)size.x) % (int)size.x;
+                    float& a = alpha[(std::size_t)y * size.x + wrapped];
+                    a = std::max(a, std::min(1.f, falloff * 3.f));
+                }
+            }
+        }
+    }
+    for (unsigned int y = 0; y < size.y; ++y) {
+        for (unsigned int x = 0; x < size.x; ++x) {
+            image.setPixel({x, y}, sf::Color(255, 255, 255, (std::uint8_t)(alpha[(std::size_t)y * size.x + x] * 220.f)));
+        }
+    }
+    return image;
+}
+
+// A strip of `type` tiles (`tilePixels` texels each), `rows` high, with a
+// darker outline around every tile: a wall of tiles far behind the level.
+inline sf::Image makeTileStripImage(TileType type, unsigned int tilePixels, unsigned int columns, unsigned int rows) {
+    const sf::Color base = TILE_DEFINITIONS[type].color;
+    const sf::Color edge(base.r / 2, base.g / 2, base.b / 2, base.a);
+    sf::Image image({tilePixels * columns, tilePixels * rows}, base);
+    for (unsigned int y = 0; y < tilePixels * rows; ++y) {
+        for (unsigned int x = 0; x < tilePixels * columns; ++x) {
+            // Bricks: every other row is offset by half a tile.
+            const unsigned int shiftedX = (x + ((y / tilePixels) % 2) * tilePixels / 2) % tilePixels;
+            if (shiftedX == 0 || y % tilePixels == 0) image.setPixel({x, y}, edge);
+        }
+    }
+    return image;
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+// --- Includes ---
+// SFML's graphics module: sf::VertexArray, sf::Vertex and sf::Color are used to
+// turn every live particle into two triangles of one big vertex batch.
+#include <SFML/Graphics.hpp>
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides std::cos and std::sin for picking launch directions.
+#include <cmath>
+// This header provides fixed-width integer types (std::uint32_t).
+#include <cstdint>
+// This header provides std::unique_ptr, which owns the fixed-size particle pools.
+#include <memory>
+
+// --- Particle Bursts ---
+
+// Describes a one-off burst of particles, e.g. the dust puff when the player
+// lands or the sparkle when a coin is picked up. Gameplay code fills one of
+// these and hands it to ParticleSystem::emit.
+struct ParticleBurst {
+    sf::Vector2f position;          // Where the particles spawn (pixels).
+    int count = 16;                 // How many particles to spawn.
+    float minSpeed = 1.f;           // Launch speed range (pixels/frame).
+    float maxSpeed = 3.f;
+    float direction = -1.5707964f;  // Centre of the launch cone (radians, -pi/2 is straight up).
+    float spread = 3.1415927f;      // Total width of the launch cone (radians).
+    float gravity = 0.2f;           // Downward acceleration (pixels/frame^2).
+    float minLifetime = 20.f;       // Lifetime range (frames).
+    float maxLifetime = 40.f;
+    float size = 3.f;               // Half the width of each particle quad (pixels).
+    sf::Color color = sf::Color::White;
+};
+
+// --- Particle Pools ---
+
+// A fixed-size array whose elements start out uninitialized. Unlike
+// std::vector(n), creating one doesn't write to every element, so the
+// operating system only maps in its pages when particles first reach them: a
+// pool sized for 200000 particles costs next to nothing at startup, and only
+// ever as much memory as the most particles alive at once needed.
+template <typename T>
+class ParticlePool {
+public:
+    explicit ParticlePool(std::size_t size) : items(new T[size]) {}
+
+    T& operator[](std::size_t i) { return items[i]; }
+    const T& operator[](std::size_t i) const { return items[i]; }
+    T* data() { return items.get(); }
+    const T* data() const { return items.get(); }
+
+private:
+    std::unique_ptr<T[]> items;
+};
+
+// --- Particle System ---
+
+// Simulates and draws large numbers of short-lived particles.
+//
+// Storing one sf::CircleShape per particle would mean one draw call and one
+// scattered heap object per particle. Instead, the system uses "structure of
+// arrays" (SoA) pools: one plain array per attribute (all X positions
+// together, all Y positions together, ...). The update loop then reads and
+// writes consecutive floats with no branches, which the compiler turns into
+// SIMD instructions, and drawing writes every particle into a single
+// sf::VertexArray that is submitted with one draw call.
+//
+// The pools are allocated once with a fixed capacity; live particles are always
+// packed at the front (indices 0..count-1), so emitting and expiring particles
+// never allocates. Bursts that do not fit are truncated.
+class ParticleSystem {
+public:
+    // Allocates pools for up to `capacity` live particles.
+    explicit ParticleSystem(std::size_t capacity)
+        : posX(capacity), posY(capacity), velX(capacity), velY(capacity),
+          accelY(capacity), life(capacity), invLifetime(capacity), halfSize(capacity),
+          color(capacity), maxParticles(capacity) {}
+
+    // Number of particles currently alive.
+    std::size_t size() const { return count; }
+    // Maximum number of particles that can be alive at once.
+    std::size_t capacity() const { return maxParticles; }
+
+    // Spawns a burst of particles. Each particle gets a random speed, direction
+    // and lifetime from the ranges in `burst`.
+    void emit(const ParticleBurst& burst) {
+        const std::size_t room = maxParticles - count;
+        const std::size_t spawn = std::min(room, (std::size_t)std::max(burst.count, 0));
+        const std::uint32_t packedColor = packColor(burst.color);
+        for (std::size_t n = 0; n < spawn; ++n) {
+            const std::size_t i = count++;
+            const float angle = burst.direction + (random01() - 0.5f) * burst.spread;
+            const float speed = burst.minSpeed + random01() * (burst.maxSpeed - burst.minSpeed);
+            const float lifetime = burst.minLifetime + random01() * (burst.maxLifetime - burst.minLifetime);
+            posX[i] = burst.position.x;
+            posY[i] = burst.position.y;
+            velX[i] = std::cos(angle) * speed;
+            velY[i] = std::sin(angle) * speed;
+            accelY[i] = burst.gravity;
+            life[i] = lifetime;
+            invLifetime[i] = 1.f / std::max(lifetime, 1.f);
+            halfSize[i] = burst.size;
+            color[i] = packedColor;
+        }
+    }
+
+    // Advances every particle by one frame and removes expired ones.
+    void update() {
+        const std::size_t n = count;
+        // Raw pointers make it obvious to the compiler that the arrays don't
+        // overlap with anything else it has to reload, so this loop vectorizes.
+        float* px = posX.data();
+        float* py = posY.data();
+        float* vx = velX.data();
+        float* vy = velY.data();
+        const float* ay = accelY.data();
+        float* lf = life.data();
+
+        // --- Integrate (branch-free, SIMD friendly) ---
+        for (std::size_t i = 0; i < n; ++i) {
+            vy[i] += ay[i];
+            px[i] += vx[i];
+            py[i] += vy[i];
+            lf[i] -= 1.f;
+        }
+
+        // --- Remove expired particles ---
+        // Walk backwards and move the last live particle into each dead slot,
+        // keeping the live particles packed at the front of the arrays.
+        for (std::size_t i = n; i-- > 0;) {
+            if (lf[i] <= 0.f) {
+                moveParticle(count - 1, i);
+                --count;
+            }
+        }
+    }
+
+    // Writes every live particle as a quad (two triangles, six vertices) into
+    // `vertices`, which is resized to fit and can be drawn with one draw call.
+    // Particles fade out over their lifetime through the vertex alpha.
+    void buildVertices(sf::VertexArray& vertices) const {
+        vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+        vertices.resize(count * 6);
+        if (count == 0) {
+            return;
+        }
+        sf::Vertex* out = &vertices[0];
+        for (std::size_t i = 0; i < count; ++i, out += 6) {
+            const float left = posX[i] - halfSize[i];
+            const float right = posX[i] + halfSize[i];
+            const float top = posY[i] - halfSize[i];
+            const float bottom = posY[i] + halfSize[i];
+            sf::Color c = unpackColor(color[i]);
+            c.a = (std::uint8_t)(c.a * std::min(life[i] * invLifetime[i], 1.f));
+            out[0] = {{left, top}, c};
+            out[1] = {{right, top}, c};
+            out[2] = {{left, bottom}, c};
+            out[3] = {{left, bottom}, c};
+            out[4] = {{right, top}, c};
+            out[5] = {{right, bottom}, c};
+        }
+    }
+
+    // Removes all particles.
+    void clear() { count = 0; }
+
+    // State of the random generator, so saved games and replays can restore
+    // it and get the same effects again.
+    std::uint32_t randomState() const { return rngState; }
+    void setRandomState(std::uint32_t state) { rngState = state != 0 ? state : 0x9E3779B9u; }
+
+private:
+    // --- Particle Pools (Structure of Arrays) ---
+    ParticlePool<float> posX, posY;      // Position (pixels).
+    ParticlePool<float> velX, velY;      // Velocity (pixels/frame).
+    ParticlePool<float> accelY;          // Gravity (pixels/frame^2).
+    ParticlePool<float> life;            // Frames left to live.
+    ParticlePool<float> invLifetime;     // 1 / starting lifetime, for fading.
+    ParticlePool<float> halfSize;        // Half the quad width (pixels).
+    ParticlePool<std::uint32_t> color;   // Packed RGBA start color.
+
+    std::size_t count = 0;               // Live particles, packed at the front.
+    std::size_t maxParticles;            // Fixed pool size.
+    std::uint32_t rngState = 0x9E3779B9u; // State of the xorshift random generator.
+
+    // Copies particle `from` into slot `to`.
+    void moveParticle(std::size_t from, std::size_t to) {
+        posX[to] = posX[from];
+        posY[to] = posY[from];
+        velX[to] = velX[from];
+        velY[to] = velY[from];
+        accelY[to] = accelY[from];
+        life[to] = life[from];
+        invLifetime[to] = invLifetime[from];
+        halfSize[to] = halfSize[from];
+        color[to] = color[from];
+    }
+
+    // Small, fast xorshift generator returning a float in [0, 1). Particles only
+    // need "random looking" values, not statistical quality.
+    float random01() {
+        rngState ^= rngState << 13;
+        rngState ^= rngState >> 17;
+        rngState ^= rngState << 5;
+        return (float)(rngState >> 8) * (1.f / 16777216.f);
+    }
+
+    static std::uint32_t packColor(sf::Color c) {
+        return ((std::uint32_t)c.r << 24) | ((std::uint32_t)c.g << 16) | ((std::uint32_t)c.b << 8) | c.a;
+    }
+
+    static sf::Color unpackColor(std::uint32_t packed) {
+        return sf::Color((std::uint8_t)(packed >> 24), (std::uint8_t)(packed >> 16),
+                         (std::uint8_t)(packed >> 8), (std::uint8_t)packed);
+    }
+};
@@ -0,0 +1,600 @@
+#pragma once
+
+// --- Includes ---
+// SFML's graphics module: the player is drawn as an sf::RectangleShape, which
+// also stores the player's position and size.
+#include <SFML/Graphics.hpp>
+// This header provides std::clamp and std::min.
+#include <algorithm>
+// This header provides std::abs, used for slopes.
+#include <cmath>
+// The number type of the simulation (float or fixed-point, see FixedPoint.hpp).
+#include "FixedPoint.hpp"
+// The level the player moves through, plus the physics constants. The player
+// works with both level storages (Level and RleLevel).
+#include "Level.hpp"
+#include "RleLevel.hpp"
+// The events the player reports (landing, falling out, pickups).
+#include "GameEvents.hpp"
+
+// --- Player Input ---
+
+// The controls that drive one simulation tick of a player. The game fills this
+// from the keyboard; the server receives it from the network.
+struct PlayerInput {
+    bool left = false;  // Move left while held.
+    bool right = false; // Move right while held.
+    bool jump = false;  // Jump (pressed this tick).
+};
+
+// --- Empty Space ---
+
+// True if the tiles from (x0, y0) to (x1, y1) (inclusive) are known to be all
+// Air. A Level answers from its occupancy bits; other storages don't keep any,
+// so their tiles are always checked one by one.
+inline bool regionKnownEmpty(const Level& level, int x0, int y0, int x1, int y1) {
+    return level.regionEmpty(x0, y0, x1, y1);
+}
+template <typename LevelT>
+bool regionKnownEmpty(const LevelT&, int, int, int, int) {
+    return false;
+}
+
+// --- Player Representation ---
+
+// Structure to group together data and functions for the player character.
+// The simulation state and all collision math use the number type `Scalar`
+// (float, or Fixed for bit-exact results across builds); the game uses
+// `Player`, which picks PhysicsScalar.
+template <typename Scalar>
+struct BasicPlayer {
+    using Vector = PhysicsVector<Scalar>;
+
+    // Centre of the player (pixels). This is the simulated position; `shape`
+    // follows it for drawing.
+    Vector position;
+    // Half the player's width and height (pixels).
+    Vector halfSize;
+    // Player's current speed and direction (pixels per frame). {x, y} components.
+    Vector velocity;
+    // Flag to track if the player is currently standing on a solid surface.
+    // Used primarily to determine if the player can jump.
+    bool isOnGround = false;
+    // Downward speed the player had when they last landed on a tile (pixels/frame).
+    // Useful for effects that should be stronger after a long fall.
+    Scalar landingSpeed{};
+    // The player's bounding rectangle in drawing coordinates. The game draws
+    // an animated sprite there (see SpriteAnimation.hpp) rather than the
+    // rectangle itself. Its position is copied from `position` by
+    // syncShape() (step() does it at the end of a tick).
+    sf::RectangleShape shape;
+    // Where the player reports gameplay events (landing, falling out, pickups).
+    // nullptr when nobody listens, e.g. on the headless server.
+    GameEventQueue* events = nullptr;
+    // Whether the body may fall asleep when it rests (see "Sleeping" below).
+    // Turning it off simulates every tick, e.g. to compare the two.
+    bool canSleep = true;
+
+    // Constructor: Initializes a new Player object.
+    // Takes the starting position (in pixels) as an argument.
+    BasicPlayer(sf::Vector2f startPos) {
+        // Set the player's size, slightly smaller than a tile.
+        halfSize = {Scalar(TILE_SIZE * 0.4f), Scalar(TILE_SIZE * 0.475f)};
+        position = {Scalar(startPos.x), Scalar(startPos.y)};
+        shape.setSize({toFloat(halfSize.x) * 2.f, toFloat(halfSize.y) * 2.f});
+        // Set the player's color.
+        shape.setFillColor(sf::Color::Green);
+        // Set the shape's origin (the point around which transformations like
+        // setPosition and rotation occur) to its center. This simplifies positioning.
+        shape.setOrigin(shape.getSize() / 2.f);
+        // Place the player's origin at the specified starting position.
+        syncShape();
+    }
+
+    // Moves the drawn rectangle to the simulated position.
+    void syncShape() {
+        shape.setPosition({toFloat(position.x), toFloat(position.y)});
+    }
+
+    // The simulated position in pixels, for code outside the simulation.
+    sf::Vector2f getPosition() const { return {toFloat(position.x), toFloat(position.y)}; }
+
+    // The physics constants in the simulation's number type.
+    static inline const Scalar SIM_GRAVITY = Scalar(GRAVITY);
+    static inline const Scalar SIM_MOVE_SPEED = Scalar(PLAYER_MOVE_SPEED);
+    static inline const Scalar SIM_JUMP_VELOCITY = Scalar(PLAYER_JUMP_VELOCITY);
+    static inline const Scalar SIM_EPSILON = Scalar(COLLISION_EPSILON);
+
+    // The player's bounding box.
+    struct Bounds {
+        Scalar left, top, right, bottom;
+    };
+    Bounds bounds() const {
+        return {position.x - halfSize.x, position.y - halfSize.y, position.x + halfSize.x, position.y + halfSize.y};
+    }
+
+    // Range of tiles a bounding box overlaps, checking slightly inside its edges.
+    struct TileRange {
+        int left, top, right, bottom;
+    };
+    static TileRange tilesTouching(const Bounds& box) {
+        return {tileIndex(box.left + SIM_EPSILON, TILE_SIZE), tileIndex(box.top + SIM_EPSILON, TILE_SIZE),
+                tileIndex(box.right - SIM_EPSILON, TILE_SIZE), tileIndex(box.bottom - SIM_EPSILON, TILE_SIZE)};
+    }
+
+    // Simulates gravity by modifying the player's vertical velocity.
+    void applyGravity() {
+        // Increase the downward velocity component (y) by the GRAVITY constant.
+        velocity.y += SIM_GRAVITY;
+    }
+
+    // Makes the player jump if they are currently on the ground.
+    void jump() {
+        // Only allow jumping if the flag indicates the player is grounded.
+        if (isOnGround) {
+            // Set the vertical velocity to the predefined jump velocity (upwards).
+            velocity.y = SIM_JUMP_VELOCITY;
+            // Player is no longer on the ground after jumping.
+            isOnGround = false;
+        }
+    }
+
+    // Detects and resolves collisions between the player and solid level tiles.
+    // This is a core part of the platformer physics engine.
+    // Takes a constant reference to the level data to check against.
+    template <typename LevelT>
+    void handleCollision(const LevelT& level) {
+        // Remember whether we were standing last frame (slopes use it to keep
+        // the player on the ground when walking down them).
+        const bool wasOnGround = isOnGround;
+        // Assume the player is not on the ground at the start of the check.
+        // It will be set to true only if a downward collision is confirmed.
+        isOnGround = false;
+        // Get the player's current world-coordinate bounding box.
+        Bounds playerBounds = bounds();
+
+        // --- Empty Space Check ---
+        // In mid-air, far from any tile, every check below reads only Air. The
+        // box covers all the tiles they can read (this frame's movement plus
+        // the slope reach, with a tile to spare), and the level's occupancy
+        // bits usually rule it out with one or two tests.
+        {
+            using std::abs;
+            const Scalar reach = abs(velocity.x) + abs(velocity.y) + Scalar(TILE_SIZE);
+            if (regionKnownEmpty(level, tileIndexFloor(playerBounds.left - reach, TILE_SIZE),
+                                 tileIndexFloor(playerBounds.top - reach, TILE_SIZE),
+                                 tileIndexFloor(playerBounds.right + reach, TILE_SIZE),
+                                 tileIndexFloor(playerBounds.bottom + reach, TILE_SIZE))) {
+                return;
+            }
+        }
+
+        // --- Vertical Collision Check ---
+        // Check collisions along the Y-axis first. Resolving vertical collisions
+        // before horizontal ones often leads to more stable platformer physics.
+
+        // Create a copy of the bounds to predict where the player *will be* vertically.
+        Bounds verticalCheckBounds = playerBounds;
+        verticalCheckBounds.top += velocity.y; // Add current Y velocity.
+        verticalCheckBounds.bottom += velocity.y;
+
+        // Determine the range of tile grid coordinates the predicted bounds overlap.
+        // tileIndex converts pixel coordinates to integer tile indices, and
+        // COLLISION_EPSILON checks slightly inside the bounds.
+        const TileRange vertical = tilesTouching(verticalCheckBounds);
+        const int leftTileV = vertical.left;
+        const int rightTileV = vertical.right;
+        const int topTileV = vertical.top;
+        const int bottomTileV = vertical.bottom;
+
+        // Only the row the player moves into matters: the one below when
+        // falling, the one above when rising. Which of its tiles is hit doesn't
+        // change the outcome, so the row is walked run by run (a stretch of Air
+        // is one step on an RleLevel) and only asked whether anything stops the player.
+        if (velocity.y > Scalar()) {
+            // Landing on a tile. One-way platforms only count if the player was
+            // above them before this move.
+            const bool wasAbove = playerBounds.bottom <= Scalar(bottomTileV * TILE_SIZE) + SIM_EPSILON;
+            bool lands = false;
+            forEachTileRun(level, bottomTileV, leftTileV, rightTileV + 1, [&](int, int, TileType below) {
+                lands = lands || tileHas<TILE_SOLID>(below) || (tileHas<TILE_ONE_WAY>(below) && wasAbove);
+            });
+            if (lands) {
+                // Reposition the player so their bottom edge rests exactly on top of the solid tile.
+                position.y = Scalar(bottomTileV * TILE_SIZE) - halfSize.y;
+                // Remember how hard we hit the ground, then stop downward movement.
+                landingSpeed = velocity.y;
+                velocity.y = Scalar();
+                // Set the flag indicating the player is now grounded.
+                isOnGround = true;
+                // IMPORTANT: Update the main playerBounds variable to reflect the position change,
+                // as this corrected position is needed for the subsequent horizontal check.
+                playerBounds = bounds();
+            }
+        } else if (velocity.y < Scalar()) {
+            // Hitting a ceiling.
+            bool bumps = false;
+            forEachTileRun(level, topTileV, leftTileV, rightTileV + 1, [&](int, int, TileType above) {
+                bumps = bumps || tileHas<TILE_SOLID>(above);
+            });
+            if (bumps) {
+                // Reposition the player so their top edge is exactly below the solid tile.
+                position.y = Scalar((topTileV + 1) * TILE_SIZE) + halfSize.y;
+                // Stop upward movement.
+                velocity.y = Scalar();
+                // Update playerBounds after the position change.
+                playerBounds = bounds();
+            }
+        }
+
+        // --- Slope Check ---
+        // Ramps are not solid squares: the player stands on the surface given by
+        // their height profile. This runs before the horizontal check so that
+        // walking up a ramp lifts the player instead of bumping into the tile
+        // next to it.
+        if (velocity.y >= Scalar()) {
+            resolveSlopes(level, wasOnGround);
+            playerBounds = bounds();
+        }
+
+        // --- Horizontal Collision Check ---
+        // Check collisions along the X-axis *after* vertical collisions are resolved.
+        // Uses the potentially updated playerBounds from the vertical check.
+
+        // Predict the horizontal position.
+        Bounds horizontalCheckBounds = playerBounds;
+        horizontalCheckBounds.left += velocity.x;
+        horizontalCheckBounds.right += velocity.x;
+
+        // Determine the tile range for the predicted horizontal bounds.
+        const TileRange horizontal = tilesTouching(horizontalCheckBounds);
+        const int leftTileH = horizontal.left;
+        const int rightTileH = horizontal.right;
+        // Use the *current* vertical tile range (after vertical adjustments).
+        const TileRange current = tilesTouching(playerBounds);
+        const int topTileH = current.top;
+        const int bottomTileH = current.bottom;
+
+        // Loop through the rows the player might collide with horizontally.
+        // This reads one tile per row (a column of the level), so there are no
+        // runs to skip; on an RleLevel each read is a search in its row.
+        for (int y = topTileH; y <= bottomTileH; ++y) {
+             // Check for collision to the right (only if moving right).
+            if (velocity.x > Scalar() && tileHas<TILE_SOLID>(level.getTile(rightTileH, y))) {
+                // Collision detected!
+                // Reposition player so their right edge is against the left edge of the tile.
+                position.x = Scalar(rightTileH * TILE_SIZE) - halfSize.x;
+                // Stop rightward movement.
+                velocity.x = Scalar();
+                // Collision resolved, exit the loop.
+                break;
+            }
+            // Check for collision to the left (only if moving left).
+            if (velocity.x < Scalar() && tileHas<TILE_SOLID>(level.getTile(leftTileH, y))) {
+                 // Collision detected!
+                 // Reposition player so their left edge is against the right edge of the tile.
+                position.x = Scalar((leftTileH + 1) * TILE_SIZE) + halfSize.x;
+                // Stop leftward movement.
+                velocity.x = Scalar();
+                // Collision resolved, exit the loop.
+                break;
+            }
+        }
+
+        // Report touching down (from a jump, a fall or a platform) once.
+        if (!wasOnGround && isOnGround && events != nullptr) {
+            events->push(PlayerLandedEvent{{toFloat(position.x), toFloat(position.y + halfSize.y)}, toFloat(landingSpeed)});
+        }
+    } // End handleCollision
+
+    // Highest a slope will lift the player in one frame when stepping onto it.
+    static inline const Scalar SLOPE_STEP_HEIGHT = Scalar(TILE_SIZE) / 2;
+
+    // Returns the world y of the surface of `tile` (at tile coordinates tx, ty)
+    // under world x, read from the tile's height profile.
+    static Scalar profileSurfaceY(TileType tile, int tx, int ty, Scalar x) {
+        int column = static_cast<int>((x - Scalar(tx * TILE_SIZE)) * TILE_PROFILE_COLUMNS / TILE_SIZE);
+        column = std::clamp(column, 0, TILE_PROFILE_COLUMNS - 1);
+        const Scalar height = Scalar((int)TILE_HEIGHT_PROFILES[TILE_PROFILES[tile]][column]) * TILE_SIZE / TILE_PROFILE_COLUMNS;
+        return Scalar((ty + 1) * TILE_SIZE) - height;
+    }
+
+    // Stands the player on any slope under their feet. Two sensors at the
+    // bottom corners (at this frame's predicted x) each find the surface below
+    // them from the height profiles (solid squares count as flat surfaces), and
+    // the higher one carries the player. Nothing happens unless a sensor is over
+    // an actual slope, so levels made of squares behave exactly as before.
+    template <typename LevelT>
+    void resolveSlopes(const LevelT& level, bool wasOnGround) {
+        using std::abs;
+        const Scalar footY = position.y + halfSize.y + velocity.y;
+        // When walking down a slope, follow it instead of launching off it.
+        const Scalar snap = wasOnGround ? abs(velocity.x) + Scalar(1) : Scalar();
+        const Scalar sensors[2] = {position.x + velocity.x - halfSize.x + SIM_EPSILON,
+                                   position.x + velocity.x + halfSize.x - SIM_EPSILON};
+        const int firstRow = tileIndexFloor(footY - SLOPE_STEP_HEIGHT, TILE_SIZE);
+        const int lastRow = tileIndexFloor(footY + snap, TILE_SIZE);
+
+        bool onSlope = false;
+        Scalar surfaceY = footY + snap;
+        for (Scalar x : sensors) {
+            const int tx = tileIndexFloor(x, TILE_SIZE);
+            // The first surface from the top that is within reach.
+            for (int ty = firstRow; ty <= lastRow; ++ty) {
+                const TileType tile = level.getTile(tx, ty);
+                if (TILE_PROFILES[tile] == PROFILE_NONE) continue;
+                const Scalar y = profileSurfaceY(tile, tx, ty, x);
+                const bool slope = tileHas<TILE_SLOPE>(tile);
+                onSlope = onSlope || slope;
+                // Too high to step onto, unless the feet are already inside the slope.
+                if (y < footY - SLOPE_STEP_HEIGHT && !(slope && footY > Scalar(ty * TILE_SIZE))) continue;
+                if (y <= footY + snap) surfaceY = std::min(surfaceY, y);
+                break;
+            }
+        }
+        if (!onSlope || surfaceY >= footY + snap) return;
+        if (!wasOnGround && !isOnGround) landingSpeed = velocity.y;
+        position.y = surfaceY - halfSize.y;
+        velocity.y = Scalar();
+        isOnGround = true;
+    }
+
+    // Handles collisions with the outer boundaries of the entire level map.
+    template <typename LevelT>
+    void handleLevelBounds(const LevelT& level) {
+        // Get player's current center position and half-size for easier boundary checks.
+        const Vector playerPos = position;
+        const Scalar levelWidth = Scalar((int)level.size.x * TILE_SIZE);
+        const Scalar levelHeight = Scalar((int)level.size.y * TILE_SIZE);
+
+        // Check left level boundary (position 0)
+        if (playerPos.x - halfSize.x < Scalar()) {
+            // Player's left edge is past the boundary.
+            // Reposition player so their left edge is exactly at the boundary.
+            position.x = halfSize.x;
+            // Stop any further leftward movement.
+            velocity.x = Scalar();
+        }
+        // Check right level boundary (the level's width in pixels)
+        if (playerPos.x + halfSize.x > levelWidth) {
+            // Player's right edge is past the boundary.
+            // Reposition player so their right edge is exactly at the boundary.
+            position.x = levelWidth - halfSize.x;
+            // Stop any further rightward movement.
+            velocity.x = Scalar();
+        }
+         // Check top level boundary (position 0)
+        if (playerPos.y - halfSize.y < Scalar()) {
+            // Player's top edge is past the boundary.
+            // Reposition player so their top edge is exactly at the boundary.
+            position.y = halfSize.y;
+            // Stop any further upward movement.
+            velocity.y = Scalar();
+        }
+        // Check bottom level boundary (fall out of world)
+        if (playerPos.y + halfSize.y > levelHeight) {
+            // Player's bottom edge is past the boundary (they fell off).
+            // Report it (whoever is interested reacts) and start over.
+            if (events != nullptr) events->push(PlayerFellOutEvent{{toFloat(playerPos.x), toFloat(playerPos.y)}});
+            respawn(level);
+        }
+    }
+
+    // Puts the player back at the starting position, standing still.
+    template <typename LevelT>
+    void respawn(const LevelT& level) {
+        position = {Scalar(TILE_SIZE * 1.5f), Scalar(TILE_SIZE * ((int)level.size.y - 3))};
+        velocity = {}; // Reset velocity too.
+        isOnGround = false; // May not be on ground after reset.
+        wake();
+        syncShape();
+    }
+
+    // --- Sleeping ---
+    // A body standing still with no buttons held comes out of every tick
+    // exactly as it went in: gravity pulls it into the ground and collision
+    // puts it back. After SLEEP_AFTER_TICKS such ticks in a row it falls
+    // asleep, and step() skips the simulation as long as nothing it depends on
+    // changes: no buttons are held, its state is still the one it fell asleep
+    // in (nothing moved it, e.g. a rollback or a snapshot), and the tiles it
+    // can touch are unchanged.
+    //
+    // The last one is the cached ground contact: when falling asleep the body
+    // saves the few tiles within its reach and the sum of the revisions
+    // (Level::chunkRevisions) of their chunks. Revisions only ever go up, so
+    // the sum changes as soon as a tile is edited anywhere near; only then are
+    // the saved tiles compared, and only a change among them wakes the body.
+    // An undisturbed sleeping body costs a handful of loads per tick. Because
+    // a sleeping tick is skipped only when simulating it would change nothing,
+    // sleeping bodies behave bit for bit like awake ones.
+
+    // Still ticks in a row before a body falls asleep.
+    static constexpr int SLEEP_AFTER_TICKS = 30;
+
+    // True while step() skips the simulation.
+    bool isAsleep() const { return asleep; }
+
+    // Wakes the body; it simulates again for at least SLEEP_AFTER_TICKS
+    // ticks. Call it when something outside the tiles pushes the body (a
+    // contact with another entity, an explosion); tile edits, buttons and
+    // changes to its state wake it by themselves.
+    void wake() {
+        asleep = false;
+        stillTicks = 0;
+    }
+
+    // True if the player's bounding box overlaps any tile with one of the
+    // `Flags` (e.g. touchesTile<TILE_HAZARD>(level) for spikes).
+    template <std::uint8_t Flags, typename LevelT>
+    bool touchesTile(const LevelT& level) const {
+        const auto [left, top, right, bottom] = tilesTouching(bounds());
+        // Walk each row run by run: a stretch of Air is one step on an RleLevel.
+        bool touching = false;
+        for (int y = top; y <= bottom; ++y) {
+            forEachTileRun(level, y, left, right + 1, [&](int, int, TileType type) {
+                touching = touching || tileHas<Flags>(type);
+            });
+        }
+        return touching;
+    }
+
+
+    // Picks up any collectible tiles (coins, gems, ...) the player overlaps:
+    // each one is removed from the level and reported as an ItemCollectedEvent
+    // (score, effects, ... subscribe to those). Returns the number collected.
+    template <typename LevelT>
+    int collectItems(LevelT& level) {
+        // Range of tiles the player's bounding box overlaps.
+        const auto [left, top, right, bottom] = tilesTouching(bounds());
+        int collected = 0;
+        for (int y = top; y <= bottom; ++y) {
+            for (int x = left; x <= right; ++x) {
+                const TileType tile = level.getTile(x, y);
+                if (tileHas<TILE_COLLECTIBLE>(tile)) {
+                    level.setTile(x, y, Air); // The item disappears from the map.
+                    if (events != nullptr) events->push(ItemCollectedEvent{{x, y}, tile});
+                    ++collected;
+                }
+            }
+        }
+        return collected;
+    }
+
+    // Applies the current velocity to the player's position.
+    // Called after all physics and collision checks for the frame are done.
+    void updatePosition() {
+        position.x += velocity.x;
+        position.y += velocity.y;
+    }
+
+    // Runs one complete simulation tick for the given input: jumping, horizontal
+    // movement, gravity, collisions and finally movement. The game loop and the
+    // headless server both call this, so they simulate players identically.
+    template <typename LevelT>
+    void step(const PlayerInput& input, const LevelT& level) {
+        const bool idle = !input.left && !input.right && !input.jump;
+        if (asleep) {
+            if (idle && restingUnchanged(level)) return; // This tick would change nothing.
+            wake();
+        }
+        const RestState before = restState();
+
+        if (input.jump) {
+            jump(); // Only takes effect when standing on the ground.
+        }
+        velocity.x = Scalar(); // Player stops if no direction is held.
+        if (input.left) {
+            velocity.x = -SIM_MOVE_SPEED;
+        }
+        if (input.right) {
+            velocity.x = SIM_MOVE_SPEED;
+        }
+        applyGravity();           // Apply gravity to the player.
+        handleCollision(level);   // Resolve collisions with solid tiles.
+        handleLevelBounds(level); // Resolve collisions with level edges.
+        updatePosition();         // Apply final velocity to move the player.
+        syncShape();              // Move the drawn rectangle along.
+
+        // Count still ticks towards falling asleep.
+        if (canSleep && idle && restState() == before) {
+            if (++stillTicks >= SLEEP_AFTER_TICKS) fallAsleep(level);
+        } else {
+            stillTicks = 0;
+        }
+    }
+
+private:
+    // The part of the state a tick can change.
+    struct RestState {
+        Vector position;
+        Vector velocity;
+        Scalar landingSpeed;
+        bool isOnGround;
+        bool operator==(const RestState& other) const {
+            return position.x == other.position.x && position.y == other.position.y && velocity.x == other.velocity.x &&
+                   velocity.y == other.velocity.y && landingSpeed == other.landingSpeed && isOnGround == other.isOnGround;
+        }
+    };
+    RestState restState() const { return {position, velocity, landingSpeed, isOnGround}; }
+
+    // The tiles an idle tick can read (inclusive): the reach of
+    // handleCollision's empty-space check for a body that only falls by one
+    // tick of gravity. At most REST_TILES x REST_TILES for a player-sized body.
+    struct Reach {
+        int left, top, right, bottom;
+    };
+    static constexpr int REST_TILES = 4;
+
+    bool asleep = false;
+    int stillTicks = 0;               // Still ticks in a row so far.
+    RestState rest{};                 // The state the body fell asleep in.
+    sf::Vector2u restLevelSize;       // Size of the level it fell asleep on.
+    Reach restReach{};                // Tiles within its reach...
+    TileType restTiles[REST_TILES * REST_TILES]{}; // ...and what they were.
+    unsigned int restRevisions = 0;   // Sum of the revisions of their chunks.
+
+    Reach tilesInReach() const {
+        const Scalar reach = SIM_GRAVITY + Scalar(TILE_SIZE);
+        const Bounds box = bounds();
+        return {tileIndexFloor(box.left - reach, TILE_SIZE), tileIndexFloor(box.top - reach, TILE_SIZE),
+                tileIndexFloor(box.right + reach, TILE_SIZE), tileIndexFloor(box.bottom + reach, TILE_SIZE)};
+    }
+
+    template <typename LevelT>
+    static unsigned int revisionsInReach(const LevelT& level, const Reach& reach) {
+        const int cx0 = std::max(reach.left, 0) / CHUNK_SIZE;
+        const int cy0 = std::max(reach.top, 0) / CHUNK_SIZE;
+        const int cx1 = std::min(reach.right, (int)level.size.x - 1) / CHUNK_SIZE;
+        const int cy1 = std::min(reach.bottom, (int)level.size.y - 1) / CHUNK_SIZE;
+        unsigned int sum = 0;
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) sum += level.getChunkRevision(cx, cy);
+        }
+        return sum;
+    }
+
+    // True if the tiles in reach are still the ones saved in restTiles (when
+    // `save` is false), or saves them (when it is true).
+    template <typename LevelT>
+    bool compareRestTiles(const LevelT& level, bool save) {
+        TileType* saved = restTiles;
+        for (int y = restReach.top; y <= restReach.bottom; ++y) {
+            for (int x = restReach.left; x <= restReach.right; ++x, ++saved) {
+                const TileType tile = level.getTile(x, y);
+                if (save) *saved = tile;
+                else if (*saved != tile) return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename LevelT>
+    void fallAsleep(const LevelT& level) {
+        restReach = tilesInReach();
+        if (restReach.right - restReach.left >= REST_TILES || restReach.bottom - restReach.top >= REST_TILES) {
+            stillTicks = 0; // A body this big is not cached; it stays awake.
+            return;
+        }
+        asleep = true;
+        rest = restState();
+        restLevelSize = level.size;
+        restRevisions = revisionsInReach(level, restReach);
+        compareRestTiles(level, true);
+    }
+
+    // Checks the cached contact: the revisions first, and only when those
+    // moved (a tile somewhere in the surrounding chunks was edited) the tiles
+    // in reach themselves.
+    template <typename LevelT>
+    bool restingUnchanged(const LevelT& level) {
+        if (!(restState() == rest) || level.size != restLevelSize) return false;
+        const unsigned int revisions = revisionsInReach(level, restReach);
+        if (revisions == restRevisions) return true;
+        if (!compareRestTiles(level, false)) return false;
+        restRevisions = revisions; // An edit nearby, but not within reach.
+        return true;
+    }
+}; // End of BasicPlayer struct
+
+// The player as the game, server and tools simulate it.
+using Player = BasicPlayer<PhysicsScalar>;
@@ -0,0 +1,330 @@
+#pragma once
+
+// --- Includes ---
+// The level grid that rays are traced through.
+#include "Level.hpp"
+// This header provides std::clamp, std::min and std::max.
+#include <algorithm>
+// This header provides std::floor and std::abs for the grid stepping math.
+#include <cmath>
+// This header provides fixed-width integer types (std::uint16_t, std::uint32_t)
+// used for the sort keys of the batched raycast.
+#include <cstdint>
+// This header provides std::numeric_limits, used for "never crosses" distances.
+#include <limits>
+// This header provides std::vector for the batch buffers.
+#include <vector>
+
+// --- Raycast Results ---
+
+// A line segment in world (pixel) coordinates to be traced through the level.
+struct Ray {
+    sf::Vector2f from; // Start point of the segment.
+    sf::Vector2f to;   // End point of the segment.
+};
+
+// Describes the first blocking tile a ray ran into (if any).
+struct RaycastHit {
+    // True if the segment touched a blocking tile before reaching its end point.
+    bool hit = false;
+    // Grid coordinates of the tile that was hit ({-1, -1} when nothing was hit).
+    sf::Vector2i tile = {-1, -1};
+    // World position where the ray entered the hit tile. Equals the segment's
+    // end point when nothing was hit.
+    sf::Vector2f point;
+    // Outward-facing normal of the tile side that was hit, e.g. {0, -1} for the
+    // top of a floor tile. It is {0, 0} when the ray *started* inside a solid
+    // tile, since there is no side it came through.
+    sf::Vector2f normal;
+    // How far along the segment the hit happened: 0 is `from`, 1 is `to`.
+    float fraction = 1.f;
+    // The type of the tile that was hit.
+    TileType type = Air;
+};
+
+// --- Single Ray ---
+
+// Traces the segment from `from` to `to` through the tile grid and returns the
+// first tile it enters that has any of the `StopFlags` (by default: the first
+// solid tile; e.g. raycastLevel<TILE_SOLID | TILE_HAZARD> also stops at spikes).
+//
+// This is the "fast voxel traversal" algorithm by Amanatides and Woo (DDA):
+// instead of sampling points along the ray, we jump straight from one tile
+// boundary to the next, so every tile the segment passes through is visited
+// exactly once and no tile is skipped, no matter how thin the corner it clips.
+//
+// With `SkipEmpty` (the default) the walk also consults the level's occupancy
+// bits (see TileOccupancy in Level.hpp) each time it enters a new chunk: if the
+// chunk, or better its whole super-chunk, is known to be Air, the ray jumps
+// straight to the tile where it leaves that box. A ray across open sky then
+// costs a few steps per super-chunk instead of one per tile. raycastLevel with
+// SkipEmpty = false is the plain tile-by-tile walk, kept for comparison.
+template <std::uint8_t StopFlags = TILE_SOLID, bool SkipEmpty = true>
+RaycastHit raycastLevel(const Level& level, sf::Vector2f from, sf::Vector2f to) {
+    RaycastHit result;
+    result.point = to;
+
+    const int width = (int)level.size.x;
+    const int height = (int)level.size.y;
+    if (width == 0 || height == 0) {
+        return result;
+    }
+
+    // Work in tile units (1.0 == one tile) so the grid lines sit on whole numbers.
+    const float originX = from.x / TILE_SIZE;
+    const float originY = from.y / TILE_SIZE;
+    const float dirX = (to.x - from.x) / TILE_SIZE;
+    const float dirY = (to.y - from.y) / TILE_SIZE;
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // --- Clip the segment to the level rectangle ---
+    // Parts of the ray outside the map can never hit anything (getTile treats
+    // them as Air), so we only walk the piece in [tEnter, tExit].
+    // `enterX`/`enterY` remember when the ray crossed into the map on each axis,
+    // which tells us the hit normal if the very first tile is already solid.
+    float tEnter = 0.f;
+    float tExit = 1.f;
+    float enterX = -infinity;
+    float enterY = -infinity;
+    if (dirX != 0.f) {
+        float tNear = (0.f - originX) / dirX;
+        float tFar = ((float)width - originX) / dirX;
+        if (tNear > tFar) std::swap(tNear, tFar);
+        enterX = tNear;
+        tEnter = std::max(tEnter, tNear);
+        tExit = std::min(tExit, tFar);
+    } else if (originX < 0.f || originX >= (float)width) {
+        return result; // Vertical ray completely left/right of the map.
+    }
+    if (dirY != 0.f) {
+        float tNear = (0.f - originY) / dirY;
+        float tFar = ((float)height - originY) / dirY;
+        if (tNear > tFar) std::swap(tNear, tFar);
+        enterY = tNear;
+        tEnter = std::max(tEnter, tNear);
+        tExit = std::min(tExit, tFar);
+    } else if (originY < 0.f || originY >= (float)height) {
+        return result; // Horizontal ray completely above/below the map.
+    }
+    if (tEnter > tExit) {
+        return result; // The segment misses the map entirely.
+    }
+
+    // --- Set up the DDA ---
+    // Tile containing the (clipped) start point. Clamping protects against the
+    // start point landing exactly on the far edge of the map.
+    int x = std::clamp((int)std::floor(originX + dirX * tEnter), 0, width - 1);
+    int y = std::clamp((int)std::floor(originY + dirY * tEnter), 0, height - 1);
+    // Which way we step through the grid on each axis (-1, 0 or +1).
+    const int stepX = (dirX > 0.f) ? 1 : (dirX < 0.f ? -1 : 0);
+    const int stepY = (dirY > 0.f) ? 1 : (dirY < 0.f ? -1 : 0);
+    // How much `t` advances when we move one whole tile along each axis.
+    const float tDeltaX = (stepX != 0) ? 1.f / std::abs(dirX) : infinity;
+    const float tDeltaY = (stepY != 0) ? 1.f / std::abs(dirY) : infinity;
+    // The value of `t` at which the ray crosses the next vertical / horizontal grid line.
+    float tMaxX = (stepX > 0) ? ((float)(x + 1) - originX) / dirX
+                : (stepX < 0) ? ((float)x - originX) / dirX
+                : infinity;
+    float tMaxY = (stepY > 0) ? ((float)(y + 1) - originY) / dirY
+                : (stepY < 0) ? ((float)y - originY) / dirY
+                : infinity;
+
+    // The axis of the last grid line crossed: 0 = X, 1 = Y, -1 = none yet
+    // (the ray started inside the map).
+    int lastAxis = -1;
+    if (tEnter > 0.f) {
+        lastAxis = (enterX >= enterY) ? 0 : 1;
+    }
+    float t = tEnter;
+
+    // The clipping above guarantees (x, y) stays inside the map, so we can
+    // read the flat tile array directly instead of going through getTile.
+    const TileType* grid = level.tiles.data();
+
+    // For the jumps over empty boxes (a multiplication is cheaper than a division).
+    const float inverseDirX = (stepX != 0) ? 1.f / dirX : 0.f;
+    const float inverseDirY = (stepY != 0) ? 1.f / dirY : 0.f;
+    static_assert((CHUNK_SIZE & (CHUNK_SIZE - 1)) == 0 && (TileOccupancy::SUPER_CHUNK_TILES & (TileOccupancy::SUPER_CHUNK_TILES - 1)) == 0,
+                  "box corners are found with masks");
+
+    // --- Walk the grid ---
+    // The tile-by-tile walk runs inside a box it may not leave without the
+    // outer loop looking again: the whole level, or with SkipEmpty the chunk
+    // it is in. Leaving the box is the same four comparisons as leaving the
+    // level, so tiles in occupied chunks cost what they always did.
+    while (true) {
+        int boxX0 = 0, boxY0 = 0, boxX1 = width, boxY1 = height;
+        if constexpr (SkipEmpty) {
+            const int chunkX = x / CHUNK_SIZE;
+            const int chunkY = y / CHUNK_SIZE;
+            if (level.occupancy.chunkEmpty(chunkX, chunkY)) {
+                // Leave the largest empty box around (x, y) in one jump: its
+                // super-chunk if that is empty too, else the chunk.
+                const int superTiles = TileOccupancy::SUPER_CHUNK_TILES;
+                const int boxSize = level.occupancy.superChunkEmpty(x / superTiles, y / superTiles) ? superTiles : CHUNK_SIZE;
+                boxX0 = x & ~(boxSize - 1); // Both box sizes are powers of two.
+                boxY0 = y & ~(boxSize - 1);
+                boxX1 = std::min(boxX0 + boxSize, width);
+                boxY1 = std::min(boxY0 + boxSize, height);
+                const float tBoxX = (stepX != 0) ? ((float)(stepX > 0 ? boxX1 : boxX0) - originX) * inverseDirX : infinity;
+                const float tBoxY = (stepY != 0) ? ((float)(stepY > 0 ? boxY1 : boxY0) - originY) * inverseDirY : infinity;
+                // The tile the ray is in at `t` along the axis it is not
+                // leaving the box on. On a grid line it counts as already
+                // across when moving backwards, as the tile-by-tile walk
+                // (which steps Y first on ties) would have it.
+                // Positions inside the level are not negative, so a cast
+                // rounds down.
+                auto tileAlong = [](float position, int step, int low, int high) {
+                    int index = (int)std::max(position, 0.f);
+                    if (step < 0 && (float)index == position) --index;
+                    return std::clamp(index, low, high);
+                };
+                if (tBoxX < tBoxY) {
+                    if (tBoxX > tExit) break; // The segment ends inside the empty box.
+                    t = tBoxX;
+                    x = (stepX > 0) ? boxX1 : boxX0 - 1;
+                    y = tileAlong(originY + dirY * t, stepY, boxY0, boxY1 - 1);
+                    lastAxis = 0;
+                } else {
+                    if (tBoxY > tExit) break;
+                    t = tBoxY;
+                    y = (stepY > 0) ? boxY1 : boxY0 - 1;
+                    x = tileAlong(originX + dirX * t, stepX, boxX0, boxX1 - 1);
+                    lastAxis = 1;
+                }
+                if (x < 0 || x >= width || y < 0 || y >= height) break;
+                tMaxX = (stepX != 0) ? ((float)(stepX > 0 ? x + 1 : x) - originX) * inverseDirX : infinity;
+                tMaxY = (stepY != 0) ? ((float)(stepY > 0 ? y + 1 : y) - originY) * inverseDirY : infinity;
+                continue;
+            }
+            boxX0 = chunkX * CHUNK_SIZE;
+            boxY0 = chunkY * CHUNK_SIZE;
+            boxX1 = std::min(boxX0 + CHUNK_SIZE, width);
+            boxY1 = std::min(boxY0 + CHUNK_SIZE, height);
+        }
+
+        bool segmentEnded = false;
+        while (true) {
+            const TileType tile = grid[(std::size_t)y * width + x];
+            if (tileHas<StopFlags>(tile)) {
+                result.hit = true;
+                result.tile = {x, y};
+                result.type = tile;
+                result.fraction = t;
+                result.point = {from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t};
+                if (lastAxis == 0) result.normal = {(float)-stepX, 0.f};
+                else if (lastAxis == 1) result.normal = {0.f, (float)-stepY};
+                return result;
+            }
+            // Step into whichever neighbouring tile the ray reaches first.
+            if (tMaxX < tMaxY) {
+                if (tMaxX > tExit) { segmentEnded = true; break; } // Segment ends before the next tile.
+                t = tMaxX;
+                x += stepX;
+                tMaxX += tDeltaX;
+                lastAxis = 0;
+            } else {
+                if (tMaxY > tExit) { segmentEnded = true; break; }
+                t = tMaxY;
+                y += stepY;
+                tMaxY += tDeltaY;
+                lastAxis = 1;
+            }
+            if (x < boxX0 || x >= boxX1 || y < boxY0 || y >= boxY1) break;
+        }
+        if (segmentEnded) break;
+        // Floating-point rounding can push us one tile past the clip range.
+        if (x < 0 || x >= width || y < 0 || y >= height) break;
+    }
+    return result;
+}
+
+// --- Batched Rays ---
+
+// Traces many rays in one call, e.g. line-of-sight checks for every enemy or
+// all projectiles fired this frame.
+//
+// Fill `rays`, call `run`, then read `hits[i]` for `rays[i]`. The buffers are
+// kept between calls so a batch that is reused every frame does not allocate
+// once it has grown to its working size.
+struct RaycastBatch {
+    std::vector<Ray> rays;        // Input: segments to trace.
+    std::vector<RaycastHit> hits; // Output: one result per ray, same order.
+
+    // Clears the input and output but keeps the allocated memory.
+    void clear() {
+        rays.clear();
+        hits.clear();
+    }
+
+    // Traces every ray in `rays` against the level.
+    void run(const Level& level) {
+        hits.resize(rays.size());
+
+        // Small batches are not worth reordering.
+        if (rays.size() < SORT_THRESHOLD) {
+            for (std::size_t i = 0; i < rays.size(); ++i) {
+                hits[i] = raycastLevel(level, rays[i].from, rays[i].to);
+            }
+            return;
+        }
+
+        // Rays are usually submitted in gameplay order (entity by entity), which
+        // jumps all over the map. Tracing them grouped by the 16x16 tile block
+        // their start point is in, with the blocks visited along a Z-order
+        // (Morton) curve, means that consecutive rays read the same rows of the
+        // grid and find them already in the CPU cache.
+        // The block coordinates are wrapped to 8 bits each, so the Morton code
+        // fits in 16 bits and a single counting-sort pass (linear time, no
+        // comparisons) produces the traversal order.
+        keys.resize(rays.size());
+        order.resize(rays.size());
+        bucketStart.assign(BUCKET_COUNT + 1, 0);
+        for (std::size_t i = 0; i < rays.size(); ++i) {
+            const sf::Vector2f start = rays[i].from;
+            keys[i] = interleaveBits(blockCoordinate(start.x), blockCoordinate(start.y));
+            ++bucketStart[keys[i] + 1];
+        }
+        for (std::size_t b = 1; b <= BUCKET_COUNT; ++b) {
+            bucketStart[b] += bucketStart[b - 1];
+        }
+        for (std::size_t i = 0; i < rays.size(); ++i) {
+            order[bucketStart[keys[i]]++] = (std::uint32_t)i;
+        }
+
+        for (std::uint32_t index : order) {
+            hits[index] = raycastLevel(level, rays[index].from, rays[index].to);
+        }
+    }
+
+private:
+    // Batches smaller than this are traced in submission order.
+    static constexpr std::size_t SORT_THRESHOLD = 64;
+    // Log2 of the block size (in tiles) used for the locality sort.
+    static constexpr int BLOCK_SHIFT = 4;
+    // Number of distinct 16-bit Morton codes.
+    static constexpr std::size_t BUCKET_COUNT = 1 << 16;
+
+    // Scratch buffers for the counting sort, kept to avoid per-call allocations.
+    std::vector<std::uint16_t> keys;        // Morton code of each ray's start block.
+    std::vector<std::uint32_t> order;       // Ray indices in traversal order.
+    std::vector<std::uint32_t> bucketStart; // Prefix sums of the key histogram.
+
+    // Converts a pixel coordinate into an 8-bit (wrapped) block coordinate.
+    static std::uint32_t blockCoordinate(float pixels) {
+        const int tile = (int)std::floor(pixels / TILE_SIZE);
+        return (std::uint32_t)(tile >> BLOCK_SHIFT) & 0xFFu;
+    }
+
+    // Interleaves the bits of two 8-bit numbers (x in the even bits, y in the
+    // odd bits), producing their position along a Z-order curve.
+    static std::uint16_t interleaveBits(std::uint32_t x, std::uint32_t y) {
+        auto spread = [](std::uint32_t v) {
+            v = (v | (v << 4)) & 0x0F0Fu;
+            v = (v | (v << 2)) & 0x3333u;
+            v = (v | (v << 1)) & 0x5555u;
+            return v;
+        };
+        return (std::uint16_t)(spread(x) | (spread(y) << 1));
+    }
+};
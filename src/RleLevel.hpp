@@ -0,0 +1,205 @@
+#pragma once
+
+// --- Includes ---
+// Tile types, the physics constants and the dense Level (for conversions).
+#include "Level.hpp"
+// This header provides std::min, std::max and std::fill.
+#include <algorithm>
+// This header provides fixed-width integer types.
+#include <cstdint>
+// This header provides std::vector.
+#include <vector>
+
+// --- Run-Length Encoded Level ---
+
+// One run of identical tiles in a row: it starts at column `start` and ends
+// where the next run of the row starts (or at the end of the row).
+struct TileRun {
+    std::uint32_t start;
+    TileType type;
+};
+
+// A level stored as run-length encoded rows. Most rows of our maps are long
+// stretches of Air with a few platforms, which take a handful of runs instead
+// of one byte per tile, and code that walks along a row (building the render
+// batches, area queries) can skip a whole empty stretch in one step.
+//
+// It offers the same interface as Level (size, getTile, setTile, chunk
+// revisions), so code templated on the level type works with either. Reading
+// one tile is a binary search over the runs of its row: O(log runs).
+struct RleLevel {
+    // The runs of every row, in column order. A row always has at least one
+    // run, starting at column 0.
+    std::vector<std::vector<TileRun>> rows;
+    sf::Vector2u size;
+    sf::Vector2f sizePixels;
+    // Chunk change counters, exactly like Level::chunkRevisions.
+    sf::Vector2u chunkCount;
+    std::vector<unsigned int> chunkRevisions;
+
+    // Sets the grid dimensions and fills every row with one run of `fill`.
+    void resize(sf::Vector2u newSize, TileType fill = Air) {
+        size = newSize;
+        sizePixels = {(float)size.x * TILE_SIZE, (float)size.y * TILE_SIZE};
+        rows.assign(size.y, std::vector<TileRun>{{0, fill}});
+        chunkCount = {(size.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE};
+        chunkRevisions.assign((std::size_t)chunkCount.x * chunkCount.y, 1);
+    }
+
+    bool inBounds(int x, int y) const {
+        return x >= 0 && x < (int)size.x && y >= 0 && y < (int)size.y;
+    }
+
+    // Returns the tile at (x, y), or Air outside the level.
+    TileType getTile(int x, int y) const {
+        if (!inBounds(x, y)) return Air;
+        const std::vector<TileRun>& row = rows[y];
+        return row[findRun(row, (std::uint32_t)x)].type;
+    }
+
+    // Changes the tile at (x, y), splitting and merging runs as needed. Writes
+    // outside the level are ignored.
+    void setTile(int x, int y, TileType type) {
+        if (!inBounds(x, y)) return;
+        std::vector<TileRun>& row = rows[y];
+        const std::uint32_t column = (std::uint32_t)x;
+        std::size_t i = findRun(row, column);
+        const TileRun run = row[i];
+        if (run.type == type) return;
+        const std::uint32_t end = runEnd(row, i);
+
+        // Cut the tile out of its run: [start, x) old, [x, x + 1) new, [x + 1, end) old.
+        if (end - run.start == 1) {
+            row[i].type = type;
+        } else if (column == run.start) {
+            row[i].start = column + 1;
+            row.insert(row.begin() + i, TileRun{column, type});
+        } else if (column + 1 == end) {
+            row.insert(row.begin() + i + 1, TileRun{column, type});
+            ++i;
+        } else {
+            const TileRun pieces[2] = {{column, type}, {column + 1, run.type}};
+            row.insert(row.begin() + i + 1, pieces, pieces + 2);
+            ++i;
+        }
+        // Merge with neighbours of the same type so runs stay maximal.
+        if (i + 1 < row.size() && row[i + 1].type == type) row.erase(row.begin() + i + 1);
+        if (i > 0 && row[i - 1].type == type) row.erase(row.begin() + i);
+
+        markChunkChanged(x / CHUNK_SIZE, y / CHUNK_SIZE);
+    }
+
+    unsigned int getChunkRevision(int cx, int cy) const {
+        return chunkRevisions[(std::size_t)cy * chunkCount.x + cx];
+    }
+
+    void markChunkChanged(int cx, int cy) {
+        ++chunkRevisions[(std::size_t)cy * chunkCount.x + cx];
+    }
+
+    // Calls `visit(begin, end, type)` for every run of row y that overlaps
+    // columns [x0, x1), clipped to that range.
+    template <typename Visitor>
+    void forEachRun(int y, int x0, int x1, Visitor&& visit) const {
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, (int)size.x);
+        if (y < 0 || y >= (int)size.y || x0 >= x1) return;
+        const std::vector<TileRun>& row = rows[y];
+        for (std::size_t i = findRun(row, (std::uint32_t)x0); i < row.size() && (int)row[i].start < x1; ++i) {
+            const int begin = std::max((int)row[i].start, x0);
+            const int end = std::min((int)runEnd(row, i), x1);
+            visit(begin, end, row[i].type);
+        }
+    }
+
+    // Total number of runs in the level.
+    std::size_t runCount() const {
+        std::size_t count = 0;
+        for (const auto& row : rows) count += row.size();
+        return count;
+    }
+
+    // Approximate heap memory used by the level, in bytes.
+    std::size_t memoryBytes() const {
+        std::size_t bytes = rows.capacity() * sizeof(rows[0]) + chunkRevisions.capacity() * sizeof(unsigned int);
+        for (const auto& row : rows) bytes += row.capacity() * sizeof(TileRun);
+        return bytes;
+    }
+
+private:
+    // Index of the run containing column x: a binary search on the run starts
+    // written without branches on the comparison (the halving loop runs a
+    // fixed number of times for a given row length), so random reads don't
+    // pay for mispredicted jumps.
+    static std::size_t findRun(const std::vector<TileRun>& row, std::uint32_t x) {
+        const TileRun* base = row.data();
+        std::size_t count = row.size();
+        while (count > 1) {
+            const std::size_t half = count / 2;
+            base = (base[half].start <= x) ? base + half : base;
+            count -= half;
+        }
+        return (std::size_t)(base - row.data());
+    }
+
+    std::uint32_t runEnd(const std::vector<TileRun>& row, std::size_t i) const {
+        return (i + 1 < row.size()) ? row[i + 1].start : size.x;
+    }
+};
+
+// --- Run Iteration ---
+
+// Calls `visit(begin, end, type)` for every run of identical tiles in row y of
+// a dense level, over columns [x0, x1). This lets code written against runs
+// work on both level types; on the dense grid it still has to look at every tile.
+template <typename Visitor>
+void forEachTileRun(const Level& level, int y, int x0, int x1, Visitor&& visit) {
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, (int)level.size.x);
+    if (y < 0 || y >= (int)level.size.y) return;
+    const TileType* row = &level.tiles[(std::size_t)y * level.size.x];
+    for (int x = x0; x < x1;) {
+        const TileType type = row[x];
+        int end = x + 1;
+        while (end < x1 && row[end] == type) ++end;
+        visit(x, end, type);
+        x = end;
+    }
+}
+
+// The same for an RLE level: one step per run, however long it is.
+template <typename Visitor>
+void forEachTileRun(const RleLevel& level, int y, int x0, int x1, Visitor&& visit) {
+    level.forEachRun(y, x0, x1, visit);
+}
+
+// --- Conversions ---
+
+// Encodes a dense level into runs.
+inline RleLevel rleFromLevel(const Level& level) {
+    RleLevel rle;
+    rle.resize(level.size);
+    for (unsigned int y = 0; y < level.size.y; ++y) {
+        std::vector<TileRun>& row = rle.rows[y];
+        row.clear();
+        forEachTileRun(level, (int)y, 0, (int)level.size.x, [&](int begin, int, TileType type) {
+            row.push_back({(std::uint32_t)begin, type});
+        });
+        if (row.empty()) row.push_back({0, Air}); // Zero-width level.
+        row.shrink_to_fit();
+    }
+    return rle;
+}
+
+// Decodes runs back into a dense level.
+inline Level levelFromRle(const RleLevel& rle) {
+    Level level;
+    level.resize(rle.size);
+    for (unsigned int y = 0; y < rle.size.y; ++y) {
+        rle.forEachRun((int)y, 0, (int)rle.size.x, [&](int begin, int end, TileType type) {
+            std::fill(level.tiles.begin() + (std::size_t)y * level.size.x + begin,
+                      level.tiles.begin() + (std::size_t)y * level.size.x + end, type);
+        });
+    }
+    return level;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+// --- Includes ---
+// Players, their input and the compact per-entity state from the snapshot format.
+#include "Player.hpp"
+#include "GameSnapshot.hpp"
+// This header provides std::uint64_t for tick numbers.
+#include <cstdint>
+// This header provides std::vector.
+#include <vector>
+
+// --- Rollback ---
+
+// How far back late input can still be applied, in ticks. Input that arrives
+// later than this is too old to rewind to and is dropped.
+const int MAX_ROLLBACK_TICKS = 10;
+
+// Runs a group of players tick by tick while keeping enough history to rewind
+// when late input arrives (online play): every tick it stores each player's
+// compact state (a SnapshotEntity, 24 bytes) and the input it was simulated
+// with in a ring buffer. Inputs that haven't arrived yet are predicted by
+// repeating the player's last known input. When the real input for an
+// earlier tick turns out different, resimulate() restores the states of that
+// tick and replays every tick since with the corrected inputs.
+//
+// The level is treated as unchanged during the rollback window: tile edits
+// (collected items) are not rolled back. Replayed ticks don't report gameplay
+// events again; those were already reported when the tick first ran.
+class RollbackSimulation {
+public:
+    explicit RollbackSimulation(std::vector<Player>& simulatedPlayers)
+        : players(simulatedPlayers), lastKnownInput(simulatedPlayers.size()),
+          knownInputTick(simulatedPlayers.size()), hasKnownInput(simulatedPlayers.size()) {
+        for (Frame& frame : history) {
+            frame.states.resize(players.size());
+            frame.inputs.resize(players.size());
+            frame.predicted.resize(players.size());
+        }
+    }
+
+    // The next tick to be simulated.
+    std::uint64_t currentTick() const { return tick; }
+
+    // The input of one player for one tick. Remote players whose input hasn't
+    // arrived yet have `known` false and get a predicted input instead.
+    struct TickInput {
+        PlayerInput input;
+        bool known = true;
+    };
+
+    // Simulates one tick. `inputs` has one entry per player.
+    template <typename LevelT>
+    void advance(const LevelT& level, const TickInput* inputs) {
+        Frame& frame = history[tick % HISTORY_SIZE];
+        frame.tick = tick;
+        for (std::size_t i = 0; i < players.size(); ++i) {
+            if (inputs[i].known) {
+                hasKnownInput[i] = true;
+                knownInputTick[i] = tick;
+                lastKnownInput[i] = inputs[i].input;
+            }
+            frame.inputs[i] = inputs[i].known ? inputs[i].input : predict(i);
+            frame.predicted[i] = !inputs[i].known;
+        }
+        simulateFrame(level, frame);
+        ++tick;
+    }
+
+    // Reports the real input of `player` for an already simulated tick. If it
+    // differs from what was used, that tick is scheduled for re-simulation,
+    // and later ticks that are still predicted are predicted again from it.
+    // Returns false if the tick is too old to roll back to.
+    bool confirmInput(std::size_t player, std::uint64_t inputTick, const PlayerInput& input) {
+        if (inputTick >= tick) return true; // Not simulated yet; nothing to fix.
+        if (tick - inputTick > (std::uint64_t)MAX_ROLLBACK_TICKS) return false;
+        setInput(inputTick, player, input, false);
+        // Newer than anything known for this player: it is the basis of new predictions.
+        if (!hasKnownInput[player] || inputTick >= knownInputTick[player]) {
+            hasKnownInput[player] = true;
+            knownInputTick[player] = inputTick;
+            lastKnownInput[player] = input;
+            for (std::uint64_t t = inputTick + 1; t < tick; ++t) {
+                if (history[t % HISTORY_SIZE].predicted[player]) setInput(t, player, predict(player), true);
+            }
+        }
+        return true;
+    }
+
+    // Rewinds to the earliest tick with corrected input and replays up to the
+    // present. Returns the number of ticks re-simulated (0 if nothing changed).
+    template <typename LevelT>
+    int resimulate(const LevelT& level) {
+        if (!rollbackPending) return 0;
+        rollbackPending = false;
+        int replayed = 0;
+        for (std::uint64_t t = rollbackTick; t < tick; ++t) {
+            Frame& frame = history[t % HISTORY_SIZE];
+            if (t == rollbackTick) {
+                // Put every player back into the state it had at that tick.
+                for (std::size_t i = 0; i < players.size(); ++i) applySnapshotEntity(frame.states[i], players[i]);
+            }
+            simulateFrame(level, frame, t != rollbackTick, false);
+            ++replayed;
+        }
+        return replayed;
+    }
+
+private:
+    // The ring holds one frame more than the rollback window, since rewinding
+    // to tick t needs the states saved *at the start of* tick t.
+    static constexpr int HISTORY_SIZE = MAX_ROLLBACK_TICKS + 1;
+
+    struct Frame {
+        std::uint64_t tick = 0;
+        std::vector<SnapshotEntity> states; // Every player at the start of the tick.
+        std::vector<PlayerInput> inputs;    // What each player was simulated with.
+        std::vector<bool> predicted;        // Whether that input was a guess.
+    };
+
+    std::vector<Player>& players;
+    // The newest real input of every player and the tick it belongs to.
+    std::vector<PlayerInput> lastKnownInput;
+    std::vector<std::uint64_t> knownInputTick;
+    std::vector<bool> hasKnownInput;
+    Frame history[HISTORY_SIZE];
+    std::uint64_t tick = 0;
+    bool rollbackPending = false;
+    std::uint64_t rollbackTick = 0;
+
+    // Saves the start-of-tick states (unless they are already there) and steps
+    // every player with the frame's inputs.
+    template <typename LevelT>
+    void simulateFrame(const LevelT& level, Frame& frame, bool saveStates = true, bool reportEvents = true) {
+        for (std::size_t i = 0; i < players.size(); ++i) {
+            Player& player = players[i];
+            if (saveStates) frame.states[i] = snapshotEntityFromPlayer(player);
+            GameEventQueue* events = player.events;
+            if (!reportEvents) player.events = nullptr;
+            player.step(frame.inputs[i], level);
+            player.events = events;
+        }
+    }
+
+    // Replaces the input of `player` at tick t, scheduling a rollback to t if
+    // the tick was simulated with something else.
+    void setInput(std::uint64_t t, std::size_t player, const PlayerInput& input, bool predicted) {
+        Frame& frame = history[t % HISTORY_SIZE];
+        frame.predicted[player] = predicted;
+        if (sameInput(frame.inputs[player], input)) return;
+        frame.inputs[player] = input;
+        if (!rollbackPending || t < rollbackTick) rollbackTick = t;
+        rollbackPending = true;
+    }
+
+    // Guess for input that hasn't arrived: players tend to keep holding the
+    // same buttons, but a jump press only lasts one tick.
+    PlayerInput predict(std::size_t player) const {
+        PlayerInput guess = lastKnownInput[player];
+        guess.jump = false;
+        return guess;
+    }
+
+    static bool sameInput(const PlayerInput& a, const PlayerInput& b) {
+        return a.left == b.left && a.right == b.right && a.jump == b.jump;
+    }
+};
@@ -0,0 +1,449 @@
+#pragma once
+
+// --- Includes ---
+// The level whose tiles are simulated, tile flags and CHUNK_SIZE.
+#include "Level.hpp"
+// The threads that update bands of chunks in parallel.
+#include "WorkerPool.hpp"
+// This header provides std::min, std::max and std::sort.
+#include <algorithm>
+// This header provides fixed-width integer types.
+#include <cstdint>
+// This header provides std::memcpy, used to handle eight tiles at once.
+#include <cstring>
+// This header provides std::numeric_limits for empty rectangles.
+#include <limits>
+// This header provides std::vector.
+#include <vector>
+
+// --- Sand Simulation ---
+
+// Falling sand and flowing water as a cellular automaton that runs directly on
+// Level::tiles. Every tick each TILE_FALLING tile (see TileTraits.hpp) moves at
+// most one cell: down if it can, otherwise diagonally down, and liquids
+// (TILE_LIQUID) also sideways. Heavy tiles sink through liquids by swapping
+// places. Because the tiles live in the level itself, collision, raycasts and
+// rendering see every move immediately, and the chunks with moved tiles are
+// marked changed so the render cache rebuilds them.
+//
+// Only active chunks are processed, and within them only a dirty rectangle:
+// the cells that changed last tick plus a one-cell border (whatever can move
+// now). A settled pile goes to sleep and costs nothing until something next to
+// it changes (wake()).
+//
+// The active chunks of one chunk row form a band, updated row by row from the
+// bottom up, so memory is read in long runs along the level's rows. Bands are
+// updated in parallel in two passes, first the even chunk rows, then the odd
+// ones. A tile moves at most one row, so updating a band touches only that
+// band and the first row of the band below it. Two bands of the same pass are
+// a whole chunk row apart, so they never touch the same cells and need no locks.
+//
+// Where eight cells in a row have only Air below them, everything among them
+// that falls simply drops, and that is done with a few 64-bit word operations
+// instead of a branch per cell.
+static_assert(Air == 0, "the simulation tests eight Air tiles at once by comparing a word with 0");
+
+class SandSimulation {
+public:
+    // A rectangle of cells in level coordinates, inclusive.
+    struct Rect {
+        int x0 = std::numeric_limits<int>::max(), y0 = std::numeric_limits<int>::max();
+        int x1 = std::numeric_limits<int>::min(), y1 = std::numeric_limits<int>::min();
+        bool empty() const { return x0 > x1 || y0 > y1; }
+        void add(const Rect& other) {
+            x0 = std::min(x0, other.x0);
+            y0 = std::min(y0, other.y0);
+            x1 = std::max(x1, other.x1);
+            y1 = std::max(y1, other.y1);
+        }
+        Rect clippedTo(const Rect& bounds) const {
+            return {std::max(x0, bounds.x0), std::max(y0, bounds.y0), std::min(x1, bounds.x1), std::min(y1, bounds.y1)};
+        }
+    };
+
+    // `threadCount` includes the calling thread; 0 means one per CPU core.
+    explicit SandSimulation(unsigned int threadCount = 0) : pool(threadCount) {}
+
+    // Starts simulating `level`: every chunk that contains a falling tile is
+    // woken up. Call again after the level is replaced or resized.
+    void reset(const Level& level) {
+        size = level.size;
+        chunkCount = level.chunkCount;
+        chunks.assign((std::size_t)chunkCount.x * chunkCount.y, ChunkState());
+        moved.assign(level.tiles.size(), 0);
+        active.clear();
+        woken.clear();
+        for (unsigned int cy = 0; cy < chunkCount.y; ++cy) {
+            for (unsigned int cx = 0; cx < chunkCount.x; ++cx) {
+                const Rect bounds = chunkBounds(cx, cy);
+                bool hasFalling = false;
+                for (int y = bounds.y0; y <= bounds.y1 && !hasFalling; ++y) {
+                    for (int x = bounds.x0; x <= bounds.x1; ++x) hasFalling = hasFalling || tileHas<TILE_FALLING>(level.getTile(x, y));
+                }
+                if (hasFalling) addIncoming(cy * chunkCount.x + cx, bounds);
+            }
+        }
+    }
+
+    // Tells the simulation that the tile at (x, y) was changed by something
+    // else (the player collecting an item, an editor, ...), so the tiles
+    // around it are looked at again next tick.
+    void wake(int x, int y) {
+        if (x < 0 || y < 0 || x >= (int)size.x || y >= (int)size.y) return;
+        addIncoming(Rect{x - 1, y - 1, x + 1, y + 1});
+    }
+
+    // The same for every tile of the rectangle (x0, y0)-(x1, y1) (inclusive),
+    // e.g. a chunk replaced by a level reload.
+    void wake(int x0, int y0, int x1, int y1) { addIncoming(Rect{x0 - 1, y0 - 1, x1 + 1, y1 + 1}); }
+
+    // Advances the simulation by one tick.
+    void step(Level& level) {
+        if (level.size != size) reset(level);
+        ++tick;
+        // 0 means "never moved". When the stamps run out, every cell's stamp
+        // is cleared, or a cell that last moved 255 ticks ago would look as if
+        // it had moved this tick (one byte per tile to clear, once every 255
+        // ticks).
+        if (++stamp == 0) {
+            std::fill(moved.begin(), moved.end(), 0);
+            stamp = 1;
+        }
+        cellsProcessed = 0;
+        cellsMoved = 0;
+        changes.clear();
+        regions.clear();
+
+        // This tick's work: the chunks woken since the last tick, with the
+        // cells that were marked for them, sorted into bands by chunk row.
+        active.clear();
+        for (std::uint32_t i : woken) {
+            ChunkState& chunk = chunks[i];
+            if (chunk.incoming.empty()) continue; // Listed twice.
+            chunk.current = chunk.incoming;
+            chunk.incoming = Rect();
+            active.push_back(i);
+        }
+        woken.clear();
+        std::sort(active.begin(), active.end());
+        bands.clear();
+        for (std::size_t i = 0; i < active.size(); ++i) {
+            if (i == 0 || active[i] / chunkCount.x != active[i - 1] / chunkCount.x) bands.push_back({i, i});
+            bands.back().end = i + 1;
+        }
+
+        for (unsigned int parity = 0; parity < 2; ++parity) {
+            passBands.clear();
+            for (const Band& band : bands) {
+                if ((active[band.begin] / chunkCount.x) % 2 == parity) passBands.push_back(band);
+            }
+            pool.parallelFor(passBands.size(), [&](std::size_t n) {
+                if (tick & 1) {
+                    updateBand<1>(level, passBands[n]);
+                } else {
+                    updateBand<-1>(level, passBands[n]);
+                }
+            }, "sand bands");
+        }
+
+        // Hand the dirty rectangles (which may reach into neighbouring chunks)
+        // to the chunks they belong to and mark the chunks whose tiles changed
+        // in the level. Done on one thread, after both passes, so the band
+        // updates never write another band's chunk state.
+        for (std::uint32_t i : active) {
+            ChunkState& chunk = chunks[i];
+            cellsProcessed += chunk.processedCells;
+            cellsMoved += chunk.movedCells;
+            changes.insert(changes.end(), chunk.changes.begin(), chunk.changes.end());
+            if (!chunk.changed.empty()) regions.push_back(chunk.changed);
+            if (chunk.outgoing.empty()) continue;
+            const int cx = (int)(i % chunkCount.x);
+            const int cy = (int)(i / chunkCount.x);
+            for (int ncy = std::max(cy - 1, 0); ncy <= std::min(cy + 1, (int)chunkCount.y - 1); ++ncy) {
+                for (int ncx = std::max(cx - 1, 0); ncx <= std::min(cx + 1, (int)chunkCount.x - 1); ++ncx) {
+                    const Rect bounds = chunkBounds(ncx, ncy);
+                    if (!chunk.changed.clippedTo(bounds).empty()) level.markChunkChanged(ncx, ncy);
+                    const Rect part = chunk.outgoing.clippedTo(bounds);
+                    if (!part.empty()) addIncoming((std::uint32_t)(ncy * chunkCount.x + ncx), part);
+                }
+            }
+        }
+    }
+
+    // With recording on, changedTiles() lists the tiles the last step()
+    // changed (for systems that follow tile changes, like the light map).
+    void setRecordChanges(bool record) { recordChanges = record; }
+    const std::vector<sf::Vector2i>& changedTiles() const { return changes; }
+
+    // The rectangles holding every tile the last step() changed, one per
+    // active chunk that changed (they may reach into neighbouring chunks and
+    // overlap). For following a big change in one go rather than tile by tile.
+    const std::vector<Rect>& changedRegions() const { return regions; }
+
+    // Statistics of the last step().
+    std::size_t activeChunks() const { return active.size(); }
+    std::size_t processedCells() const { return cellsProcessed; }
+    std::size_t movedCells() const { return cellsMoved; }
+    unsigned int threadCount() const { return pool.threadCount(); }
+
+private:
+    struct ChunkState {
+        Rect current;  // Cells to update this tick (inside the chunk).
+        Rect incoming; // Cells to update next tick (inside the chunk).
+        // Written by the chunk's band during step(), read after both passes:
+        Rect changed;  // Cells whose tile changed (may reach into neighbours).
+        Rect outgoing; // The changed cells plus a border: what may move next tick.
+        std::size_t processedCells = 0;
+        std::size_t movedCells = 0;
+        std::vector<sf::Vector2i> changes; // With recordChanges: both ends of every move.
+    };
+
+    // Consecutive entries [begin, end) of `active` in the same chunk row.
+    struct Band {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    // What the update of one row changed, collected while going along the row.
+    struct RowChanges {
+        int changedX0 = std::numeric_limits<int>::max(), changedX1 = std::numeric_limits<int>::min();
+        int wakeX0 = std::numeric_limits<int>::max(), wakeX1 = std::numeric_limits<int>::min();
+        bool changedBelow = false; // Whether tiles moved into the row below.
+        std::size_t moved = 0;
+
+        // Tiles x0..x1 of the row (and of the row below, if `down`) changed.
+        void change(int x0, int x1, bool down) {
+            changedX0 = std::min(changedX0, x0);
+            changedX1 = std::max(changedX1, x1);
+            changedBelow |= down;
+        }
+        // Tiles x0..x1 of the row have to be looked at again next tick.
+        void wake(int x0, int x1) {
+            wakeX0 = std::min(wakeX0, x0);
+            wakeX1 = std::max(wakeX1, x1);
+        }
+        void addTo(ChunkState& chunk, int y) const {
+            chunk.movedCells += moved;
+            if (changedX0 <= changedX1) {
+                chunk.changed.add({changedX0, y, changedX1, changedBelow ? y + 1 : y});
+                chunk.outgoing.add({changedX0 - 1, y - 1, changedX1 + 1, y + 2});
+            }
+            if (wakeX0 <= wakeX1) chunk.outgoing.add({wakeX0 - 1, y - 1, wakeX1 + 1, y + 1});
+        }
+    };
+
+    // Multiplying a byte by this repeats it in all eight bytes of a word.
+    static constexpr std::uint64_t BYTES_OF_ONES = 0x0101010101010101ull;
+
+    WorkerPool pool;
+    sf::Vector2u size;
+    sf::Vector2u chunkCount;
+    std::vector<ChunkState> chunks;
+    // Per cell: the stamp of the tick it last moved in, so a tile that moved
+    // into a cell that is processed later in the same tick doesn't move twice.
+    std::vector<std::uint8_t> moved;
+    std::uint8_t stamp = 0;
+    unsigned int tick = 0;
+    std::vector<std::uint32_t> active;  // Chunks updated by the last step().
+    std::vector<std::uint32_t> woken;   // Chunks with incoming cells (may repeat).
+    std::vector<Band> bands;            // The chunk rows of `active`.
+    std::vector<Band> passBands;        // The bands of the current pass.
+    std::size_t cellsProcessed = 0;
+    std::size_t cellsMoved = 0;
+    bool recordChanges = false;
+    std::vector<sf::Vector2i> changes;
+    std::vector<Rect> regions;
+
+    // The cells of chunk (cx, cy).
+    Rect chunkBounds(int cx, int cy) const {
+        return {cx * CHUNK_SIZE, cy * CHUNK_SIZE, std::min((cx + 1) * CHUNK_SIZE, (int)size.x) - 1,
+                std::min((cy + 1) * CHUNK_SIZE, (int)size.y) - 1};
+    }
+
+    void addIncoming(std::uint32_t chunkIndex, const Rect& rect) {
+        ChunkState& chunk = chunks[chunkIndex];
+        if (chunk.incoming.empty()) woken.push_back(chunkIndex);
+        chunk.incoming.add(rect);
+    }
+
+    // Marks `rect` for the next tick, in whichever chunks it covers.
+    void addIncoming(const Rect& rect) {
+        const Rect level{0, 0, (int)size.x - 1, (int)size.y - 1};
+        const Rect clipped = rect.clippedTo(level);
+        if (clipped.empty()) return;
+        for (int cy = clipped.y0 / CHUNK_SIZE; cy <= clipped.y1 / CHUNK_SIZE; ++cy) {
+            for (int cx = clipped.x0 / CHUNK_SIZE; cx <= clipped.x1 / CHUNK_SIZE; ++cx) {
+                addIncoming((std::uint32_t)(cy * chunkCount.x + cx), clipped.clippedTo(chunkBounds(cx, cy)));
+            }
+        }
+    }
+
+    // Can a tile with `moverFlags` move into a cell holding `target`?
+    static bool canEnter(std::uint8_t moverFlags, TileType target) {
+        if (target == Air) return true;
+        // Heavy falling tiles sink through liquids.
+        return (moverFlags & TILE_LIQUID) == 0 && tileHas<TILE_LIQUID>(target);
+    }
+
+    // Updates one band from its lowest dirty row up, so a column of sand falls
+    // together instead of one tile per tick. Each row goes through the band's
+    // chunks in direction `Dir`, which alternates every tick so piles don't
+    // lean one way.
+    template <int Dir>
+    void updateBand(Level& level, const Band& band) {
+        int top = std::numeric_limits<int>::max();
+        int bottom = std::numeric_limits<int>::min();
+        for (std::size_t i = band.begin; i < band.end; ++i) {
+            ChunkState& chunk = chunks[active[i]];
+            chunk.changed = Rect();
+            chunk.outgoing = Rect();
+            chunk.movedCells = 0;
+            chunk.changes.clear();
+            chunk.processedCells = (std::size_t)(chunk.current.x1 - chunk.current.x0 + 1) *
+                                   (std::size_t)(chunk.current.y1 - chunk.current.y0 + 1);
+            top = std::min(top, chunk.current.y0);
+            bottom = std::max(bottom, chunk.current.y1);
+        }
+        for (int y = bottom; y >= top; --y) {
+            for (std::size_t n = 0; n < band.end - band.begin; ++n) {
+                ChunkState& chunk = chunks[active[Dir > 0 ? band.begin + n : band.end - 1 - n]];
+                if (y >= chunk.current.y0 && y <= chunk.current.y1) {
+                    updateRow<Dir>(level, chunk, y, chunk.current.x0, chunk.current.x1);
+                }
+            }
+        }
+    }
+
+    // Updates cells x0..x1 of row y, which belong to `chunk`.
+    template <int Dir>
+    void updateRow(Level& level, ChunkState& chunk, int y, int x0, int x1) {
+        const int width = (int)size.x;
+        TileType* row = level.tiles.data() + (std::size_t)y * width;
+        TileType* below = row + width;
+        std::uint8_t* movedRow = moved.data() + (std::size_t)y * width;
+        const bool hasBelow = y + 1 < (int)size.y;
+        const std::uint8_t currentStamp = stamp;
+        const int first = Dir > 0 ? x0 : x1;
+        const int last = Dir > 0 ? x1 + 1 : x0 - 1;
+        // Collected in locals (registers) and added to the chunk at the end.
+        RowChanges rowChanges;
+        for (int x = first; x != last; x += Dir) {
+            // Eight cells at a time where possible: runs of Air are skipped,
+            // and over eight empty cells everything that falls just drops
+            // (what a falling cloud mostly does, since the row below has just
+            // moved out of the way).
+            if (Dir > 0 ? x + 7 <= x1 : x - 7 >= x0) {
+                const int lo = Dir > 0 ? x : x - 7;
+                std::uint64_t eight;
+                std::memcpy(&eight, row + lo, sizeof(eight));
+                if (eight == 0) {
+                    x += 7 * Dir;
+                    continue;
+                }
+                std::uint64_t belowEight = 1;
+                if (hasBelow) std::memcpy(&belowEight, below + lo, sizeof(belowEight));
+                if (belowEight == 0) {
+                    dropEight(chunk, rowChanges, row, movedRow, lo, y, width, currentStamp);
+                    x += 7 * Dir;
+                    continue;
+                }
+            }
+
+            const std::uint8_t flags = TILE_FLAGS[row[x]];
+            if ((flags & TILE_FALLING) == 0) continue;
+            if (movedRow[x] == currentStamp) {
+                // Already moved this tick: look at it again next tick.
+                rowChanges.wake(x, x);
+                continue;
+            }
+            // Pseudo-random but reproducible side preference per cell and tick.
+            const int side = ((x ^ y ^ (int)tick) & 1) ? 1 : -1;
+            const int a = x + side;
+            const int b = x - side;
+            const bool aInside = a >= 0 && a < width;
+            const bool bInside = b >= 0 && b < width;
+            int toX = x, toY = y;
+            if (hasBelow && canEnter(flags, below[x])) {
+                toY = y + 1;
+            } else if (hasBelow && aInside && canEnter(flags, below[a])) {
+                toX = a;
+                toY = y + 1;
+            } else if (hasBelow && bInside && canEnter(flags, below[b])) {
+                toX = b;
+                toY = y + 1;
+            } else if ((flags & TILE_LIQUID) && aInside && row[a] == Air) {
+                toX = a;
+            } else if ((flags & TILE_LIQUID) && bInside && row[b] == Air) {
+                toX = b;
+            } else {
+                continue;
+            }
+
+            // Swap with whatever was there (Air, or a liquid the tile sinks through).
+            TileType& target = row[(toY - y) * width + toX];
+            const TileType displaced = target;
+            target = row[x];
+            row[x] = displaced;
+            movedRow[(toY - y) * width + toX] = currentStamp;
+            if (displaced != Air) movedRow[x] = currentStamp;
+            rowChanges.change(std::min(x, toX), std::max(x, toX), toY > y);
+            ++rowChanges.moved;
+            if (recordChanges) {
+                chunk.changes.push_back({x, y});
+                chunk.changes.push_back({toX, toY});
+            }
+        }
+        rowChanges.addTo(chunk, y);
+    }
+
+    // Drops every falling tile of the eight cells row[lo..lo+7] into the empty
+    // cells below them, with word operations instead of a branch per cell.
+    void dropEight(ChunkState& chunk, RowChanges& rowChanges, TileType* row, std::uint8_t* movedRow, int lo, int y, int width,
+                   std::uint8_t currentStamp) {
+        // Per cell 0xFF if its tile falls now, computed without branches (the
+        // tiles of a falling cloud are random, so branches would guess wrong).
+        std::uint8_t fallBytes[8];
+        unsigned int anyFalling = 0, anyStale = 0;
+        for (int i = 0; i < 8; ++i) {
+            const unsigned int falling = (TILE_FLAGS[row[lo + i]] & TILE_FALLING) != 0;
+            const unsigned int stale = falling & (movedRow[lo + i] == currentStamp);
+            fallBytes[i] = (std::uint8_t)(0u - (falling & ~stale & 1u));
+            anyFalling |= falling & ~stale;
+            anyStale |= stale;
+        }
+        if (anyStale) {
+            for (int i = 0; i < 8; ++i) {
+                if (fallBytes[i] == 0 && (TILE_FLAGS[row[lo + i]] & TILE_FALLING) != 0) {
+                    // Already moved this tick: look at it again next tick.
+                    rowChanges.wake(lo + i, lo + i);
+                }
+            }
+        }
+        if (!anyFalling) return;
+
+        std::uint64_t fallMask, tilesNow, movedBelow;
+        std::memcpy(&fallMask, fallBytes, sizeof(fallMask));
+        std::memcpy(&tilesNow, row + lo, sizeof(tilesNow));
+        std::memcpy(&movedBelow, movedRow + width + lo, sizeof(movedBelow));
+        const std::uint64_t fallen = tilesNow & fallMask;
+        tilesNow &= ~fallMask;
+        movedBelow = (movedBelow & ~fallMask) | (BYTES_OF_ONES * currentStamp & fallMask);
+        std::memcpy(row + lo, &tilesNow, sizeof(tilesNow));
+        std::memcpy(row + width + lo, &fallen, sizeof(fallen));
+        std::memcpy(movedRow + width + lo, &movedBelow, sizeof(movedBelow));
+
+        int first = 0, last = 7;
+        while (fallBytes[first] == 0) ++first;
+        while (fallBytes[last] == 0) --last;
+        rowChanges.change(lo + first, lo + last, true);
+        for (int i = first; i <= last; ++i) rowChanges.moved += fallBytes[i] & 1;
+        if (recordChanges) {
+            for (int i = first; i <= last; ++i) {
+                if (fallBytes[i] != 0) {
+                    chunk.changes.push_back({lo + i, y});
+                    chunk.changes.push_back({lo + i, y + 1});
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+// --- Includes ---
+// SFML's graphics module: frames are rectangles of an sf::Texture, and every
+// animated sprite becomes two triangles of one sf::VertexArray.
+#include <SFML/Graphics.hpp>
+// This header provides std::min.
+#include <algorithm>
+// This header provides std::abs.
+#include <cmath>
+// This header provides fixed-width integer types (std::uint16_t, std::uint32_t).
+#include <cstdint>
+// This header provides std::initializer_list, used to list a clip's keyframes.
+#include <initializer_list>
+// This header provides std::vector.
+#include <vector>
+
+// --- Animation Clips ---
+
+// One keyframe of a clip: a rectangle of the sprite sheet (texture pixels)
+// shown for `ticks` simulation ticks.
+struct AnimationKeyframe {
+    sf::FloatRect rect;
+    std::uint16_t ticks = 1;
+};
+
+// The clips of one sprite sheet (e.g. a character's idle, run, jump and fall),
+// stored once and shared by every sprite that uses them.
+//
+// A clip's keyframes can last different numbers of ticks, so finding the
+// frame shown at a given time would mean walking the keyframes. Instead every
+// clip is expanded once, when it is added, into a table with one entry per
+// tick of the clip: looking a frame up is then one modulo and two loads, the
+// same for every clip. The tables are small (a clip lasting a second takes
+// 60 entries of two bytes).
+class AnimationLibrary {
+public:
+    // Adds a clip and returns its index. A looping clip starts over after its
+    // last keyframe; any other clip holds its last keyframe from then on.
+    std::uint16_t addClip(std::initializer_list<AnimationKeyframe> keyframes, bool loop) {
+        Clip clip;
+        clip.tableStart = (std::uint32_t)frameAtTick.size();
+        clip.loop = loop;
+        for (const AnimationKeyframe& keyframe : keyframes) {
+            const std::uint16_t frame = (std::uint16_t)frames.size();
+            frames.push_back({keyframe.rect.position.x, keyframe.rect.position.y,
+                              keyframe.rect.position.x + keyframe.rect.size.x,
+                              keyframe.rect.position.y + keyframe.rect.size.y});
+            for (std::uint16_t tick = 0; tick < std::max<std::uint16_t>(keyframe.ticks, 1); ++tick) {
+                frameAtTick.push_back(frame);
+            }
+        }
+        clip.length = (std::uint32_t)frameAtTick.size() - clip.tableStart;
+        // An empty clip shows a zero-sized frame.
+        if (clip.length == 0) {
+            frameAtTick.push_back((std::uint16_t)frames.size());
+            frames.push_back({0.f, 0.f, 0.f, 0.f});
+            clip.length = 1;
+        }
+        clips.push_back(clip);
+        return (std::uint16_t)(clips.size() - 1);
+    }
+
+    std::size_t clipCount() const { return clips.size(); }
+
+    // Ticks until a clip has shown all its keyframes once.
+    std::uint32_t clipLength(std::uint16_t clip) const { return clips[clip].length; }
+
+private:
+    friend class SpriteAnimator;
+
+    struct Clip {
+        std::uint32_t tableStart = 0; // First entry of the clip in frameAtTick.
+        std::uint32_t length = 0;     // Entries (ticks) of the clip.
+        bool loop = true;
+    };
+    // Texture coordinates of a keyframe's corners.
+    struct Frame {
+        float left, top, right, bottom;
+    };
+
+    std::vector<Clip> clips;
+    std::vector<Frame> frames;
+    std::vector<std::uint16_t> frameAtTick; // Frame shown at each tick of each clip.
+};
+
+// --- Sprite Animator ---
+
+// Animates and draws many sprites that play clips of one AnimationLibrary.
+//
+// Like ParticleSystem, the sprites are kept as a structure of arrays packed at
+// the front of fixed-size pools. A sprite's animation state is only the clip
+// it plays and how many ticks it has played it; everything else about a clip
+// lives in the library. Advancing every animation is a single loop adding to
+// the tick counters (which the compiler vectorizes), and buildVertices()
+// looks each sprite's frame up and writes its corners and texture coordinates
+// straight into one vertex batch, drawn with the sheet's texture in one call.
+class SpriteAnimator {
+public:
+    // Allocates pools for up to `capacity` sprites. `library` must outlive
+    // the animator.
+    SpriteAnimator(const AnimationLibrary& library, std::size_t capacity)
+        : library(library), clip(capacity), time(capacity), posX(capacity), posY(capacity), halfWidth(capacity),
+          halfHeight(capacity), maxSprites(capacity) {}
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return maxSprites; }
+
+    // Adds a sprite centred on `position`, drawn `halfSize` in each direction,
+    // playing `clipIndex` from its start. Returns the sprite's index, or
+    // capacity() if the pools are full.
+    std::size_t add(std::uint16_t clipIndex, sf::Vector2f position, sf::Vector2f halfSize) {
+        if (count == maxSprites) return maxSprites;
+        const std::size_t i = count++;
+        clip[i] = clipIndex;
+        time[i] = 0;
+        posX[i] = position.x;
+        posY[i] = position.y;
+        halfWidth[i] = halfSize.x;
+        halfHeight[i] = halfSize.y;
+        return i;
+    }
+
+    // Removes sprite `i`; the last sprite moves into its index.
+    void remove(std::size_t i) {
+        const std::size_t last = --count;
+        clip[i] = clip[last];
+        time[i] = time[last];
+        posX[i] = posX[last];
+        posY[i] = posY[last];
+        halfWidth[i] = halfWidth[last];
+        halfHeight[i] = halfHeight[last];
+    }
+
+    void clear() { count = 0; }
+
+    // Switches sprite `i` to `clipIndex`, starting it from the beginning. Does
+    // nothing if the sprite already plays that clip, so it can be called every
+    // tick with the clip the sprite's state calls for.
+    void play(std::size_t i, std::uint16_t clipIndex) {
+        if (clip[i] == clipIndex) return;
+        clip[i] = clipIndex;
+        time[i] = 0;
+    }
+
+    // Moves sprite `i`. A sprite facing left is drawn mirrored (the sheet's
+    // frames face right).
+    void setPosition(std::size_t i, sf::Vector2f position, bool faceLeft) {
+        posX[i] = position.x;
+        posY[i] = position.y;
+        halfWidth[i] = faceLeft ? -std::abs(halfWidth[i]) : std::abs(halfWidth[i]);
+    }
+
+    // Advances every sprite's animation by `ticks`.
+    void update(std::uint32_t ticks = 1) {
+        std::uint32_t* t = time.data();
+        const std::size_t n = count;
+        for (std::size_t i = 0; i < n; ++i) t[i] += ticks;
+    }
+
+    // Writes every sprite as a quad (two triangles, six vertices) with the
+    // texture coordinates of its current frame into `vertices`, which is
+    // resized to fit. Draw it with the sprite sheet's texture.
+    void buildVertices(sf::VertexArray& vertices) const {
+        vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+        vertices.resize(count * 6);
+        if (count == 0) return;
+        const AnimationLibrary::Clip* clips = library.clips.data();
+        const AnimationLibrary::Frame* frames = library.frames.data();
+        const std::uint16_t* frameAtTick = library.frameAtTick.data();
+        sf::Vertex* out = &vertices[0];
+        for (std::size_t i = 0; i < count; ++i, out += 6) {
+            const AnimationLibrary::Clip& c = clips[clip[i]];
+            const std::uint32_t tick = c.loop ? time[i] % c.length : std::min(time[i], c.length - 1);
+            const AnimationLibrary::Frame& frame = frames[frameAtTick[c.tableStart + tick]];
+            // A negative half width swaps the left and right corners, which
+            // mirrors the frame.
+            const float left = posX[i] - halfWidth[i], right = posX[i] + halfWidth[i];
+            const float top = posY[i] - halfHeight[i], bottom = posY[i] + halfHeight[i];
+            out[0] = {{left, top}, sf::Color::White, {frame.left, frame.top}};
+            out[1] = {{right, top}, sf::Color::White, {frame.right, frame.top}};
+            out[2] = {{left, bottom}, sf::Color::White, {frame.left, frame.bottom}};
+            out[3] = out[2];
+            out[4] = out[1];
+            out[5] = {{right, bottom}, sf::Color::White, {frame.right, frame.bottom}};
+        }
+    }
+
+private:
+    const AnimationLibrary& library;
+
+    // --- Sprite Pools (Structure of Arrays) ---
+    std::vector<std::uint16_t> clip;       // Clip being played.
+    std::vector<std::uint32_t> time;       // Ticks since the clip started.
+    std::vector<float> posX, posY;         // Centre (pixels).
+    std::vector<float> halfWidth;          // Half the quad width; negative when facing left.
+    std::vector<float> halfHeight;         // Half the quad height.
+
+    std::size_t count = 0;                 // Live sprites, packed at the front.
+    std::size_t maxSprites;                // Fixed pool size.
+};
+
+// --- Character Clips ---
+
+// The clips of the character sheet made by makeCharacterSheet() (see
+// addCharacterClips()).
+struct CharacterClips {
+    std::uint16_t idle = 0, run = 0, jump = 0, fall = 0;
+};
+
+// The clip a character's body state calls for: idle or run on the ground,
+// jump while rising and fall while falling. Works for any body with
+// `velocity` and `isOnGround` (BasicPlayer of either number type).
+template <typename Body>
+std::uint16_t characterClip(const CharacterClips& clips, const Body& body) {
+    using Scalar = decltype(body.velocity.x);
+    if (body.isOnGround) return body.velocity.x != Scalar() ? clips.run : clips.idle;
+    return body.velocity.y < Scalar() ? clips.jump : clips.fall;
+}
+
+// The size of one frame of the character sheet (texture pixels).
+const unsigned int CHARACTER_FRAME_WIDTH = 16;
+const unsigned int CHARACTER_FRAME_HEIGHT = 19;
+
+// The game ships no image files, so the character's sprite sheet is drawn at
+// startup: a green figure facing right, one frame per pose side by side.
+inline sf::Image makeCharacterSheet() {
+    // Every pose: where the body starts (squats lower it), the two legs' x
+    // offsets and lengths, and whether the arms are raised.
+    struct Pose {
+        int bodyDrop;
+        int legX[2], legLength[2];
+        bool armsUp;
+    };
+    static const Pose POSES[] = {
+        {0, {5, 9}, {5, 5}, false},  // 0: idle
+        {1, {5, 9}, {4, 4}, false},  // 1: idle, breathing out
+        {0, {3, 11}, {5, 4}, false}, // 2: run, stride
+        {1, {6, 8}, {4, 5}, false},  // 3: run, passing
+        {0, {11, 3}, {4, 5}, false}, // 4: run, other stride
+        {1, {8, 6}, {5, 4}, false},  // 5: run, passing
+        {1, {5, 9}, {3, 3}, true},   // 6: jump, take-off
+        {0, {6, 8}, {3, 2}, true},   // 7: jump, tucked
+        {0, {3, 11}, {5, 5}, true},  // 8: fall, flailing
+        {0, {4, 10}, {5, 4}, false}, // 9: fall, flailing
+    };
+    const unsigned int poseCount = sizeof(POSES) / sizeof(POSES[0]);
+    const sf::Color body(60, 200, 60), head(120, 230, 120), limb(30, 130, 30), eye(20, 40, 20);
+    sf::Image sheet({CHARACTER_FRAME_WIDTH * poseCount, CHARACTER_FRAME_HEIGHT}, sf::Color::Transparent);
+    auto fill = [&](unsigned int frame, int x0, int y0, int x1, int y1, sf::Color color) {
+        for (int y = std::max(y0, 0); y < std::min(y1, (int)CHARACTER_FRAME_HEIGHT); ++y) {
+            for (int x = std::max(x0, 0); x < std::min(x1, (int)CHARACTER_FRAME_WIDTH); ++x) {
+                sheet.setPixel({frame * CHARACTER_FRAME_WIDTH + (unsigned int)x, (unsigned int)y}, color);
+            }
+        }
+    };
+    for (unsigned int frame = 0; frame < poseCount; ++frame) {
+        const Pose& pose = POSES[frame];
+        const int drop = pose.bodyDrop;
+        fill(frame, 4, 0 + drop, 12, 6 + drop, head);                 // Head,
+        fill(frame, 9, 2 + drop, 11, 4 + drop, eye);                  // looking right.
+        fill(frame, 3, 6 + drop, 13, 14, body);                       // Body.
+        for (int leg = 0; leg < 2; ++leg) {
+            fill(frame, pose.legX[leg], 14, pose.legX[leg] + 2, 14 + pose.legLength[leg], limb);
+        }
+        if (pose.armsUp) {
+            fill(frame, 1, 2 + drop, 3, 8 + drop, limb);
+            fill(frame, 13, 2 + drop, 15, 8 + drop, limb);
+        } else {
+            fill(frame, 1, 7 + drop, 3, 12 + drop, limb);
+            fill(frame, 13, 7 + drop, 15, 12 + drop, limb);
+        }
+    }
+    return sheet;
+}
+
+// Adds the clips of makeCharacterSheet()'s sheet to `library` (frame numbers
+// are the poses listed there).
+inline CharacterClips addCharacterClips(AnimationLibrary& library) {
+    auto frame = [](unsigned int index, std::uint16_t ticks) {
+        return AnimationKeyframe{{{(float)(index * CHARACTER_FRAME_WIDTH), 0.f},
+                                  {(float)CHARACTER_FRAME_WIDTH, (float)CHARACTER_FRAME_HEIGHT}},
+                                 ticks};
+    };
+    CharacterClips clips;
+    clips.idle = library.addClip({frame(0, 40), frame(1, 25)}, true);
+    clips.run = library.addClip({frame(2, 6), frame(3, 5), frame(4, 6), frame(5, 5)}, true);
+    clips.jump = library.addClip({frame(6, 5), frame(7, 1)}, false);
+    clips.fall = library.addClip({frame(8, 8), frame(9, 8)}, true);
+    return clips;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+// --- Includes ---
+// This header provides std::stable_sort, which orders the report.
+#include <algorithm>
+// This header provides std::chrono::steady_clock for the timestamps.
+#include <chrono>
+// This header provides std::snprintf, used to format the report.
+#include <cstdio>
+// This header provides std::mutex; worker threads record their stages too.
+#include <mutex>
+// This header provides std::string, which holds the report.
+#include <string>
+// This header provides std::vector.
+#include <vector>
+
+// --- Startup Timeline ---
+
+// When the program started, as near as portable code can tell: this is set
+// during static initialization, before main() runs.
+inline const std::chrono::steady_clock::time_point PROGRAM_START = std::chrono::steady_clock::now();
+
+// Where the time from program start to the first frame on screen goes.
+//
+// The main thread records its stages one after another with mark(): each
+// stage runs from the previous mark (or program start) to now. Work that runs
+// alongside (on other threads, or in the background over several frames)
+// records its own stages with record() or StartupStage. report() lists every
+// stage by start time, so stages that overlap the main thread's show how much
+// parallel setup saves.
+class StartupTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Ends the current main thread stage, naming it `name`. Call it only on
+    // the main thread.
+    void mark(const char* name) {
+        const Clock::time_point now = Clock::now();
+        add(name, lastMark, now, false);
+        lastMark = now;
+    }
+
+    // Records a stage that ran alongside the main thread's, from `begin` to
+    // `end`. Safe to call from any thread.
+    void record(const char* name, Clock::time_point begin, Clock::time_point end) { add(name, begin, end, true); }
+
+    // Milliseconds from program start to the last mark.
+    double elapsedMs() const { return milliseconds(PROGRAM_START, lastMark); }
+
+    // A table of the stages: when each started and how long it took, in
+    // milliseconds since program start. Stages that ran alongside are indented.
+    std::string report() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Stage> sorted = stages;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Stage& a, const Stage& b) { return a.begin < b.begin; });
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-30s %8s %12s\n", "startup", "start ms", "duration ms");
+        std::string report = line;
+        for (const Stage& stage : sorted) {
+            std::snprintf(line, sizeof(line), "%s%-*s %8.2f %12.2f\n", stage.alongside ? "  " : "",
+                          stage.alongside ? 28 : 30, stage.name, milliseconds(PROGRAM_START, stage.begin),
+                          milliseconds(stage.begin, stage.end));
+            report += line;
+        }
+        std::snprintf(line, sizeof(line), "(indented: alongside the main thread; its last stage ended at %.2f ms)\n",
+                      elapsedMs());
+        report += line;
+        return report;
+    }
+
+private:
+    struct Stage {
+        const char* name;
+        Clock::time_point begin, end;
+        bool alongside;
+    };
+
+    void add(const char* name, Clock::time_point begin, Clock::time_point end, bool alongside) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stages.push_back({name, begin, end, alongside});
+    }
+
+    static double milliseconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    mutable std::mutex mutex;
+    std::vector<Stage> stages;
+    Clock::time_point lastMark = PROGRAM_START; // Only touched by the main thread.
+};
+
+// Records the enclosing scope as a stage of `timeline` (for work on other
+// threads, or anything that isn't one of the main thread's marks).
+class StartupStage {
+public:
+    StartupStage(StartupTimeline& timeline, const char* name)
+        : timeline(timeline), name(name), begin(StartupTimeline::Clock::now()) {}
+    ~StartupStage() { timeline.record(name, begin, StartupTimeline::Clock::now()); }
+    StartupStage(const StartupStage&) = delete;
+    StartupStage& operator=(const StartupStage&) = delete;
+
+private:
+    StartupTimeline& timeline;
+    const char* name;
+    StartupTimeline::Clock::time_point begin;
+};
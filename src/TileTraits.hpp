@@ -0,0 +1,192 @@
+#pragma once
+
+// --- Includes ---
+// sf::Color, used for each tile type's render color. Only the color header is
+// needed, so headless programs can use the tile tables too.
+#include <SFML/Graphics/Color.hpp>
+// This header provides std::array, the storage for the lookup tables.
+#include <array>
+// This header provides fixed-width integer types (std::uint8_t).
+#include <cstdint>
+
+// --- Tile Types ---
+
+// Defines symbolic names for the different types of tiles in the level grid.
+// The `std::uint8_t` underlying type makes every tile exactly one byte, so a
+// level's grid is compact and there is room for 256 different tile kinds.
+// Everything the game needs to know about a tile kind lives in the tables
+// below, not in `if (tile == ...)` checks spread around the code.
+enum TileType : std::uint8_t {
+    Air = 0,    // Represents empty space. Player can move through these tiles.
+    Solid = 1,  // Represents solid ground/walls. Player collides with these.
+    Coin = 2,   // Collectible worth 1 point.
+    Brick = 3,  // Solid, drawn in a different color.
+    Spikes = 4, // Hazard: touching it sends the player back to the start.
+    Gem = 5,    // Collectible worth 5 points.
+    RampUpRight = 6, // 45 degree slope, low on the left and high on the right.
+    RampUpLeft = 7,  // 45 degree slope, high on the left and low on the right.
+    Platform = 8,    // One-way platform: can be jumped through from below.
+    Torch = 9,       // Decoration that lights up its surroundings.
+    Sand = 10,       // Solid, but falls and piles up (see SandSimulation.hpp).
+    Water = 11       // Flows down and sideways; the player passes through it.
+};
+
+// Number of possible tile kinds (every value of a byte).
+const int TILE_KIND_COUNT = 256;
+
+// --- Tile Properties ---
+
+// Behaviour flags of a tile kind. A kind can have several (e.g. a solid hazard).
+enum TileFlag : std::uint8_t {
+    TILE_SOLID = 1 << 0,       // Blocks movement from every side.
+    TILE_ONE_WAY = 1 << 1,     // Blocks movement only from above (jump-through platform).
+    TILE_COLLECTIBLE = 1 << 2, // Picked up (and removed) when the player touches it.
+    TILE_HAZARD = 1 << 3,      // Sends the player back to the start when touched.
+    TILE_SLOPE = 1 << 4,       // Stood on along its height profile instead of its top edge.
+    TILE_FALLING = 1 << 5,     // Moved by the sand simulation: falls, and slides off piles.
+    TILE_LIQUID = 1 << 6       // A falling tile that also flows sideways, and that others sink through.
+};
+
+// How a tile kind is drawn.
+enum class TileRenderStyle : std::uint8_t {
+    None,   // Not drawn at all (Air).
+    Square, // Fills the whole tile.
+    Circle, // A circle in the middle of the tile.
+    Spikes,   // A row of triangles along the bottom of the tile.
+    Profile,  // The tile's height profile (e.g. a ramp).
+    Platform  // A thin bar along the top of the tile.
+};
+
+// --- Height Profiles ---
+
+// Shapes of the surfaces the player can stand on. A profile stores the height
+// of the surface above the tile's bottom edge for each of TILE_PROFILE_COLUMNS
+// columns across the tile, in 1/TILE_PROFILE_COLUMNS of a tile. Collision looks
+// the height up in a table instead of testing which kind of slope a tile is.
+const int TILE_PROFILE_COLUMNS = 16;
+
+enum TileProfile : std::uint8_t {
+    PROFILE_NONE,          // Nothing to stand on (Air, coins, ...).
+    PROFILE_FULL,          // Flat top edge (solid squares).
+    PROFILE_RAMP_UP_RIGHT, // Rises from left to right.
+    PROFILE_RAMP_UP_LEFT,  // Rises from right to left.
+    TILE_PROFILE_COUNT
+};
+
+constexpr std::array<std::array<std::uint8_t, TILE_PROFILE_COLUMNS>, TILE_PROFILE_COUNT> makeHeightProfiles() {
+    std::array<std::array<std::uint8_t, TILE_PROFILE_COLUMNS>, TILE_PROFILE_COUNT> profiles{};
+    for (int column = 0; column < TILE_PROFILE_COLUMNS; ++column) {
+        profiles[PROFILE_FULL][column] = TILE_PROFILE_COLUMNS;
+        // Ramps reach full height in their last column, so they join seamlessly
+        // with a solid square (or the next ramp one row up).
+        profiles[PROFILE_RAMP_UP_RIGHT][column] = (std::uint8_t)(column + 1);
+        profiles[PROFILE_RAMP_UP_LEFT][column] = (std::uint8_t)(TILE_PROFILE_COLUMNS - column);
+    }
+    return profiles;
+}
+
+// Surface height per column of every profile, indexed by TileProfile.
+constexpr std::array<std::array<std::uint8_t, TILE_PROFILE_COLUMNS>, TILE_PROFILE_COUNT> TILE_HEIGHT_PROFILES = makeHeightProfiles();
+
+// Everything about one tile kind.
+struct TileDefinition {
+    const char* name = "unused";
+    std::uint8_t flags = 0;
+    TileRenderStyle style = TileRenderStyle::None;
+    sf::Color color = sf::Color(0, 0, 0, 0);
+    char symbol = 0;   // Character used in level files (0 = cannot be saved).
+    int score = 0;     // Points awarded when collected.
+    TileProfile profile = PROFILE_NONE; // Surface the player stands on.
+    std::uint8_t light = 0; // Light level the tile emits (0-15, see LightMap.hpp).
+};
+
+// Builds the definition of every tile kind at compile time. To add a new kind,
+// add a TileType value above and one line here.
+constexpr std::array<TileDefinition, TILE_KIND_COUNT> makeTileDefinitions() {
+    std::array<TileDefinition, TILE_KIND_COUNT> table{};
+    //                    name          flags                       style                      color                        symbol score profile                light
+    table[Air]         = {"air",        0,                          TileRenderStyle::None,     sf::Color(0, 0, 0, 0),       '.',   0,    PROFILE_NONE,          0};
+    table[Solid]       = {"solid",      TILE_SOLID,                 TileRenderStyle::Square,   sf::Color(0, 0, 255),        '#',   0,    PROFILE_FULL,          0};
+    table[Coin]        = {"coin",       TILE_COLLECTIBLE,           TileRenderStyle::Circle,   sf::Color(255, 255, 0),      'o',   1,    PROFILE_NONE,          0};
+    table[Brick]       = {"brick",      TILE_SOLID,                 TileRenderStyle::Square,   sf::Color(170, 90, 50),      'B',   0,    PROFILE_FULL,          0};
+    table[Spikes]      = {"spikes",     TILE_HAZARD,                TileRenderStyle::Spikes,   sf::Color(200, 200, 210),    '^',   0,    PROFILE_NONE,          0};
+    table[Gem]         = {"gem",        TILE_COLLECTIBLE,           TileRenderStyle::Circle,   sf::Color(0, 255, 255),      '*',   5,    PROFILE_NONE,          3};
+    table[RampUpRight] = {"ramp right", TILE_SLOPE,                 TileRenderStyle::Profile,  sf::Color(0, 0, 255),        '/',   0,    PROFILE_RAMP_UP_RIGHT, 0};
+    table[RampUpLeft]  = {"ramp left",  TILE_SLOPE,                 TileRenderStyle::Profile,  sf::Color(0, 0, 255),        '\\',  0,    PROFILE_RAMP_UP_LEFT,  0};
+    table[Platform]    = {"platform",   TILE_ONE_WAY,               TileRenderStyle::Platform, sf::Color(140, 100, 60),     '-',   0,    PROFILE_NONE,          0};
+    table[Torch]       = {"torch",      0,                          TileRenderStyle::Circle,   sf::Color(255, 150, 40),     'i',   0,    PROFILE_NONE,          14};
+    table[Sand]        = {"sand",       TILE_SOLID | TILE_FALLING,  TileRenderStyle::Square,   sf::Color(220, 190, 110),    's',   0,    PROFILE_FULL,          0};
+    table[Water]       = {"water",      TILE_FALLING | TILE_LIQUID, TileRenderStyle::Square,   sf::Color(40, 90, 220, 170), '~',   0,    PROFILE_NONE,          0};
+    return table;
+}
+
+// The full definition of every tile kind, indexed by TileType.
+constexpr std::array<TileDefinition, TILE_KIND_COUNT> TILE_DEFINITIONS = makeTileDefinitions();
+
+// Just the flags of every tile kind, indexed by TileType. This is the table
+// the hot loops (collision, raycasts) use: at 256 bytes it stays in the CPU
+// cache, and a lookup plus a bit test replaces a chain of comparisons.
+constexpr std::array<std::uint8_t, TILE_KIND_COUNT> makeTileFlags() {
+    std::array<std::uint8_t, TILE_KIND_COUNT> flags{};
+    for (int i = 0; i < TILE_KIND_COUNT; ++i) flags[i] = TILE_DEFINITIONS[i].flags;
+    return flags;
+}
+constexpr std::array<std::uint8_t, TILE_KIND_COUNT> TILE_FLAGS = makeTileFlags();
+
+// Just the height profile of every tile kind, indexed by TileType (for the
+// same reason as TILE_FLAGS).
+constexpr std::array<TileProfile, TILE_KIND_COUNT> makeTileProfiles() {
+    std::array<TileProfile, TILE_KIND_COUNT> profiles{};
+    for (int i = 0; i < TILE_KIND_COUNT; ++i) profiles[i] = TILE_DEFINITIONS[i].profile;
+    return profiles;
+}
+constexpr std::array<TileProfile, TILE_KIND_COUNT> TILE_PROFILES = makeTileProfiles();
+
+// Just the emitted light level of every tile kind, indexed by TileType.
+constexpr std::array<std::uint8_t, TILE_KIND_COUNT> makeTileLights() {
+    std::array<std::uint8_t, TILE_KIND_COUNT> lights{};
+    for (int i = 0; i < TILE_KIND_COUNT; ++i) lights[i] = TILE_DEFINITIONS[i].light;
+    return lights;
+}
+constexpr std::array<std::uint8_t, TILE_KIND_COUNT> TILE_LIGHTS = makeTileLights();
+
+// Level file character -> tile kind (Air for characters that mean nothing).
+// `TILE_SYMBOL_VALID` tells real Air ('.') apart from unknown characters.
+constexpr std::array<TileType, 128> makeTilesBySymbol() {
+    std::array<TileType, 128> bySymbol{};
+    for (int i = 0; i < TILE_KIND_COUNT; ++i) {
+        const char symbol = TILE_DEFINITIONS[i].symbol;
+        if (symbol > 0) bySymbol[(unsigned char)symbol] = (TileType)i;
+    }
+    return bySymbol;
+}
+constexpr std::array<TileType, 128> TILES_BY_SYMBOL = makeTilesBySymbol();
+
+constexpr std::array<bool, 128> makeValidSymbols() {
+    std::array<bool, 128> valid{};
+    for (int i = 0; i < TILE_KIND_COUNT; ++i) {
+        const char symbol = TILE_DEFINITIONS[i].symbol;
+        if (symbol > 0) valid[(unsigned char)symbol] = true;
+    }
+    return valid;
+}
+constexpr std::array<bool, 128> TILE_SYMBOL_VALID = makeValidSymbols();
+
+// --- Lookups ---
+
+// True if `tile` has any of the flags in `Flags`. Making the flags a template
+// parameter turns the mask into a constant inside each specialised loop
+// (e.g. tileHas<TILE_SOLID>), so the check compiles to one load and one test.
+template <std::uint8_t Flags>
+constexpr bool tileHas(TileType tile) {
+    return (TILE_FLAGS[tile] & Flags) != 0;
+}
+
+// The same check with the flags chosen at run time.
+constexpr bool tileHasAny(TileType tile, std::uint8_t flags) {
+    return (TILE_FLAGS[tile] & flags) != 0;
+}
+
+// Examples of the tables doing their job, checked by the compiler.
+static_assert(tileHas<TILE_SOLID>(Solid) && !tileHas<TILE_SOLID>(Air), "Solid must block, Air must not");
+static_assert(TILES_BY_SYMBOL['#'] == Solid && TILE_SYMBOL_VALID['.'], "level file symbols");
@@ -0,0 +1,328 @@
+#pragma once
+
+// --- Includes ---
+// The level, the player and its compact state from the snapshot format.
+#include "Level.hpp"
+#include "GameSnapshot.hpp"
+// ByteWriter / ByteReader: varints and zigzag varints.
+#include "NetProtocol.hpp"
+// This header provides std::min and std::max.
+#include <algorithm>
+// This header provides fixed-width integer types.
+#include <cstdint>
+// This header provides std::memcpy, used to get at the bits of the state fields.
+#include <cstring>
+// This header provides std::vector.
+#include <vector>
+
+// --- Time Travel ---
+
+// Records the last few seconds of the game, tick by tick, so a debugging
+// session can pause, step backward and forward through them and look at every
+// recorded tick: when the player clips through a platform, the ticks leading
+// up to it are still there.
+//
+// Every tick costs one record in a byte ring allocated up front:
+//
+//   field mask                     (byte: TICK_* bits below)
+//   input buttons                  (byte: InputButton bits)
+//   each changed player field      (zigzag varint of the change of its bits)
+//   score change                   (zigzag varint, if TICK_SCORE)
+//   tile changes                   (if TICK_TILES: count, then per tile the
+//                                   index change as a zigzag varint and the
+//                                   old and new type as bytes)
+//
+// A player standing still takes two bytes a tick, a running one about eight.
+// Every KEYFRAME_INTERVAL ticks the player and score are written against zero
+// instead of the previous tick, so a tick is decoded from the keyframe before
+// it without going through the whole ring. Tile changes are found by diffing
+// the chunks whose revision moved against a copy of the level, so any edit
+// (pickups, falling sand, ...) is recorded without hooks.
+//
+// When the ring is full the oldest ticks are dropped, up to the next keyframe.
+// Memory is fixed at construction apart from the level copy (one byte per
+// tile); memoryBytes() reports the total.
+//
+// Seeking changes the level and the player to how they were at that tick:
+// tiles are moved backward with the old types of the ticks in between (or
+// forward with the new ones). Seeking back to the newest tick restores the
+// live game exactly, so the game can resume.
+class TickHistory {
+public:
+    // Keyframes this many ticks apart.
+    static constexpr int KEYFRAME_INTERVAL = 60;
+
+    // Everything recorded for one tick, apart from its tile changes.
+    struct TickState {
+        std::uint64_t tick = 0;
+        SnapshotEntity player{};
+        PlayerInput input;
+        std::int32_t score = 0;
+    };
+
+    // Up to `tickCapacity` ticks in at most `byteCapacity` bytes of records.
+    TickHistory(std::size_t byteCapacity, std::size_t tickCapacity)
+        : ring(byteCapacity), scratch(byteCapacity), ticks(tickCapacity) {}
+
+    // Forgets every recorded tick and starts over from `level` (a new or
+    // reloaded level, a quickload).
+    void reset(const Level& level) {
+        clear();
+        shadow = level.tiles;
+        shadowSize = level.size;
+        shadowRevisions = level.chunkRevisions;
+    }
+
+    // Records the state after tick `tick`. Ticks are expected one after the
+    // other; after a gap (or if the level was resized) the history starts
+    // over. The level must be at the newest tick (see seek()).
+    void record(std::uint64_t tick, const Level& level, const SnapshotEntity& player, const PlayerInput& input,
+                std::int32_t score) {
+        if (level.size != shadowSize) reset(level);
+        if (count > 0 && tick != newestTick() + 1) clear();
+
+        const bool keyframe = count == 0 || (tick - lastKeyframeTick) >= (std::uint64_t)KEYFRAME_INTERVAL;
+        const SnapshotEntity base = keyframe ? SnapshotEntity{} : previousPlayer;
+        const std::int32_t baseScore = keyframe ? 0 : previousScore;
+
+        ByteWriter out(scratch.data(), scratch.size());
+        std::uint32_t oldBits[PLAYER_FIELDS], newBits[PLAYER_FIELDS];
+        playerBits(base, oldBits);
+        playerBits(player, newBits);
+        std::uint8_t mask = player.onGround ? TICK_ON_GROUND : 0;
+        for (int field = 0; field < PLAYER_FIELDS; ++field) {
+            if (keyframe || newBits[field] != oldBits[field]) mask |= (std::uint8_t)(1 << field);
+        }
+        if (keyframe || score != baseScore) mask |= TICK_SCORE;
+        const std::size_t maskAt = out.size();
+        out.writeU8(mask);
+        out.writeU8((std::uint8_t)((input.left ? ButtonLeft : 0) | (input.right ? ButtonRight : 0) |
+                                   (input.jump ? ButtonJump : 0)));
+        for (int field = 0; field < PLAYER_FIELDS; ++field) {
+            if (mask & (1 << field)) out.writeSigned((std::int32_t)(newBits[field] - oldBits[field]));
+        }
+        if (mask & TICK_SCORE) out.writeSigned(score - baseScore);
+        if (writeTileChanges(level, out)) scratch[maskAt] |= TICK_TILES;
+
+        previousPlayer = player;
+        previousScore = score;
+        if (keyframe) lastKeyframeTick = tick;
+        if (out.overflow()) {
+            // More changes in one tick than the whole ring holds: nothing
+            // before this tick can be reached any more.
+            clear();
+            return;
+        }
+        store(tick, out.size(), keyframe);
+    }
+
+    // The recorded ticks, oldest to newest (tickCount() == 0: none).
+    std::size_t tickCount() const { return count; }
+    std::uint64_t oldestTick() const { return firstTick; }
+    std::uint64_t newestTick() const { return firstTick + count - 1; }
+    // The tick the level currently shows (the newest unless seeking).
+    std::uint64_t cursorTick() const { return cursor; }
+
+    // Decodes the state after `tick`. Returns false if it isn't recorded.
+    bool readTick(std::uint64_t tick, TickState& state) const {
+        if (count == 0 || tick < firstTick || tick > newestTick()) return false;
+        std::uint64_t t = tick;
+        while (!entryOf(t).keyframe) --t; // The oldest tick is always a keyframe.
+        state = TickState();
+        for (; t <= tick; ++t) {
+            const Entry& entry = entryOf(t);
+            ByteReader in(ring.data() + entry.offset, entry.size);
+            if (entry.keyframe) state = TickState();
+            decodePlayer(in, state);
+        }
+        state.tick = tick;
+        return true;
+    }
+
+    // Moves the level's tiles to how they were after `tick` (clamped to the
+    // recorded ticks) and appends every tile that changed to `changedTiles`,
+    // so lighting and other caches can follow.
+    void seek(std::uint64_t tick, Level& level, std::vector<sf::Vector2i>& changedTiles) {
+        if (count == 0) return;
+        tick = std::max(firstTick, std::min(tick, newestTick()));
+        // Backward: undo the ticks after the target, newest first.
+        for (; cursor > tick; --cursor) applyTileChanges(entryOf(cursor), level, changedTiles, false);
+        // Forward: redo the ticks up to the target.
+        for (; cursor < tick; ++cursor) applyTileChanges(entryOf(cursor + 1), level, changedTiles, true);
+    }
+
+    // Bytes held by the recorded ticks, and what the history occupies in
+    // total (ring, tick index, level copy, scratch space).
+    std::size_t usedBytes() const { return usedRingBytes; }
+    std::size_t memoryBytes() const {
+        return ring.size() + scratch.size() + ticks.size() * sizeof(Entry) + shadow.size() +
+               shadowRevisions.size() * sizeof(unsigned int);
+    }
+
+private:
+    // Bits of the field mask. The first PLAYER_FIELDS bits mark the changed
+    // player fields, in the order of playerBits().
+    static constexpr int PLAYER_FIELDS = 5;
+    static constexpr std::uint8_t TICK_ON_GROUND = 1 << 5;
+    static constexpr std::uint8_t TICK_SCORE = 1 << 6;
+    static constexpr std::uint8_t TICK_TILES = 1 << 7;
+
+    // Where one tick's record is in the ring.
+    struct Entry {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+        bool keyframe = false;
+    };
+
+    std::vector<std::uint8_t> ring;    // The records, oldest overwritten first.
+    std::vector<std::uint8_t> scratch; // The record being written.
+    std::vector<Entry> ticks;          // Ring of entries, one per recorded tick.
+    std::size_t firstEntry = 0;        // Entry of the oldest tick.
+    std::size_t count = 0;             // Recorded ticks.
+    std::uint64_t firstTick = 0;
+    std::uint64_t cursor = 0;
+    std::uint64_t lastKeyframeTick = 0;
+    std::size_t writeOffset = 0;       // Where the next record goes.
+    std::size_t usedRingBytes = 0;
+    SnapshotEntity previousPlayer{};
+    std::int32_t previousScore = 0;
+    // The level as of the newest tick, and the chunk revisions it matches.
+    std::vector<TileType> shadow;
+    sf::Vector2u shadowSize;
+    std::vector<unsigned int> shadowRevisions;
+
+    void clear() {
+        count = 0;
+        firstEntry = 0;
+        writeOffset = 0;
+        usedRingBytes = 0;
+    }
+
+    const Entry& entryOf(std::uint64_t tick) const {
+        return ticks[(firstEntry + (std::size_t)(tick - firstTick)) % ticks.size()];
+    }
+
+    // The player fields as raw bits: the exact values of float or Fixed.
+    static void playerBits(const SnapshotEntity& entity, std::uint32_t* bits) {
+        const PhysicsScalar fields[PLAYER_FIELDS] = {entity.x, entity.y, entity.vx, entity.vy, entity.landingSpeed};
+        static_assert(sizeof(PhysicsScalar) == sizeof(std::uint32_t), "fields are recorded as 32-bit patterns");
+        for (int field = 0; field < PLAYER_FIELDS; ++field) std::memcpy(&bits[field], &fields[field], sizeof(std::uint32_t));
+    }
+
+    // Reads the player part of a record into `state` (on top of the previous
+    // tick's state) and leaves `in` at the tile changes. Returns the mask.
+    static std::uint8_t decodePlayer(ByteReader& in, TickState& state) {
+        const std::uint8_t mask = in.readU8();
+        const std::uint8_t buttons = in.readU8();
+        state.input = {(buttons & ButtonLeft) != 0, (buttons & ButtonRight) != 0, (buttons & ButtonJump) != 0};
+        std::uint32_t bits[PLAYER_FIELDS];
+        playerBits(state.player, bits);
+        for (int field = 0; field < PLAYER_FIELDS; ++field) {
+            if (mask & (1 << field)) bits[field] += (std::uint32_t)in.readSigned();
+        }
+        PhysicsScalar* fields[PLAYER_FIELDS] = {&state.player.x, &state.player.y, &state.player.vx, &state.player.vy,
+                                                &state.player.landingSpeed};
+        for (int field = 0; field < PLAYER_FIELDS; ++field) {
+            std::memcpy(static_cast<void*>(fields[field]), &bits[field], sizeof(std::uint32_t));
+        }
+        state.player.onGround = (mask & TICK_ON_GROUND) ? 1 : 0;
+        if (mask & TICK_SCORE) state.score += in.readSigned();
+        return mask;
+    }
+
+    // Diffs the chunks whose revision changed against the level copy, writes
+    // the changed tiles and updates the copy. Returns false if none changed
+    // (and then writes nothing).
+    bool writeTileChanges(const Level& level, ByteWriter& out) {
+        // Calls fn(index) for every tile that differs from the copy.
+        auto forEachChange = [&](auto&& fn) {
+            for (std::size_t chunk = 0; chunk < shadowRevisions.size(); ++chunk) {
+                if (shadowRevisions[chunk] == level.chunkRevisions[chunk]) continue;
+                const int x0 = (int)(chunk % level.chunkCount.x) * CHUNK_SIZE;
+                const int y0 = (int)(chunk / level.chunkCount.x) * CHUNK_SIZE;
+                const int x1 = std::min(x0 + CHUNK_SIZE, (int)level.size.x);
+                const int y1 = std::min(y0 + CHUNK_SIZE, (int)level.size.y);
+                for (int y = y0; y < y1; ++y) {
+                    for (int x = x0; x < x1; ++x) {
+                        const std::size_t index = (std::size_t)y * level.size.x + x;
+                        if (shadow[index] != level.tiles[index]) fn(index);
+                    }
+                }
+            }
+        };
+        // Count first: the count goes before the changes.
+        std::uint32_t changes = 0;
+        forEachChange([&](std::size_t) { ++changes; });
+        if (changes > 0) {
+            out.writeVarint(changes);
+            std::int64_t previousIndex = 0;
+            forEachChange([&](std::size_t index) {
+                out.writeSigned((std::int32_t)((std::int64_t)index - previousIndex));
+                out.writeU8(shadow[index]);
+                out.writeU8(level.tiles[index]);
+                previousIndex = (std::int64_t)index;
+                shadow[index] = level.tiles[index];
+            });
+        }
+        shadowRevisions = level.chunkRevisions;
+        return changes > 0;
+    }
+
+    // Applies the tile changes of one record: the new types going forward,
+    // the old ones going backward.
+    void applyTileChanges(const Entry& entry, Level& level, std::vector<sf::Vector2i>& changedTiles, bool forward) const {
+        ByteReader in(ring.data() + entry.offset, entry.size);
+        TickState ignored;
+        if ((decodePlayer(in, ignored) & TICK_TILES) == 0) return;
+        const std::uint32_t changes = in.readVarint();
+        std::int64_t index = 0;
+        for (std::uint32_t i = 0; i < changes && in.ok(); ++i) {
+            index += in.readSigned();
+            const TileType before = (TileType)in.readU8();
+            const TileType after = (TileType)in.readU8();
+            const int x = (int)(index % level.size.x), y = (int)(index / level.size.x);
+            level.setTile(x, y, forward ? after : before);
+            changedTiles.push_back({x, y});
+        }
+    }
+
+    // Copies the record in `scratch` into the ring, dropping the oldest ticks
+    // until it fits (and the oldest left is a keyframe).
+    void store(std::uint64_t tick, std::size_t size, bool keyframe) {
+        if (writeOffset + size > ring.size()) {
+            // Wrap around and leave the tail unused. The records from the
+            // write offset to the end of the ring are the oldest ones, and the
+            // newer ones are at the front, where this record goes: the tail's
+            // records have to go first, before any at the front can.
+            while (count > 0 && ticks[firstEntry].offset >= writeOffset) dropOldest();
+            writeOffset = 0;
+        }
+        if (count == ticks.size()) dropOldest();
+        while (count > 0 && overlapsOldest(writeOffset, size)) dropOldest();
+        while (count > 0 && !ticks[firstEntry].keyframe) dropOldest();
+        if (count == 0) {
+            // Only a keyframe can start the history.
+            if (!keyframe) return;
+            firstTick = tick;
+            firstEntry = 0;
+        }
+        std::memcpy(ring.data() + writeOffset, scratch.data(), size);
+        ticks[(firstEntry + count) % ticks.size()] = {(std::uint32_t)writeOffset, (std::uint32_t)size, keyframe};
+        ++count;
+        writeOffset += size;
+        usedRingBytes += size;
+        cursor = tick;
+    }
+
+    bool overlapsOldest(std::size_t offset, std::size_t size) const {
+        const Entry& oldest = ticks[firstEntry];
+        return offset < oldest.offset + oldest.size && oldest.offset < offset + size;
+    }
+
+    void dropOldest() {
+        usedRingBytes -= ticks[firstEntry].size;
+        firstEntry = (firstEntry + 1) % ticks.size();
+        ++firstTick;
+        --count;
+    }
+};
@@ -0,0 +1,292 @@
+#pragma once
+
+// --- Includes ---
+// HeapTagScope, which charges the ring buffers to HeapTag::Tracing.
+#include "HeapStats.hpp"
+// This header provides std::min.
+#include <algorithm>
+// This header provides std::atomic for the ring buffers' write positions.
+#include <atomic>
+// This header provides std::chrono::steady_clock for the timestamps.
+#include <chrono>
+// This header provides fixed-width integer types.
+#include <cstdint>
+// This header provides std::snprintf, used to format the JSON output.
+#include <cstdio>
+// This header provides std::filesystem::path.
+#include <filesystem>
+// This header provides std::ofstream.
+#include <fstream>
+// This header provides std::unique_ptr; buffers never move once created.
+#include <memory>
+// This header provides std::mutex, taken only when a thread records its first event.
+#include <mutex>
+// This header provides std::string.
+#include <string>
+// This header provides std::vector.
+#include <vector>
+
+// --- Frame and Job Tracing ---
+
+// Records how long the stages of each frame and the jobs on worker threads
+// take, and writes them out as a Chrome Trace Event file (trace.json), which
+// chrome://tracing, Perfetto (ui.perfetto.dev) and Speedscope open as a
+// timeline with one row per thread.
+//
+// Code marks what to measure with the macros at the end of this file:
+//
+//     TRACE_SCOPE("lighting");          // From here to the end of the block.
+//
+//     TRACE_STAGES(frame);              // Consecutive stages of one block:
+//     TRACE_STAGE(frame, "physics");    // each ends the one before it.
+//     TRACE_STAGE(frame, "draw");
+//
+// Every thread writes to its own ring buffer of the last TRACE_BUFFER_EVENTS
+// spans, so recording takes no lock and never allocates (after a thread's
+// first span): two clock reads and three stores. A thread's buffer goes to
+// the next new thread when it exits, so short-lived threads don't add up.
+// Tracing is always on, like a flight recorder; saveChromeTrace() writes out
+// whatever the rings hold when asked (the game does it on F6), covering the
+// last half minute or so.
+//
+// Names must be string literals (or otherwise live forever): only the pointer
+// is stored. Configuring with PLATFORMER_TRACE=OFF defines PLATFORMER_NO_TRACE,
+// which compiles the macros to nothing.
+
+// Spans kept per thread (a power of two). The game's main thread records
+// about ten per frame, so this holds roughly half a minute at 60 frames/second.
+const std::size_t TRACE_BUFFER_EVENTS = 1 << 14;
+
+// One measured span. Times are nanoseconds since the process started tracing.
+struct TraceEvent {
+    const char* name = nullptr;
+    std::int64_t start = 0;
+    std::int64_t duration = 0;
+};
+
+// The ring buffer of one thread. Only that thread writes; saveChromeTrace()
+// reads it from another thread.
+class TraceThreadBuffer {
+public:
+    TraceThreadBuffer(unsigned int threadId) : id(threadId), events(TRACE_BUFFER_EVENTS) {}
+
+    void record(const char* name, std::int64_t start, std::int64_t end) {
+        const std::uint64_t index = written.load(std::memory_order_relaxed);
+        events[index & (TRACE_BUFFER_EVENTS - 1)] = {name, start, end - start};
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    // Names the thread in the trace viewer (e.g. "main", "worker").
+    void setName(const char* threadName) {
+        name.store(threadName, std::memory_order_release);
+    }
+
+    // Appends the spans in the buffer to `out`, oldest first. The owner keeps
+    // writing meanwhile, so spans it may have overwritten during the copy are
+    // dropped rather than reported torn.
+    void copyTo(std::vector<TraceEvent>& out) const {
+        const std::uint64_t end = written.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > TRACE_BUFFER_EVENTS ? end - TRACE_BUFFER_EVENTS : 0;
+        const std::size_t first = out.size();
+        for (std::uint64_t i = begin; i < end; ++i) out.push_back(events[i & (TRACE_BUFFER_EVENTS - 1)]);
+        // Slots below `after + 1 - TRACE_BUFFER_EVENTS` were (or are being) reused.
+        const std::uint64_t after = written.load(std::memory_order_acquire);
+        const std::uint64_t valid = after + 1 > TRACE_BUFFER_EVENTS ? after + 1 - TRACE_BUFFER_EVENTS : 0;
+        if (valid > begin) out.erase(out.begin() + first, out.begin() + first + (std::size_t)std::min(valid - begin, end - begin));
+    }
+
+    unsigned int threadId() const { return id; }
+    const char* threadName() const { return name.load(std::memory_order_acquire); }
+
+private:
+    friend class TraceRegistry;
+
+    unsigned int id;
+    bool inUse = true; // Whether a running thread owns it (guarded by the registry's mutex).
+    std::atomic<const char*> name{nullptr};
+    std::vector<TraceEvent> events;
+    std::atomic<std::uint64_t> written{0}; // Spans recorded so far.
+};
+
+// Owns every thread's buffer. Buffers outlive their threads, so the spans of
+// a finished job (like a level reload thread) can still be saved. When a
+// thread exits, its buffer goes to the next thread that starts recording,
+// which carries on in the same ring (under the same id in the trace, where the
+// two threads' spans never overlap in time). So threads that come and go, like
+// the level reload and asset loading threads, share a few buffers instead of
+// adding one each.
+class TraceRegistry {
+public:
+    static TraceRegistry& instance() {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    // A buffer for the calling thread: one a finished thread handed back, or
+    // a new one.
+    TraceThreadBuffer* acquireBuffer() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<TraceThreadBuffer>& buffer : buffers) {
+            if (!buffer->inUse) {
+                buffer->inUse = true;
+                return buffer.get();
+            }
+        }
+        HeapTagScope heapTag(HeapTag::Tracing);
+        buffers.push_back(std::make_unique<TraceThreadBuffer>((unsigned int)buffers.size() + 1));
+        return buffers.back().get();
+    }
+
+    // Hands back the buffer of a thread that is exiting; its spans stay.
+    void releaseBuffer(TraceThreadBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer->inUse = false;
+    }
+
+    // Nanoseconds since tracing started.
+    std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // Calls fn(buffer) for every thread's buffer.
+    template <typename Fn>
+    void forEachBuffer(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<TraceThreadBuffer>& buffer : buffers) fn(*buffer);
+    }
+
+private:
+    TraceRegistry() : epoch(std::chrono::steady_clock::now()) {}
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceThreadBuffer>> buffers;
+    std::chrono::steady_clock::time_point epoch;
+};
+
+// Holds the calling thread's buffer and hands it back when the thread exits.
+struct TraceBufferOwner {
+    TraceThreadBuffer* buffer = TraceRegistry::instance().acquireBuffer();
+    ~TraceBufferOwner() { TraceRegistry::instance().releaseBuffer(buffer); }
+};
+
+// The calling thread's buffer, acquired on its first use.
+inline TraceThreadBuffer& traceThreadBuffer() {
+    thread_local TraceBufferOwner owner;
+    return *owner.buffer;
+}
+
+inline std::int64_t traceNow() {
+    return TraceRegistry::instance().now();
+}
+
+// Measures from construction to destruction (TRACE_SCOPE).
+class TraceScope {
+public:
+    explicit TraceScope(const char* scopeName) : name(scopeName), start(traceNow()) {}
+    ~TraceScope() { traceThreadBuffer().record(name, start, traceNow()); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    std::int64_t start;
+};
+
+// Measures consecutive stages (TRACE_STAGES / TRACE_STAGE): beginning a stage
+// ends the current one; the last one ends with the block. One clock read
+// serves as the end of one stage and the start of the next.
+class TraceStages {
+public:
+    TraceStages() = default;
+    ~TraceStages() {
+        if (name != nullptr) traceThreadBuffer().record(name, start, traceNow());
+    }
+    TraceStages(const TraceStages&) = delete;
+    TraceStages& operator=(const TraceStages&) = delete;
+
+    void begin(const char* stageName) {
+        const std::int64_t now = traceNow();
+        if (name != nullptr) traceThreadBuffer().record(name, start, now);
+        name = stageName;
+        start = now;
+    }
+
+private:
+    const char* name = nullptr;
+    std::int64_t start = 0;
+};
+
+// --- Chrome Trace Export ---
+
+// Writes every span still in the ring buffers to `path` in the Chrome Trace
+// Event format (complete "X" events, plus the thread names). Other threads
+// may keep recording meanwhile. On success `eventCount` receives the number
+// of spans written; on failure returns false and describes the problem in
+// `error`.
+inline bool saveChromeTrace(const std::filesystem::path& path, std::size_t& eventCount, std::string& error) {
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::vector<TraceEvent> events;
+    char line[256];
+    bool first = true;
+    auto appendEscaped = [&json](const char* text) {
+        for (; *text != '\0'; ++text) {
+            if (*text == '"' || *text == '\\') json += '\\';
+            json += *text;
+        }
+    };
+    eventCount = 0;
+    TraceRegistry::instance().forEachBuffer([&](const TraceThreadBuffer& buffer) {
+        if (const char* threadName = buffer.threadName()) {
+            json += first ? "" : ",\n";
+            first = false;
+            std::snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                          buffer.threadId());
+            json += line;
+            appendEscaped(threadName);
+            json += "\"}}";
+        }
+        events.clear();
+        buffer.copyTo(events);
+        for (const TraceEvent& event : events) {
+            json += first ? "" : ",\n";
+            first = false;
+            json += "{\"ph\":\"X\",\"name\":\"";
+            appendEscaped(event.name);
+            // Microseconds with nanosecond digits, as the format expects.
+            std::snprintf(line, sizeof(line), "\",\"pid\":1,\"tid\":%u,\"ts\":%lld.%03lld,\"dur\":%lld.%03lld}", buffer.threadId(),
+                          (long long)(event.start / 1000), (long long)(event.start % 1000),
+                          (long long)(event.duration / 1000), (long long)(event.duration % 1000));
+            json += line;
+        }
+        eventCount += events.size();
+    });
+    json += "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file || !file.write(json.data(), (std::streamsize)json.size())) {
+        error = "could not write '" + path.string() + "'";
+        return false;
+    }
+    return true;
+}
+
+// --- Instrumentation Macros ---
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifndef PLATFORMER_NO_TRACE
+// Measures the rest of the enclosing block as a span called `name`.
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+// Declares `stages`, a sequence of spans ended by the next TRACE_STAGE.
+#define TRACE_STAGES(stages) TraceStages stages
+// Ends the current stage of `stages` (if any) and begins one called `name`.
+#define TRACE_STAGE(stages, name) (stages).begin(name)
+// Names the calling thread in the trace.
+#define TRACE_THREAD_NAME(name) traceThreadBuffer().setName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_STAGES(stages) ((void)0)
+#define TRACE_STAGE(stages, name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
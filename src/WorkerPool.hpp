@@ -0,0 +1,119 @@
+#pragma once
+
+// --- Includes ---
+// TRACE_SCOPE, which shows each thread's share of a job in traces.
+#include "Trace.hpp"
+// HeapTagScope, which charges a job's allocations to the caller's subsystem.
+#include "HeapStats.hpp"
+// This header provides std::max.
+#include <algorithm>
+// This header provides std::atomic for the shared work index.
+#include <atomic>
+// This header provides std::condition_variable, which parks idle workers.
+#include <condition_variable>
+// This header provides std::size_t.
+#include <cstddef>
+// This header provides std::function, which holds the current job.
+#include <functional>
+// This header provides std::mutex and std::unique_lock.
+#include <mutex>
+// This header provides std::thread.
+#include <thread>
+// This header provides std::vector.
+#include <vector>
+
+// --- Worker Pool ---
+
+// A fixed set of threads for fork-join loops that run every tick. Starting
+// threads (or std::async tasks) costs tens of microseconds each time; these
+// are started once and wait between jobs.
+//
+// parallelFor(count, fn) calls fn(0) ... fn(count - 1) spread over the workers
+// and the calling thread, and returns when all calls have finished. Indices
+// are handed out one at a time, so uneven work balances itself. In a trace
+// (Trace.hpp) every thread's part of the job is one span named `traceName`,
+// and the workers' heap allocations are charged to the caller's HeapTag.
+class WorkerPool {
+public:
+    // `threadCount` includes the calling thread; 0 means one per CPU core.
+    explicit WorkerPool(unsigned int threadCount = 0) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 1; i < threadCount; ++i) workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Number of threads that run jobs, including the caller.
+    unsigned int threadCount() const { return (unsigned int)workers.size() + 1; }
+
+    template <typename Fn>
+    void parallelFor(std::size_t count, Fn&& fn, const char* traceName = "parallelFor") {
+        if (count == 0) return;
+        if (workers.empty() || count == 1) {
+            TRACE_SCOPE(traceName);
+            for (std::size_t i = 0; i < count; ++i) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [&fn](std::size_t i) { fn(i); };
+            jobName = traceName;
+            jobHeapTag = currentHeapTag;
+            jobSize = count;
+            nextIndex.store(0, std::memory_order_relaxed);
+            busyWorkers = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        runIndices();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return busyWorkers == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;     // A new job (or shutdown).
+    std::condition_variable finished; // The last worker finished the job.
+    std::function<void(std::size_t)> job;
+    const char* jobName = nullptr;
+    HeapTag jobHeapTag = HeapTag::Other;
+    std::size_t jobSize = 0;
+    std::atomic<std::size_t> nextIndex{0};
+    std::size_t busyWorkers = 0;
+    unsigned long long generation = 0;
+    bool stopping = false;
+
+    void runIndices() {
+        TRACE_SCOPE(jobName);
+        HeapTagScope heapTag(jobHeapTag);
+        for (std::size_t i = nextIndex.fetch_add(1); i < jobSize; i = nextIndex.fetch_add(1)) job(i);
+    }
+
+    void workerLoop() {
+        TRACE_THREAD_NAME("worker");
+        unsigned long long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            runIndices();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+};
@@ -0,0 +1,1392 @@
+// --- Benchmark Program ---
+// A standalone executable that measures the performance-sensitive parts of the
+// game on large generated levels, without opening a window.
+// Build it in Release mode and run `bench` to run everything, or `bench <name>`
+// to run a single benchmark (e.g. `bench raycast`).
+
+// --- Includes ---
+// Our own headers for the systems being measured.
+#include "Level.hpp"
+#include "Raycast.hpp"
+#include "Particles.hpp"
+#include "Player.hpp"
+#include "ChunkedWorld.hpp"
+#include "RleLevel.hpp"
+#include "LevelRenderCache.hpp"
+#include "GameSnapshot.hpp"
+#include "Rollback.hpp"
+#include "LightMap.hpp"
+#include "SandSimulation.hpp"
+#include "LevelMipmap.hpp"
+#include "Trace.hpp"
+#include "TimeTravel.hpp"
+#include "SpriteAnimation.hpp"
+#include "ParallaxBackground.hpp"
+// This header provides std::chrono::steady_clock for timing.
+#include <chrono>
+// This header provides std::async and std::future, which overlap the startup stages.
+#include <future>
+// This header provides std::printf, used for compact, aligned result tables.
+#include <cstdio>
+// This header provides std::strcmp, used to match the benchmark name argument.
+#include <cstring>
+// This header provides std::filesystem::temp_directory_path for the trace file.
+#include <filesystem>
+// This header provides std::mt19937 and distributions for reproducible random data.
+#include <random>
+// This header provides std::thread::hardware_concurrency.
+#include <thread>
+// This header provides std::pair.
+#include <utility>
+// This header provides std::vector.
+#include <vector>
+
+// --- Helpers ---
+
+// Returns the seconds elapsed since `start`.
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Generates a large level that looks like our hand-made maps scaled up:
+// mostly open sky, a rolling ground line, scattered floating platforms,
+// some walls and a sprinkling of coins. The same seed always produces the
+// same level, so results are comparable between runs.
+static Level createGeneratedLevel(unsigned int width, unsigned int height, unsigned int seed) {
+    Level level;
+    level.resize({width, height});
+    std::mt19937 rng(seed);
+
+    // Ground: a random walk that stays in the lower third of the map.
+    int ground = (int)height - (int)height / 6;
+    for (int x = 0; x < (int)width; ++x) {
+        ground += (int)(rng() % 3) - 1;
+        ground = std::clamp(ground, (int)height * 2 / 3, (int)height - 2);
+        for (int y = ground; y < (int)height; ++y) level.setTile(x, y, Solid);
+    }
+    // Floating platforms of 3-8 tiles, one for roughly every 40 tiles of area / 10.
+    const unsigned int platformCount = width * height / 400;
+    for (unsigned int i = 0; i < platformCount; ++i) {
+        int px = (int)(rng() % width);
+        int py = (int)(rng() % (height * 2 / 3));
+        int length = 3 + (int)(rng() % 6);
+        for (int x = px; x < px + length; ++x) level.setTile(x, py, Solid);
+        if (rng() % 4 == 0) level.setTile(px + length / 2, py - 1, Coin);
+    }
+    // A few vertical walls.
+    for (unsigned int i = 0; i < width / 32; ++i) {
+        int wx = (int)(rng() % width);
+        int top = (int)(rng() % height);
+        for (int y = top; y < top + 6; ++y) level.setTile(wx, y, Solid);
+    }
+    return level;
+}
+
+// --- Raycasting ---
+
+// Measures single-ray and batched DDA raycasts (Raycast.hpp) with a mix of
+// short line-of-sight style rays and long rays that cross most of the map.
+static void benchRaycast() {
+    const Level level = createGeneratedLevel(4096, 1024, 1234);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> posX(0.f, level.sizePixels.x);
+    std::uniform_real_distribution<float> posY(0.f, level.sizePixels.y);
+    std::uniform_real_distribution<float> offset(-600.f, 600.f);
+
+    // Build the two ray sets in a shuffled order, like gameplay code would submit them.
+    const std::size_t rayCount = 200000;
+    std::vector<Ray> shortRays(rayCount);
+    std::vector<Ray> longRays(rayCount);
+    for (std::size_t i = 0; i < rayCount; ++i) {
+        sf::Vector2f start = {posX(rng), posY(rng)};
+        shortRays[i] = {start, start + sf::Vector2f(offset(rng), offset(rng))};
+        longRays[i] = {start, {posX(rng), posY(rng)}};
+    }
+
+    std::printf("raycast: level %ux%u tiles, %zu rays per set\n", level.size.x, level.size.y, rayCount);
+    std::printf("  %-8s %-8s %14s %10s\n", "set", "mode", "rays/sec", "hits");
+
+    const Ray* sets[2] = {shortRays.data(), longRays.data()};
+    const char* setNames[2] = {"short", "long"};
+    RaycastBatch batch;
+    for (int s = 0; s < 2; ++s) {
+        // One ray at a time, in submission order.
+        std::size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < rayCount; ++i) {
+            hits += raycastLevel(level, sets[s][i].from, sets[s][i].to).hit ? 1 : 0;
+        }
+        double elapsed = secondsSince(start);
+        std::printf("  %-8s %-8s %14.0f %10zu\n", setNames[s], "single", rayCount / elapsed, hits);
+
+        // The whole set in one batched call. The batch is run once untimed
+        // first, like a batch reused every frame whose buffers are already
+        // grown; filling the input buffer is not timed either.
+        batch.clear();
+        batch.rays.assign(sets[s], sets[s] + rayCount);
+        batch.run(level);
+        start = std::chrono::steady_clock::now();
+        batch.run(level);
+        elapsed = secondsSince(start);
+        hits = 0;
+        for (const RaycastHit& hit : batch.hits) hits += hit.hit ? 1 : 0;
+        std::printf("  %-8s %-8s %14.0f %10zu\n", setNames[s], "batched", rayCount / elapsed, hits);
+    }
+}
+
+// --- Particles ---
+
+// Measures one frame of the particle system (update + vertex batch build) with
+// about 200,000 live particles, continuously replenished like a busy scene.
+static void benchParticles() {
+    const std::size_t target = 200000;
+    ParticleSystem particles(target);
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+
+    ParticleBurst burst;
+    burst.count = 2000;
+    burst.minLifetime = 90.f;
+    burst.maxLifetime = 110.f;
+    burst.spread = 6.2831853f;
+
+    // Fill the pools up to the target before measuring.
+    while (particles.size() + (std::size_t)burst.count <= target) {
+        burst.position = {(float)(particles.size() % 4000), 300.f};
+        particles.emit(burst);
+    }
+
+    const int frames = 300;
+    double updateSeconds = 0.0;
+    double buildSeconds = 0.0;
+    std::size_t liveSum = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        // Top the pools back up to the target (not timed; gameplay emits far
+        // fewer particles per frame).
+        burst.position = {(float)(frame * 13 % 4000), 300.f};
+        burst.count = (int)(target - particles.size());
+        particles.emit(burst);
+
+        auto start = std::chrono::steady_clock::now();
+        particles.update();
+        updateSeconds += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        particles.buildVertices(vertices);
+        buildSeconds += secondsSince(start);
+        liveSum += particles.size();
+    }
+    const double updateMs = updateSeconds * 1000.0 / frames;
+    const double buildMs = buildSeconds * 1000.0 / frames;
+    std::printf("particles: %zu live on average over %d frames\n", liveSum / frames, frames);
+    std::printf("  update       %8.3f ms/frame\n", updateMs);
+    std::printf("  vertex build %8.3f ms/frame\n", buildMs);
+    std::printf("  total        %8.3f ms/frame (60 FPS budget: 16.667 ms)\n", updateMs + buildMs);
+}
+
+// --- Sprite Animation ---
+
+// Animates many characters at once, each switching between the idle, run,
+// jump and fall clips every now and then, and builds their vertex batch.
+static void benchSprites() {
+    const std::size_t spriteCount = 100000;
+    AnimationLibrary library;
+    const CharacterClips clips = addCharacterClips(library);
+    const std::uint16_t clipList[4] = {clips.idle, clips.run, clips.jump, clips.fall};
+    SpriteAnimator sprites(library, spriteCount);
+    std::mt19937 rng(42);
+    for (std::size_t i = 0; i < spriteCount; ++i) {
+        sprites.add(clipList[rng() % 4], {(float)(rng() % 4000), (float)(rng() % 1000)}, {16.f, 19.f});
+    }
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+
+    const int frames = 300;
+    double updateSeconds = 0.0;
+    double buildSeconds = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        // About one character in fifty changes state every tick (not timed).
+        for (std::size_t n = 0; n < spriteCount / 50; ++n) sprites.play(rng() % spriteCount, clipList[rng() % 4]);
+
+        auto start = std::chrono::steady_clock::now();
+        sprites.update();
+        updateSeconds += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        sprites.buildVertices(vertices);
+        buildSeconds += secondsSince(start);
+    }
+    const double updateMs = updateSeconds * 1000.0 / frames;
+    const double buildMs = buildSeconds * 1000.0 / frames;
+    std::printf("sprites: %zu animated sprites, %zu clips, %d frames\n", sprites.size(), library.clipCount(), frames);
+    std::printf("  update       %8.3f ms/frame\n", updateMs);
+    std::printf("  vertex build %8.3f ms/frame (%.1f ns per sprite)\n", buildMs, buildMs * 1e6 / spriteCount);
+}
+
+// --- Collision ---
+
+// Turns the steps of a generated level's ground line into ramps and its
+// floating platforms into one-way platforms, so collision can be measured on
+// the same layout with and without those tile kinds.
+static void addSlopesAndPlatforms(Level& level) {
+    const int width = (int)level.size.x;
+    const int height = (int)level.size.y;
+    // Ground top of every column: the first Solid from the bottom up with Air above.
+    std::vector<int> groundTop(width, height);
+    for (int x = 0; x < width; ++x) {
+        int y = height - 1;
+        while (y > 0 && level.getTile(x, y - 1) == Solid) --y;
+        groundTop[x] = y;
+    }
+    for (int x = 0; x + 1 < width; ++x) {
+        if (groundTop[x + 1] == groundTop[x] - 1 && level.getTile(x, groundTop[x] - 1) == Air) {
+            level.setTile(x, groundTop[x] - 1, RampUpRight);        // Ground steps up to the right.
+        } else if (groundTop[x + 1] == groundTop[x] + 1 && level.getTile(x + 1, groundTop[x]) == Air) {
+            level.setTile(x + 1, groundTop[x], RampUpLeft);         // Ground steps down to the right.
+        }
+    }
+    // Floating platforms: solid tiles with air above and below.
+    for (int y = 1; y + 1 < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (level.getTile(x, y) == Solid && level.getTile(x, y - 1) != Solid && level.getTile(x, y + 1) == Air) {
+                level.setTile(x, y, Platform);
+            }
+        }
+    }
+}
+
+// Runs `playerCount` players with random inputs around `level` for `frames`
+// frames and returns the average cost of one Player::step in nanoseconds.
+template <typename LevelT>
+static double timePlayerSteps(const LevelT& level, int playerCount, int frames) {
+    std::mt19937 rng(99);
+    std::vector<Player> players;
+    std::vector<PlayerInput> inputs(playerCount);
+    players.reserve(playerCount);
+    for (int i = 0; i < playerCount; ++i) {
+        const float x = (float)(rng() % (level.size.x - 2) + 1) * TILE_SIZE;
+        players.emplace_back(sf::Vector2f(x, TILE_SIZE * 2.f));
+    }
+    double seconds = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        // Change each player's buttons now and then, like a restless player (not timed).
+        for (PlayerInput& input : inputs) {
+            if (rng() % 30 == 0) {
+                const unsigned int buttons = rng();
+                input.left = (buttons & 1) != 0;
+                input.right = (buttons & 2) != 0;
+                input.jump = (buttons & 4) != 0;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < playerCount; ++i) players[i].step(inputs[i], level);
+        seconds += secondsSince(start);
+    }
+    return seconds * 1e9 / ((double)playerCount * frames);
+}
+
+// Measures Player::step (gravity + collision) on a generated level made of
+// square tiles only, and on the same level with ramps and one-way platforms.
+static void benchCollision() {
+    const Level squares = createGeneratedLevel(4096, 1024, 1234);
+    Level slopes = squares;
+    addSlopesAndPlatforms(slopes);
+    std::size_t rampCount = 0, platformCount = 0;
+    for (TileType tile : slopes.tiles) {
+        if (tileHas<TILE_SLOPE>(tile)) ++rampCount;
+        if (tileHas<TILE_ONE_WAY>(tile)) ++platformCount;
+    }
+
+    const int playerCount = 4000;
+    const int frames = 600;
+    const double squareNs = timePlayerSteps(squares, playerCount, frames);
+    const double slopeNs = timePlayerSteps(slopes, playerCount, frames);
+    std::printf("collision: %d players x %d frames (%zu ramps, %zu platform tiles)\n",
+                playerCount, frames, rampCount, platformCount);
+    std::printf("  squares only          %8.1f ns/step\n", squareNs);
+    std::printf("  ramps + platforms     %8.1f ns/step (%+.1f%%)\n", slopeNs, (slopeNs / squareNs - 1.0) * 100.0);
+    const RleLevel slopesRle = rleFromLevel(slopes);
+    const double rleNs = timePlayerSteps(slopesRle, playerCount, frames);
+    std::printf("  same, RLE rows        %8.1f ns/step (%+.1f%%)\n", rleNs, (rleNs / squareNs - 1.0) * 100.0);
+}
+
+// --- World Storage ---
+
+// Generates a sky-heavy map: floating islands and platforms scattered over a
+// large area with a thin floor at the bottom, like our hand-made levels with
+// much more sky.
+static Level createSkyLevel(unsigned int width, unsigned int height, unsigned int seed) {
+    Level level;
+    level.resize({width, height});
+    std::mt19937 rng(seed);
+    for (unsigned int x = 0; x < width; ++x) level.setTile((int)x, (int)height - 1, Solid);
+    const unsigned int platformCount = width * height / 3000;
+    for (unsigned int i = 0; i < platformCount; ++i) {
+        int px = (int)(rng() % width);
+        int py = (int)(rng() % (height - 4));
+        int length = 3 + (int)(rng() % 6);
+        for (int x = px; x < px + length; ++x) level.setTile(x, py, Solid);
+        if (rng() % 4 == 0) level.setTile(px + length / 2, py - 1, Coin);
+    }
+    // A few larger islands, 6-20 tiles wide and 2-5 deep.
+    for (unsigned int i = 0; i < width * height / 40000; ++i) {
+        int ix = (int)(rng() % width);
+        int iy = (int)(rng() % (height - 8));
+        int w = 6 + (int)(rng() % 15);
+        int h = 2 + (int)(rng() % 4);
+        for (int y = iy; y < iy + h; ++y) {
+            for (int x = ix + (y - iy); x < ix + w - (y - iy); ++x) level.setTile(x, y, Solid);
+        }
+    }
+    return level;
+}
+
+// Walks `count` tile reads along random short paths (the access pattern of
+// collision and raycasts) and returns the average nanoseconds per read. The
+// sum of the tiles is returned through `checksum` so the reads aren't optimised out.
+template <typename World>
+static double timeTileReads(const World& world, sf::Vector2i origin, sf::Vector2u size, std::size_t count, unsigned int& checksum) {
+    std::mt19937 rng(5);
+    unsigned int sum = 0;
+    int x = 0, y = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        if ((i & 63) == 0) {
+            x = (int)(rng() % size.x);
+            y = (int)(rng() % size.y);
+        }
+        // Step to a neighbouring tile, staying inside the map.
+        x = std::clamp(x + (int)(i & 1) - (int)((i >> 3) & 1), 0, (int)size.x - 1);
+        y = std::clamp(y + (int)((i >> 1) & 1) - (int)((i >> 4) & 1), 0, (int)size.y - 1);
+        sum += world.getTile(origin.x + x, origin.y + y);
+    }
+    const double seconds = secondsSince(start);
+    checksum += sum;
+    return seconds * 1e9 / (double)count;
+}
+
+// Compares the dense Level grid with the sparse ChunkedWorld: memory per
+// non-empty tile and the cost of reading tiles, on our map shapes.
+static void benchWorld() {
+    struct Map {
+        const char* name;
+        Level level;
+    };
+    Map maps[] = {
+        {"simple 40x15", createSimpleLevel()},
+        {"ground 4096x1024", createGeneratedLevel(4096, 1024, 1234)},
+        {"sky 8192x4096", createSkyLevel(8192, 4096, 77)},
+    };
+    std::printf("world storage: dense Level vs sparse ChunkedWorld\n");
+    std::printf("  %-18s %10s %12s %12s %10s %10s %10s\n", "map", "tiles", "dense B/t", "chunked B/t", "chunks", "dense ns", "chunk ns");
+    unsigned int checksum = 0;
+    for (Map& map : maps) {
+        const Level& level = map.level;
+        // Place the map around the origin so the world has negative coordinates too.
+        const sf::Vector2i origin = {-(int)level.size.x / 2, -(int)level.size.y / 2};
+        const ChunkedWorld world = worldFromLevel(level, origin);
+        const std::size_t nonAir = world.nonAirTiles();
+        const std::size_t denseBytes = level.tiles.size() * sizeof(TileType) + level.chunkRevisions.size() * sizeof(unsigned int);
+
+        const std::size_t reads = 20000000;
+        const double denseNs = timeTileReads(level, {0, 0}, level.size, reads, checksum);
+        const double chunkedNs = timeTileReads(world, origin, level.size, reads, checksum);
+        std::printf("  %-18s %10zu %12.2f %12.2f %10zu %10.2f %10.2f\n", map.name, nonAir,
+                    (double)denseBytes / nonAir, (double)world.memoryBytes() / nonAir, world.chunkCount(), denseNs, chunkedNs);
+    }
+    std::printf("  (tiles = non-empty tiles; B/t = bytes per non-empty tile; ns per getTile on short random walks; checksum %u)\n", checksum);
+}
+
+// --- RLE Rows ---
+
+// Counts the non-Air tiles of a level by walking every row run by run, and
+// returns the milliseconds it took (averaged over `repeats` scans).
+template <typename LevelT>
+static double timeRowScan(const LevelT& level, int repeats, std::size_t& nonAir) {
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < repeats; ++repeat) {
+        nonAir = 0;
+        for (int y = 0; y < (int)level.size.y; ++y) {
+            forEachTileRun(level, y, 0, (int)level.size.x, [&](int begin, int end, TileType type) {
+                if (type != Air) nonAir += (std::size_t)(end - begin);
+            });
+        }
+    }
+    return secondsSince(start) * 1000.0 / repeats;
+}
+
+// Builds the render batches of every chunk and returns the milliseconds it took.
+template <typename LevelT>
+static double timeChunkBuild(const LevelT& level) {
+    LevelRenderCache cache;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int cy = 0; cy < level.chunkCount.y; ++cy) {
+        for (unsigned int cx = 0; cx < level.chunkCount.x; ++cx) cache.getChunk(level, (int)cx, (int)cy);
+    }
+    return secondsSince(start) * 1000.0;
+}
+
+// Compares the dense grid with run-length encoded rows: memory, full row
+// scans, rebuilding every render chunk, and single-tile reads.
+static void benchRle() {
+    struct Map {
+        const char* name;
+        Level level;
+    };
+    Map maps[] = {
+        {"simple 40x15", createSimpleLevel()},
+        {"ground 4096x1024", createGeneratedLevel(4096, 1024, 1234)},
+        {"sky 8192x4096", createSkyLevel(8192, 4096, 77)},
+    };
+    std::printf("rle rows: dense Level vs RleLevel (time: dense / rle)\n");
+    std::printf("  %-18s %9s %11s %11s %17s %17s %15s\n", "map", "runs", "dense KiB", "rle KiB", "row scan ms", "chunk build ms", "getTile ns");
+    unsigned int checksum = 0;
+    for (Map& map : maps) {
+        const Level& level = map.level;
+        const RleLevel rle = rleFromLevel(level);
+        const std::size_t denseBytes = level.tiles.capacity() * sizeof(TileType) + level.chunkRevisions.capacity() * sizeof(unsigned int);
+        const int repeats = level.tiles.size() < 100000 ? 1000 : 5;
+        std::size_t denseCount = 0, rleCount = 0;
+        const double denseScan = timeRowScan(level, repeats, denseCount);
+        const double rleScan = timeRowScan(rle, repeats, rleCount);
+        const double denseBuild = timeChunkBuild(level);
+        const double rleBuild = timeChunkBuild(rle);
+        const std::size_t reads = 5000000;
+        const double denseNs = timeTileReads(level, {0, 0}, level.size, reads, checksum);
+        const double rleNs = timeTileReads(rle, {0, 0}, level.size, reads, checksum);
+        std::printf("  %-18s %9zu %11.1f %11.1f %8.3f /%7.3f %8.2f /%7.2f %7.2f /%6.2f%s\n", map.name, rle.runCount(),
+                    denseBytes / 1024.0, rle.memoryBytes() / 1024.0, denseScan, rleScan, denseBuild, rleBuild,
+                    denseNs, rleNs, denseCount == rleCount ? "" : "  (MISMATCH)");
+    }
+    std::printf("  (checksum %u)\n", checksum);
+}
+
+// --- Snapshots ---
+
+// Measures quicksave and quickload of a large level: building the flat
+// snapshot, writing it with one write, reading it back with one read, and
+// validating and applying it.
+static void benchSnapshot() {
+    Level level = createGeneratedLevel(4096, 1024, 1234);
+    Player player({100.f, 100.f});
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "bench.snapshot";
+    std::vector<std::uint8_t> buffer;
+    std::string error;
+
+    const int repeats = 20;
+    double buildMs = 0, writeMs = 0, readMs = 0, applyMs = 0;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        const SnapshotEntity entity = snapshotEntityFromPlayer(player);
+        writeSnapshot(buffer, {(std::uint64_t)i, 1234u, 0}, level, &entity, 1);
+        buildMs += secondsSince(start) * 1000.0;
+
+        start = std::chrono::steady_clock::now();
+        if (!saveSnapshotFile(path, buffer, error)) break;
+        writeMs += secondsSince(start) * 1000.0;
+
+        start = std::chrono::steady_clock::now();
+        if (!loadSnapshotFile(path, buffer, error)) break;
+        readMs += secondsSince(start) * 1000.0;
+
+        start = std::chrono::steady_clock::now();
+        SnapshotView view;
+        if (!readSnapshot(buffer.data(), buffer.size(), view, error)) break;
+        applySnapshotTiles(view, level);
+        applySnapshotEntity(view.entities[0], player);
+        applyMs += secondsSince(start) * 1000.0;
+    }
+    std::filesystem::remove(path);
+    if (!error.empty()) {
+        std::printf("snapshot: failed: %s\n", error.c_str());
+        return;
+    }
+    std::printf("snapshot: %ux%u level, %.1f MiB per snapshot, average of %d runs\n",
+                level.size.x, level.size.y, buffer.size() / (1024.0 * 1024.0), repeats);
+    std::printf("  build          %8.3f ms\n", buildMs / repeats);
+    std::printf("  write (1 call) %8.3f ms\n", writeMs / repeats);
+    std::printf("  read (1 call)  %8.3f ms\n", readMs / repeats);
+    std::printf("  check + apply  %8.3f ms\n", applyMs / repeats);
+    std::printf("  quicksave      %8.3f ms, quickload %.3f ms\n", (buildMs + writeMs) / repeats, (readMs + applyMs) / repeats);
+}
+
+// --- Rollback ---
+
+// Measures the worst case of late input: a correction for the oldest tick
+// still in the rollback window, which restores every entity and re-simulates
+// MAX_ROLLBACK_TICKS ticks, for growing entity counts. The cost is compared
+// with one 60 Hz frame.
+static void benchRollback() {
+    const Level level = createGeneratedLevel(4096, 1024, 1234);
+    const double frameMs = 1000.0 / 60.0;
+    std::printf("rollback: rewind + re-simulate %d ticks (frame budget %.2f ms)\n", MAX_ROLLBACK_TICKS, frameMs);
+    std::printf("  %8s %12s %12s %10s\n", "entities", "advance/tick", "rollback", "of frame");
+    for (int entityCount : {1, 16, 64, 256, 1024, 4096}) {
+        std::mt19937 rng(99);
+        std::vector<Player> players;
+        players.reserve(entityCount);
+        for (int i = 0; i < entityCount; ++i) {
+            const float x = (float)(rng() % (level.size.x - 2) + 1) * TILE_SIZE;
+            players.emplace_back(sf::Vector2f(x, TILE_SIZE * 2.f));
+        }
+        RollbackSimulation simulation(players);
+        std::vector<RollbackSimulation::TickInput> inputs(entityCount);
+        // Entity 0 is remote: its input is always predicted, then corrected late.
+        inputs[0].known = false;
+
+        const int rounds = 50;
+        double advanceSeconds = 0.0, rollbackSeconds = 0.0;
+        int replayedTicks = 0;
+        for (int round = 0; round < rounds; ++round) {
+            for (int t = 0; t < MAX_ROLLBACK_TICKS; ++t) {
+                for (int i = 1; i < entityCount; ++i) {
+                    if (rng() % 30 == 0) {
+                        const unsigned int buttons = rng();
+                        inputs[i].input = {(buttons & 1) != 0, (buttons & 2) != 0, (buttons & 4) != 0};
+                    }
+                }
+                auto start = std::chrono::steady_clock::now();
+                simulation.advance(level, inputs.data());
+                advanceSeconds += secondsSince(start);
+            }
+            // The remote player actually jumped and ran right MAX_ROLLBACK_TICKS ticks ago.
+            const std::uint64_t lateTick = simulation.currentTick() - MAX_ROLLBACK_TICKS;
+            simulation.confirmInput(0, lateTick, {false, round % 2 == 0, true});
+            auto start = std::chrono::steady_clock::now();
+            replayedTicks += simulation.resimulate(level);
+            rollbackSeconds += secondsSince(start);
+        }
+        const double advanceMs = advanceSeconds * 1000.0 / ((double)rounds * MAX_ROLLBACK_TICKS);
+        const double rollbackMs = rollbackSeconds * 1000.0 / rounds;
+        std::printf("  %8d %9.4f ms %9.4f ms %9.1f%%   (%d ticks replayed)\n", entityCount, advanceMs, rollbackMs,
+                    rollbackMs * 100.0 / frameMs, replayedTicks / rounds);
+    }
+}
+
+// --- Lighting ---
+
+// Measures the light map (LightMap.hpp) on a generated level with caves dug
+// into the ground and torches in them: a full rebuild on one thread and on
+// all cores, and the incremental update after single tile edits (blocking
+// daylight in the sky, digging into the ground, placing and removing
+// torches). Afterwards the updated map is compared with a full rebuild.
+static void benchLighting() {
+    Level level = createGeneratedLevel(4096, 1024, 1234);
+    std::mt19937 rng(5);
+    // Caves: horizontal tunnels in the lower half, some with a torch.
+    for (int i = 0; i < 3000; ++i) {
+        const int cx = (int)(rng() % level.size.x);
+        const int cy = (int)(level.size.y / 2 + rng() % (level.size.y / 2 - 4));
+        const int length = 4 + (int)(rng() % 20);
+        for (int x = cx; x < cx + length; ++x) {
+            for (int y = cy; y < cy + 3; ++y) level.setTile(x, y, Air);
+        }
+        if (rng() % 3 == 0) level.setTile(cx + length / 2, cy + 2, Torch);
+    }
+
+    LightMap lights;
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+    lights.rebuild(level, 1);
+    const double singleMs = secondsSince(start) * 1000.0;
+    start = std::chrono::steady_clock::now();
+    lights.rebuild(level, cores);
+    const double parallelMs = secondsSince(start) * 1000.0;
+    std::printf("lighting: %ux%u level with caves and torches\n", level.size.x, level.size.y);
+    std::printf("  full rebuild, 1 thread   %8.2f ms\n", singleMs);
+    std::printf("  full rebuild, %2u threads %8.2f ms\n", cores, parallelMs);
+
+    // Times `edits` single-tile edits chosen by `pick`, each followed by tileChanged.
+    auto timeEdits = [&](const char* name, int edits, auto pick) {
+        double seconds = 0.0, worst = 0.0;
+        std::size_t touched = 0;
+        for (int i = 0; i < edits; ++i) {
+            int x, y;
+            TileType type;
+            pick(x, y, type);
+            level.setTile(x, y, type);
+            auto editStart = std::chrono::steady_clock::now();
+            lights.tileChanged(level, x, y);
+            const double elapsed = secondsSince(editStart);
+            seconds += elapsed;
+            worst = std::max(worst, elapsed);
+            touched += lights.lastUpdateTiles();
+        }
+        std::printf("  %-24s %8.2f us avg, %8.2f us max, %6.0f tiles relit\n", name, seconds * 1e6 / edits,
+                    worst * 1e6, (double)touched / edits);
+    };
+    const int edits = 1000;
+    timeEdits("block daylight (sky)", edits, [&](int& x, int& y, TileType& type) {
+        x = (int)(rng() % level.size.x);
+        y = (int)(rng() % (level.size.y / 3));
+        type = Solid;
+    });
+    timeEdits("dig into the ground", edits, [&](int& x, int& y, TileType& type) {
+        x = (int)(rng() % level.size.x);
+        y = 0;
+        while (y < (int)level.size.y - 1 && level.getTile(x, y) != Solid) ++y; // The top of the ground.
+        type = Air;
+    });
+    std::vector<sf::Vector2i> torches;
+    timeEdits("place torch (cave)", edits, [&](int& x, int& y, TileType& type) {
+        do {
+            x = (int)(rng() % level.size.x);
+            y = (int)(level.size.y / 2 + rng() % (level.size.y / 2));
+        } while (level.getTile(x, y) != Air);
+        torches.push_back({x, y});
+        type = Torch;
+    });
+    std::size_t next = 0;
+    timeEdits("remove torch (cave)", edits, [&](int& x, int& y, TileType& type) {
+        x = torches[next].x;
+        y = torches[next].y;
+        ++next;
+        type = Air;
+    });
+
+    // An avalanche: many tiles of a chunk change at once and are relit
+    // together, the way the game follows a big tick of falling sand.
+    const int regions = 200;
+    double regionSeconds = 0.0;
+    std::size_t regionTouched = 0;
+    for (int i = 0; i < regions; ++i) {
+        const int x0 = (int)(rng() % (level.size.x - CHUNK_SIZE));
+        const int y0 = (int)(rng() % (level.size.y - CHUNK_SIZE));
+        for (int y = y0; y < y0 + CHUNK_SIZE; ++y) {
+            for (int x = x0; x < x0 + CHUNK_SIZE; ++x) {
+                if (rng() % 2 == 0) level.setTile(x, y, rng() % 2 ? Sand : Air);
+            }
+        }
+        auto regionStart = std::chrono::steady_clock::now();
+        lights.regionChanged(level, x0, y0, x0 + CHUNK_SIZE - 1, y0 + CHUNK_SIZE - 1);
+        regionSeconds += secondsSince(regionStart);
+        regionTouched += lights.lastUpdateTiles();
+    }
+    std::printf("  %-24s %8.2f us avg, %6.0f tiles relit\n", "chunk of sand (region)", regionSeconds * 1e6 / regions,
+                (double)regionTouched / regions);
+
+    LightMap reference;
+    reference.rebuild(level);
+    std::size_t mismatches = 0;
+    for (int y = 0; y < (int)level.size.y; ++y) {
+        for (int x = 0; x < (int)level.size.x; ++x) mismatches += lights.getLight(x, y) != reference.getLight(x, y);
+    }
+    std::printf("  incremental == full rebuild: %s\n", mismatches == 0 ? "yes" : "NO");
+}
+
+// --- Mipmap ---
+
+// Measures the level mipmap (LevelMipmap.hpp): building all mips of a large
+// level, and the incremental update after single tile edits, compared with
+// walking all tiles of the level (what drawing a zoomed-out view or minimap
+// tile by tile would cost every frame). Afterwards the updated pyramid is
+// compared with a fresh rebuild.
+static void benchMipmap() {
+    Level level = createGeneratedLevel(4096, 1024, 1234);
+    LevelMipmap mipmap;
+    auto start = std::chrono::steady_clock::now();
+    mipmap.rebuild(level);
+    const double rebuildMs = secondsSince(start) * 1000.0;
+
+    start = std::chrono::steady_clock::now();
+    std::size_t nonAir = 0;
+    for (int y = 0; y < (int)level.size.y; ++y) {
+        for (int x = 0; x < (int)level.size.x; ++x) nonAir += level.getTile(x, y) != Air;
+    }
+    const double scanMs = secondsSince(start) * 1000.0;
+
+    std::mt19937 rng(11);
+    const TileType kinds[] = {Air, Solid, Brick, Coin, Sand};
+    const int edits = 100000;
+    double seconds = 0.0;
+    for (int i = 0; i < edits; ++i) {
+        const int x = (int)(rng() % level.size.x);
+        const int y = (int)(rng() % level.size.y);
+        level.setTile(x, y, kinds[rng() % 5]);
+        auto editStart = std::chrono::steady_clock::now();
+        mipmap.tileChanged(level, x, y);
+        seconds += secondsSince(editStart);
+    }
+    // Chunk-sized rectangles of changed tiles, updated in one go.
+    const int regions = 2000;
+    double regionSeconds = 0.0;
+    for (int i = 0; i < regions; ++i) {
+        const int x0 = (int)(rng() % (level.size.x - CHUNK_SIZE));
+        const int y0 = (int)(rng() % (level.size.y - CHUNK_SIZE));
+        for (int y = y0; y < y0 + CHUNK_SIZE; ++y) {
+            for (int x = x0; x < x0 + CHUNK_SIZE; ++x) {
+                if (rng() % 2 == 0) level.setTile(x, y, kinds[rng() % 5]);
+            }
+        }
+        auto regionStart = std::chrono::steady_clock::now();
+        mipmap.regionChanged(level, x0, y0, x0 + CHUNK_SIZE - 1, y0 + CHUNK_SIZE - 1);
+        regionSeconds += secondsSince(regionStart);
+    }
+
+    LevelMipmap reference;
+    reference.rebuild(level);
+    std::size_t mismatches = 0;
+    for (int mip = 1; mip < mipmap.levelCount(); ++mip) {
+        const sf::Vector2u mipSize = mipmap.getMipSize(mip);
+        for (int y = 0; y < (int)mipSize.y; ++y) {
+            for (int x = 0; x < (int)mipSize.x; ++x) {
+                mismatches += mipmap.getCell(level, mip, x, y) != reference.getCell(level, mip, x, y);
+            }
+        }
+    }
+    std::printf("mipmap: %ux%u level, %d mips (%ux%u at mip 4)\n", level.size.x, level.size.y, mipmap.levelCount(),
+                mipmap.getMipSize(4).x, mipmap.getMipSize(4).y);
+    std::printf("  full rebuild           %8.2f ms\n", rebuildMs);
+    std::printf("  visit every tile       %8.2f ms (%zu non-Air)\n", scanMs, nonAir);
+    std::printf("  single tile edit       %8.3f us avg\n", seconds * 1e6 / edits);
+    std::printf("  chunk of edits         %8.3f us avg\n", regionSeconds * 1e6 / regions);
+    std::printf("  incremental == full rebuild: %s\n", mismatches == 0 ? "yes" : "NO");
+}
+
+// --- Occupancy ---
+
+// Fills a level with random Solid tiles (one in `oneIn` cells): a map with
+// tiles in every chunk, where the occupancy bits can skip nothing.
+static Level createNoiseLevel(unsigned int width, unsigned int height, unsigned int oneIn, unsigned int seed) {
+    Level level;
+    level.resize({width, height});
+    std::mt19937 rng(seed);
+    for (TileType& tile : level.tiles) tile = rng() % oneIn == 0 ? Solid : Air;
+    return level;
+}
+
+// Measures what the occupancy bits (TileOccupancy in Level.hpp) save on a
+// sparse, a mixed and a dense map. Every "plain" column is the tile-by-tile
+// code they replace: raycasts without SkipEmpty, regions tested tile by tile,
+// every chunk in view drawn, and Player::step on a copy of the level whose
+// bits all say "occupied". A region the bits call empty must be empty. The
+// raycasts hit the same tiles but for a handful of long rays: the plain walk
+// sums tile widths over thousands of steps and drifts, while each jump
+// recomputes the distances (checked against a walk in doubles, the jumps are
+// the more accurate of the two).
+static void benchOccupancy() {
+    std::pair<const char*, Level> maps[] = {
+        {"sparse", createSkyLevel(4096, 1024, 77)},
+        {"mixed", createGeneratedLevel(4096, 1024, 1234)},
+        {"dense", createNoiseLevel(4096, 1024, 8, 5)},
+    };
+    std::printf("occupancy: %d-tile chunks, %d-tile super-chunks, 4096x1024 levels\n", CHUNK_SIZE,
+                TileOccupancy::SUPER_CHUNK_TILES);
+    for (auto& [name, level] : maps) {
+        auto start = std::chrono::steady_clock::now();
+        level.refreshOccupancy();
+        const double refreshMs = secondsSince(start) * 1000.0;
+        const std::size_t chunkTotal = (std::size_t)level.chunkCount.x * level.chunkCount.y;
+        std::printf("  %s: %zu of %zu chunks occupied, full rescan %.2f ms\n", name, level.occupancy.occupiedChunks(),
+                    chunkTotal, refreshMs);
+
+        // Raycasts: long rays across the map and short line-of-sight rays.
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> posX(0.f, level.sizePixels.x);
+        std::uniform_real_distribution<float> posY(0.f, level.sizePixels.y);
+        std::uniform_real_distribution<float> offset(-600.f, 600.f);
+        const std::size_t rayCount = 100000;
+        std::vector<Ray> rays(2 * rayCount);
+        for (std::size_t i = 0; i < rayCount; ++i) {
+            const sf::Vector2f from = {posX(rng), posY(rng)};
+            rays[i] = {from, {posX(rng), posY(rng)}};
+            rays[rayCount + i] = {from, from + sf::Vector2f(offset(rng), offset(rng))};
+        }
+        for (int set = 0; set < 2; ++set) {
+            const Ray* begin = rays.data() + set * rayCount;
+            std::vector<RaycastHit> plainHits(rayCount), skipHits(rayCount);
+            start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < rayCount; ++i) plainHits[i] = raycastLevel<TILE_SOLID, false>(level, begin[i].from, begin[i].to);
+            const double plainSeconds = secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < rayCount; ++i) skipHits[i] = raycastLevel(level, begin[i].from, begin[i].to);
+            const double skipSeconds = secondsSince(start);
+            std::size_t hits = 0, different = 0;
+            for (std::size_t i = 0; i < rayCount; ++i) {
+                hits += skipHits[i].hit ? 1 : 0;
+                different += (plainHits[i].hit != skipHits[i].hit || plainHits[i].tile != skipHits[i].tile) ? 1 : 0;
+            }
+            std::printf("    %-5s rays   plain %10.0f rays/s, skipping %10.0f rays/s (x%.2f), %zu hits, %zu differ\n",
+                        set == 0 ? "long" : "short", rayCount / plainSeconds, rayCount / skipSeconds,
+                        plainSeconds / skipSeconds, hits, different);
+        }
+
+        // Area queries: boxes of 2x3 up to 64x64 tiles, "is there anything here?".
+        const std::size_t queryCount = 200000;
+        std::vector<int> boxes(4 * queryCount);
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            boxes[4 * i] = (int)(rng() % level.size.x);
+            boxes[4 * i + 1] = (int)(rng() % level.size.y);
+            boxes[4 * i + 2] = boxes[4 * i] + 1 + (int)(rng() % 64);
+            boxes[4 * i + 3] = boxes[4 * i + 1] + 2 + (int)(rng() % 63);
+        }
+        std::vector<char> plainEmpty(queryCount), bitsEmpty(queryCount);
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            bool empty = true;
+            for (int y = boxes[4 * i + 1]; y <= boxes[4 * i + 3] && empty; ++y) {
+                for (int x = boxes[4 * i]; x <= boxes[4 * i + 2] && empty; ++x) empty = level.getTile(x, y) == Air;
+            }
+            plainEmpty[i] = empty;
+        }
+        const double plainQuerySeconds = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            bitsEmpty[i] = level.regionEmpty(boxes[4 * i], boxes[4 * i + 1], boxes[4 * i + 2], boxes[4 * i + 3]);
+        }
+        const double bitsQuerySeconds = secondsSince(start);
+        std::size_t emptyCount = 0, bitsEmptyCount = 0, wrong = 0;
+        for (std::size_t i = 0; i < queryCount; ++i) {
+            emptyCount += plainEmpty[i];
+            bitsEmptyCount += bitsEmpty[i];
+            wrong += bitsEmpty[i] && !plainEmpty[i];
+        }
+        std::printf("    regions      tile scan %7.1f ns, bits %7.1f ns; empty: %zu by tiles, %zu by bits, %zu wrong\n",
+                    plainQuerySeconds * 1e9 / queryCount, bitsQuerySeconds * 1e9 / queryCount, emptyCount, bitsEmptyCount,
+                    wrong);
+
+        // Culling: chunks an unlit drawLevel draws for a zoomed-out (4x) view
+        // at every position of a grid over the map.
+        const int viewChunksX = (int)(WINDOW_WIDTH * 4 / (CHUNK_SIZE * TILE_SIZE)) + 1;
+        const int viewChunksY = (int)(WINDOW_HEIGHT * 4 / (CHUNK_SIZE * TILE_SIZE)) + 1;
+        std::size_t inView = 0, drawn = 0;
+        for (int vy = 0; vy + viewChunksY <= (int)level.chunkCount.y; vy += viewChunksY / 2) {
+            for (int vx = 0; vx + viewChunksX <= (int)level.chunkCount.x; vx += viewChunksX / 2) {
+                for (int cy = vy; cy < vy + viewChunksY; ++cy) {
+                    for (int cx = vx; cx < vx + viewChunksX; ++cx) {
+                        ++inView;
+                        drawn += level.occupancy.chunkEmpty(cx, cy) ? 0 : 1;
+                    }
+                }
+            }
+        }
+        std::printf("    culling      %zu chunks in view, %zu drawn (%.0f%%)\n", inView, drawn, 100.0 * drawn / inView);
+
+        // Collision: the same players on the level and on a copy whose bits
+        // were reset (everything "occupied" until a refresh that never comes).
+        Level unknown = level;
+        unknown.occupancy.reset(unknown.size);
+        const double plainNs = timePlayerSteps(unknown, 2000, 300);
+        const double bitsNs = timePlayerSteps(level, 2000, 300);
+        std::printf("    collision    plain %7.1f ns/step, with bits %7.1f ns/step (%+.1f%%)\n", plainNs, bitsNs,
+                    (bitsNs / plainNs - 1.0) * 100.0);
+    }
+}
+
+// --- Falling Sand ---
+
+// Measures the sand simulation (SandSimulation.hpp): a thick cloud of sand and
+// water (half the cells of the upper half of a large level) falls onto the
+// ground and settles. Reports the cells processed and moved per tick, the time
+// per tick on one thread and on all cores, and the time 1M processed cells
+// would take. Afterwards checks that no sand or water was created or lost.
+static void benchSand() {
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    auto countFalling = [](const Level& level) {
+        std::size_t count[2] = {0, 0};
+        for (TileType tile : level.tiles) {
+            if (tile == Sand) ++count[0];
+            if (tile == Water) ++count[1];
+        }
+        return std::make_pair(count[0], count[1]);
+    };
+    std::printf("sand: cloud of sand and water falling in a 2048x1024 level\n");
+    for (unsigned int threads : {1u, cores}) {
+        Level level;
+        level.resize({2048, 1024}, Air);
+        std::mt19937 rng(3);
+        for (int x = 0; x < (int)level.size.x; ++x) level.setTile(x, (int)level.size.y - 1, Solid);
+        for (int y = 0; y < (int)level.size.y / 2; ++y) {
+            for (int x = 0; x < (int)level.size.x; ++x) {
+                const unsigned int roll = rng() % 4;
+                if (roll == 0) level.setTile(x, y, Sand);
+                if (roll == 1) level.setTile(x, y, Water);
+            }
+        }
+        const auto before = countFalling(level);
+
+        SandSimulation sand(threads);
+        sand.reset(level);
+        const int ticks = 300;
+        std::size_t processed = 0, moved = 0, chunks = 0, busiest = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < ticks; ++tick) {
+            sand.step(level);
+            processed += sand.processedCells();
+            moved += sand.movedCells();
+            chunks += sand.activeChunks();
+            busiest = std::max(busiest, sand.processedCells());
+        }
+        const double seconds = secondsSince(start);
+        const double nsPerCell = seconds * 1e9 / (double)std::max<std::size_t>(processed, 1);
+        std::printf("  %2u thread(s): %7.2f ms/tick, %8zu cells/tick (max %zu), %7zu moved/tick, %5zu active chunks/tick\n",
+                    sand.threadCount(), seconds * 1000.0 / ticks, processed / ticks, busiest, moved / ticks,
+                    chunks / ticks);
+        std::printf("               %5.2f ns/cell -> %.2f ms per 1M active cells; still active after %d ticks: %zu chunks\n",
+                    nsPerCell, nsPerCell, ticks, sand.activeChunks());
+        std::printf("               sand and water conserved: %s\n", countFalling(level) == before ? "yes" : "NO");
+    }
+}
+
+// --- Sleeping Bodies ---
+
+// Measures body sleeping (Player.hpp): 4000 bodies on a level with ramps and
+// platforms, 90% of them idle once they have landed and 10% running and
+// jumping around, while 20 tiles a tick are edited right next to random
+// bodies (which wakes them). Runs the same scenario with sleeping off and on,
+// and checks that every body ends in exactly the same state.
+static void benchSleep() {
+    Level level = createGeneratedLevel(4096, 1024, 1234);
+    addSlopesAndPlatforms(level);
+    const int bodyCount = 4000;
+    const int ticks = 900;
+    const int editsPerTick = 20;
+    std::printf("sleep: %d bodies x %d ticks, 10%% restless, %d tile edits/tick next to bodies\n", bodyCount, ticks,
+                editsPerTick);
+
+    std::vector<Player> results[2];
+    double nsPerStep[2] = {0.0, 0.0};
+    for (int sleeping = 0; sleeping < 2; ++sleeping) {
+        Level edited = level;
+        std::mt19937 rng(5);
+        std::vector<Player> bodies;
+        std::vector<PlayerInput> inputs(bodyCount);
+        bodies.reserve(bodyCount);
+        for (int i = 0; i < bodyCount; ++i) {
+            bodies.emplace_back(sf::Vector2f((float)(rng() % (edited.size.x - 2) + 1) * TILE_SIZE, TILE_SIZE * 2.f));
+            bodies.back().canSleep = sleeping != 0;
+        }
+        double seconds = 0.0;
+        std::size_t asleepTotal = 0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            // Restless bodies change buttons now and then (not timed).
+            for (int i = 0; i < bodyCount / 10; ++i) {
+                if (rng() % 30 == 0) {
+                    const unsigned int buttons = rng();
+                    inputs[i] = {(buttons & 1) != 0, (buttons & 2) != 0, (buttons & 4) != 0};
+                }
+            }
+            // Torches placed (or removed) beside random bodies' heads: close
+            // enough to wake them, not in their way (not timed).
+            for (int e = 0; e < editsPerTick; ++e) {
+                const sf::Vector2f at = bodies[rng() % bodyCount].getPosition();
+                const int x = (int)(at.x / TILE_SIZE) + 1, y = (int)(at.y / TILE_SIZE) - 1;
+                if (edited.getTile(x, y) == Air || edited.getTile(x, y) == Torch) edited.setTile(x, y, edited.getTile(x, y) == Air ? Torch : Air);
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < bodyCount; ++i) bodies[i].step(inputs[i], edited);
+            seconds += secondsSince(start);
+            for (const Player& body : bodies) asleepTotal += body.isAsleep() ? 1 : 0;
+        }
+        nsPerStep[sleeping] = seconds * 1e9 / ((double)bodyCount * ticks);
+        std::size_t asleepNow = 0;
+        for (const Player& body : bodies) asleepNow += body.isAsleep() ? 1 : 0;
+        std::printf("  sleeping %-3s %8.1f ns/step, asleep on average %5.1f%%, at the end %zu awake / %zu asleep\n",
+                    sleeping ? "on" : "off", nsPerStep[sleeping], 100.0 * asleepTotal / ((double)bodyCount * ticks),
+                    bodyCount - asleepNow, asleepNow);
+        results[sleeping] = std::move(bodies);
+    }
+    std::size_t different = 0;
+    for (int i = 0; i < bodyCount; ++i) {
+        const Player& a = results[0][i];
+        const Player& b = results[1][i];
+        different += (a.position.x != b.position.x || a.position.y != b.position.y || a.velocity.x != b.velocity.x ||
+                      a.velocity.y != b.velocity.y || a.isOnGround != b.isOnGround || a.landingSpeed != b.landingSpeed) ? 1 : 0;
+    }
+    std::printf("  speedup x%.2f; bodies whose final state differs: %zu\n", nsPerStep[0] / nsPerStep[1], different);
+}
+
+// --- Time Travel ---
+
+// Records a player running around a level where sand is poured now and then
+// (TimeTravel.hpp), then seeks back to states saved along the way and checks
+// that the level, player and score come back exactly.
+static void benchTimeTravel() {
+    Level level = createGeneratedLevel(1024, 256, 1234);
+    addSlopesAndPlatforms(level);
+    const int ticks = 7200;
+    const int pourInterval = 120;
+    const std::size_t byteCapacity = 512 * 1024;
+    const std::size_t tickCapacity = 1800; // 30 seconds at 60 ticks/second.
+    std::printf("timetravel: %d ticks of a running player, a 6x6 block of sand poured every %d ticks\n", ticks,
+                pourInterval);
+
+    TickHistory history(byteCapacity, tickCapacity);
+    history.reset(level);
+    SandSimulation sand(1);
+    sand.setRecordChanges(true);
+    sand.reset(level);
+    Player player({TILE_SIZE * 10.5f, TILE_SIZE * 2.f});
+    PlayerInput input;
+    std::mt19937 rng(11);
+    std::int32_t score = 0;
+    // Full copies of a few recent ticks, to compare seeking against.
+    struct Reference {
+        std::uint64_t tick;
+        std::vector<TileType> tiles;
+        SnapshotEntity player;
+        std::int32_t score;
+    };
+    std::vector<Reference> references;
+    double recordSeconds = 0.0;
+    std::size_t tileChangeTicks = 0;
+    for (int tick = 1; tick <= ticks; ++tick) {
+        if (rng() % 20 == 0) {
+            const unsigned int buttons = rng();
+            input = {(buttons & 1) != 0, (buttons & 2) != 0, (buttons & 4) != 0};
+        }
+        if (tick % pourInterval == 0) {
+            const sf::Vector2f at = player.getPosition();
+            const int px = (int)(at.x / TILE_SIZE) - 3, py = (int)(at.y / TILE_SIZE) - 10;
+            for (int y = py; y < py + 6; ++y) {
+                for (int x = px; x < px + 6; ++x) {
+                    if (level.getTile(x, y) == Air) level.setTile(x, y, Sand);
+                }
+            }
+            sand.wake(px, py);
+        }
+        player.step(input, level);
+        score += 10 * player.collectItems(level);
+        sand.step(level);
+        auto start = std::chrono::steady_clock::now();
+        history.record((std::uint64_t)tick, level, snapshotEntityFromPlayer(player), input, score);
+        recordSeconds += secondsSince(start);
+        tileChangeTicks += sand.changedTiles().empty() ? 0 : 1;
+        if (tick > ticks - (int)tickCapacity + 100 && tick % 97 == 0) {
+            references.push_back({(std::uint64_t)tick, level.tiles, snapshotEntityFromPlayer(player), score});
+        }
+    }
+    const std::vector<TileType> finalTiles = level.tiles;
+    const SnapshotEntity finalPlayer = snapshotEntityFromPlayer(player);
+
+    std::printf("  record %8.0f ns/tick; %zu ticks held (%.1f s), %zu of %zu KB used, %.1f bytes/tick; %zu ticks moved tiles\n",
+                recordSeconds * 1e9 / ticks, history.tickCount(), history.tickCount() / 60.0, history.usedBytes() / 1024,
+                byteCapacity / 1024, (double)history.usedBytes() / (double)history.tickCount(), tileChangeTicks);
+    std::printf("  memory %zu KB in total (ring, scratch, tick index, level copy)\n", history.memoryBytes() / 1024);
+
+    // Seek to the saved ticks in random order and compare.
+    std::shuffle(references.begin(), references.end(), rng);
+    std::vector<sf::Vector2i> changedTiles;
+    std::size_t mismatches = 0, tilesMoved = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Reference& reference : references) {
+        if (reference.tick < history.oldestTick()) continue; // Already dropped from the ring.
+        changedTiles.clear();
+        history.seek(reference.tick, level, changedTiles);
+        tilesMoved += changedTiles.size();
+        TickHistory::TickState state;
+        const bool found = history.readTick(reference.tick, state);
+        mismatches += (!found || level.tiles != reference.tiles || state.score != reference.score ||
+                       std::memcmp(&state.player, &reference.player, sizeof(SnapshotEntity)) != 0) ? 1 : 0;
+    }
+    const double seekSeconds = secondsSince(start);
+    changedTiles.clear();
+    history.seek(history.newestTick(), level, changedTiles);
+    TickHistory::TickState newest;
+    history.readTick(history.newestTick(), newest);
+    const bool backToPresent = level.tiles == finalTiles && std::memcmp(&newest.player, &finalPlayer, sizeof(SnapshotEntity)) == 0;
+    std::printf("  seek + decode %8.1f us each (%zu tiles moved in all); %zu of %zu recorded ticks differ, back to the present: %s\n",
+                seekSeconds * 1e6 / (double)references.size(), tilesMoved, mismatches, references.size(),
+                backToPresent ? "exact" : "DIFFERENT");
+
+    // A ring of only a few kilobytes, records of very different sizes (a
+    // still player, a moving one, a few to a hundred changed tiles), and many
+    // wraps: every tick the history still holds must decode exactly.
+    const std::size_t smallRingBytes = 3000;
+    const std::size_t smallTickCapacity = 600;
+    Level small;
+    small.resize({64, 32});
+    TickHistory smallHistory(smallRingBytes, smallTickCapacity);
+    smallHistory.reset(small);
+    Player mover({TILE_SIZE * 10.5f, TILE_SIZE * 2.f});
+    // The state after each of the last smallTickCapacity ticks.
+    std::vector<Reference> recent(smallTickCapacity);
+    const int smallTicks = 150000;
+    std::size_t checkedTicks = 0, smallMismatches = 0;
+    for (int tick = 1; tick <= smallTicks; ++tick) {
+        if (rng() % 10 == 0) {
+            const unsigned int buttons = rng();
+            input = {(buttons & 1) != 0, (buttons & 2) != 0, (buttons & 4) != 0};
+        }
+        if (rng() % 3 == 0) {
+            const unsigned int flips = rng() % 4 == 0 ? 1 + rng() % 100 : rng() % 4;
+            for (unsigned int i = 0; i < flips; ++i) {
+                const int x = (int)(rng() % small.size.x), y = (int)(small.size.y / 2 + rng() % (small.size.y / 2));
+                small.setTile(x, y, small.getTile(x, y) == Air ? Solid : Air);
+            }
+        }
+        mover.step(input, small);
+        smallHistory.record((std::uint64_t)tick, small, snapshotEntityFromPlayer(mover), input, tick / 7);
+        recent[(std::size_t)tick % smallTickCapacity] = {(std::uint64_t)tick, small.tiles, snapshotEntityFromPlayer(mover),
+                                                          tick / 7};
+        if (tick % 5000 != 0) continue;
+        // Decode every tick held, then seek through them (backward, then
+        // forward) and come back to the present.
+        for (std::uint64_t held = smallHistory.oldestTick(); held <= smallHistory.newestTick(); ++held) {
+            const Reference& reference = recent[held % smallTickCapacity];
+            TickHistory::TickState state;
+            const bool found = smallHistory.readTick(held, state);
+            std::vector<sf::Vector2i> ignored;
+            smallHistory.seek(held, small, ignored);
+            smallMismatches += (!found || reference.tick != held || small.tiles != reference.tiles ||
+                                state.score != reference.score ||
+                                std::memcmp(&state.player, &reference.player, sizeof(SnapshotEntity)) != 0) ? 1 : 0;
+            ++checkedTicks;
+        }
+        std::vector<sf::Vector2i> ignored;
+        smallHistory.seek(smallHistory.newestTick(), small, ignored);
+        smallMismatches += small.tiles == recent[(std::size_t)tick % smallTickCapacity].tiles ? 0 : 1;
+    }
+    std::printf("  small ring: %zu-byte ring, %d ticks of varied records, %zu held ticks checked, %zu differ\n",
+                smallRingBytes, smallTicks, checkedTicks, smallMismatches);
+}
+
+// --- Tracing ---
+
+// Measures what the instrumentation (Trace.hpp) costs: one TRACE_SCOPE, one
+// TRACE_STAGE, the same loop without either, and saving full ring buffers
+// (the main thread's and four workers') as a Chrome trace.
+static void benchTrace() {
+    const int iterations = 2000000;
+    volatile std::uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink = sink + (std::uint64_t)i;
+    const double emptyNs = secondsSince(start) * 1e9 / iterations;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        TRACE_SCOPE("bench scope");
+        sink = sink + (std::uint64_t)i;
+    }
+    const double scopeNs = secondsSince(start) * 1e9 / iterations;
+
+    start = std::chrono::steady_clock::now();
+    {
+        TRACE_STAGES(stages);
+        for (int i = 0; i < iterations; ++i) {
+            TRACE_STAGE(stages, (i & 1) ? "bench stage B" : "bench stage A");
+            sink = sink + (std::uint64_t)i;
+        }
+    }
+    const double stageNs = secondsSince(start) * 1e9 / iterations;
+    std::printf("trace: %d iterations, %.1f ns per empty loop iteration\n", iterations, emptyNs);
+    std::printf("  TRACE_SCOPE %8.1f ns, TRACE_STAGE %8.1f ns (minus the loop)\n", scopeNs - emptyNs, stageNs - emptyNs);
+
+    // Fill the ring buffers of a few pool workers, then save everything.
+    WorkerPool pool(4);
+    pool.parallelFor(4 * TRACE_BUFFER_EVENTS, [&](std::size_t n) {
+        TRACE_SCOPE("bench job");
+        sink = sink + n;
+    }, "bench jobs");
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "bench_trace.json";
+    std::size_t spans = 0;
+    std::string error;
+    start = std::chrono::steady_clock::now();
+    const bool saved = saveChromeTrace(path, spans, error);
+    const double saveMs = secondsSince(start) * 1e3;
+    if (saved) {
+        std::printf("  saved %zu spans (%.1f MB) in %.1f ms\n", spans, (double)std::filesystem::file_size(path) / 1e6, saveMs);
+        std::filesystem::remove(path);
+    } else {
+        std::printf("  saving failed: %s\n", error.c_str());
+    }
+
+    // Short-lived threads (like level reloads and asset loads) reuse the
+    // buffers of the threads that finished before them.
+    auto countBuffers = [] {
+        std::size_t count = 0;
+        TraceRegistry::instance().forEachBuffer([&](const TraceThreadBuffer&) { ++count; });
+        return count;
+    };
+    const std::size_t buffersBefore = countBuffers();
+    const int shortThreads = 200;
+    for (int i = 0; i < shortThreads; ++i) {
+        std::async(std::launch::async, [&] {
+            TRACE_THREAD_NAME("bench short thread");
+            TRACE_SCOPE("bench short job");
+            sink = sink + 1;
+        }).get();
+    }
+    std::printf("  %d short-lived threads added %zu buffers\n", shortThreads, countBuffers() - buffersBefore);
+}
+
+// --- Startup ---
+
+// Times the setup the game does before its first frame, apart from what needs
+// a display (the window, texture uploads, the first draw; the game prints
+// those in its startup timeline). The first run is cold: nothing of it is in
+// the caches and its memory is touched for the first time, so run
+// `bench startup` on its own to see it. The runs after it are warm. Finally
+// the world setup (light map, mipmap, sand) runs on a worker while the
+// images are generated, as main() overlaps it with opening the window.
+static void benchStartup() {
+    const char* stageNames[] = {"level", "light map", "mipmap", "falling sand", "particle pools", "history",
+                                "images"};
+    const int stageCount = 7;
+    const int warmRuns = 10;
+    struct Case {
+        const char* name;
+        Level (*create)();
+    };
+    const Case cases[] = {
+        {"simple 40x15", [] { return createSimpleLevel(); }},
+        {"ground 4096x1024", [] { return createGeneratedLevel(4096, 1024, 1234); }},
+    };
+    // The game's images, generated as the asset manager does at startup.
+    auto generateImages = [] {
+        std::size_t pixels = 0;
+        pixels += makeCloudImage({1024, 160}, 12, 7).getSize().x;
+        pixels += makeRidgeImage({1024, 256}, sf::Color(95, 115, 165), 0.9f, 0.5f, 1).getSize().x;
+        pixels += makeRidgeImage({1024, 192}, sf::Color(70, 130, 95), 0.6f, 0.35f, 2).getSize().x;
+        pixels += makeTileStripImage(Brick, 16, 8, 4).getSize().x;
+        pixels += makeCharacterSheet().getSize().x;
+        return pixels;
+    };
+    for (const Case& c : cases) {
+        double cold[stageCount] = {}, warm[stageCount] = {};
+        for (int run = 0; run <= warmRuns; ++run) {
+            double* times = run == 0 ? cold : warm;
+            auto start = std::chrono::steady_clock::now();
+            Level level = c.create();
+            times[0] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            LightMap lights;
+            lights.rebuild(level);
+            times[1] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            LevelMipmap mipmap;
+            mipmap.rebuild(level);
+            times[2] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            SandSimulation sand;
+            sand.reset(level);
+            times[3] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            ParticleSystem particles(200000); // MAX_PARTICLES in main.cpp.
+            times[4] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            TickHistory history(256 * 1024, 30 * 60); // TIME_TRAVEL_BYTES and _SECONDS in main.cpp.
+            history.reset(level);
+            times[5] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            generateImages();
+            times[6] += secondsSince(start);
+        }
+        std::printf("startup: %s, cold (first run) and warm (average of %d runs)\n", c.name, warmRuns);
+        double coldTotal = 0.0, warmTotal = 0.0;
+        for (int stage = 0; stage < stageCount; ++stage) {
+            std::printf("  %-16s %8.3f ms cold %8.3f ms warm\n", stageNames[stage], cold[stage] * 1e3,
+                        warm[stage] * 1e3 / warmRuns);
+            coldTotal += cold[stage];
+            warmTotal += warm[stage];
+        }
+        std::printf("  %-16s %8.3f ms cold %8.3f ms warm\n", "total", coldTotal * 1e3, warmTotal * 1e3 / warmRuns);
+
+        // The same work with the world setup overlapped (warm).
+        double overlapped = 0.0;
+        for (int run = 0; run < warmRuns; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            Level level = c.create();
+            LightMap lights;
+            LevelMipmap mipmap;
+            SandSimulation sand;
+            std::future<void> world = std::async(std::launch::async, [&] {
+                lights.rebuild(level);
+                mipmap.rebuild(level);
+                sand.reset(level);
+            });
+            generateImages();
+            world.get();
+            ParticleSystem particles(200000);
+            TickHistory history(256 * 1024, 30 * 60);
+            history.reset(level);
+            overlapped += secondsSince(start);
+        }
+        std::printf("  %-16s %8.3f ms warm, world setup on a worker\n", "overlapped", overlapped * 1e3 / warmRuns);
+    }
+}
+
+// --- Determinism ---
+
+// Runs a fixed scenario (players with scripted inputs on a level with ramps
+// and platforms) and prints a checksum of the exact simulation state. Built
+// with PLATFORMER_FIXED_POINT, the checksum must be identical for every
+// compiler, optimization level and platform; CI compares the GCC and Clang builds.
+static void benchDeterminism() {
+    Level level = createGeneratedLevel(1024, 256, 1234);
+    addSlopesAndPlatforms(level);
+    const int playerCount = 256;
+    const int ticks = 5000;
+    std::mt19937 rng(7); // Only raw rng() output is used: it is the same in every standard library.
+    std::vector<Player> players;
+    std::vector<PlayerInput> inputs(playerCount);
+    players.reserve(playerCount);
+    for (int i = 0; i < playerCount; ++i) {
+        players.emplace_back(sf::Vector2f((float)(rng() % (level.size.x - 2) + 1) * TILE_SIZE, TILE_SIZE * 2.f));
+    }
+
+    // FNV-1a over the bytes of every player's state, after every tick.
+    std::uint64_t checksum = 0xcbf29ce484222325ull;
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (int i = 0; i < playerCount; ++i) {
+            if (rng() % 20 == 0) {
+                const unsigned int buttons = rng();
+                inputs[i] = {(buttons & 1) != 0, (buttons & 2) != 0, (buttons & 4) != 0};
+            }
+            players[i].step(inputs[i], level);
+            const SnapshotEntity state = snapshotEntityFromPlayer(players[i]);
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&state);
+            for (std::size_t b = 0; b < sizeof(state); ++b) checksum = (checksum ^ bytes[b]) * 0x100000001b3ull;
+        }
+    }
+    const double seconds = secondsSince(start);
+    std::printf("determinism: %d players x %d ticks with %s physics (%.1f ns/step incl. hashing)\n", playerCount, ticks,
+                physicsScalarName(), seconds * 1e9 / ((double)playerCount * ticks));
+    std::printf("  checksum %016llx\n", (unsigned long long)checksum);
+}
+
+// --- Benchmark Registry ---
+
+// Every benchmark this program knows about, selectable by name on the command line.
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+    {"raycast", benchRaycast},
+    {"particles", benchParticles},
+    {"sprites", benchSprites},
+    {"collision", benchCollision},
+    {"world", benchWorld},
+    {"rle", benchRle},
+    {"snapshot", benchSnapshot},
+    {"rollback", benchRollback},
+    {"lighting", benchLighting},
+    {"sand", benchSand},
+    {"mipmap", benchMipmap},
+    {"occupancy", benchOccupancy},
+    {"sleep", benchSleep},
+    {"trace", benchTrace},
+    {"timetravel", benchTimeTravel},
+    {"startup", benchStartup},
+    {"determinism", benchDeterminism},
+};
+
+int main(int argc, char** argv) {
+    // With no argument run everything; otherwise only the named benchmark.
+    const char* only = (argc > 1) ? argv[1] : nullptr;
+    bool ranAny = false;
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        if (only == nullptr || std::strcmp(only, benchmark.name) == 0) {
+            benchmark.run();
+            ranAny = true;
+        }
+    }
+    if (!ranAny) {
+        std::fprintf(stderr, "Unknown benchmark '%s'. Available:", only);
+        for (const Benchmark& benchmark : BENCHMARKS) std::fprintf(stderr, " %s", benchmark.name);
+        std::fprintf(stderr, "\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+// --- Bot Clients ---
+// Simulates many players connecting to a locally running `server`, so its
+// bandwidth and tick cost can be measured without real players or machines.
+// Every bot has its own UDP socket (like a separate game client), presses
+// random buttons, decodes the delta-compressed snapshots and acknowledges
+// them exactly like a real client would.
+//
+// Usage: bots [count] [seconds]   (defaults: 200 bots for 10 seconds)
+
+// --- Includes ---
+// SFML's network module provides sf::UdpSocket and sf::IpAddress.
+#include <SFML/Network.hpp>
+// The wire format shared with the server.
+#include "NetProtocol.hpp"
+// This header provides std::chrono clocks for the send rate.
+#include <chrono>
+// This header provides std::printf.
+#include <cstdio>
+// This header provides std::atoi.
+#include <cstdlib>
+// This header provides std::unique_ptr; sockets are kept behind pointers so
+// the bots never move in memory.
+#include <memory>
+// This header provides std::optional, used by sf::UdpSocket::receive.
+#include <optional>
+// This header provides std::mt19937 for the bots' random button presses.
+#include <random>
+// This header provides std::this_thread::sleep_until.
+#include <thread>
+// This header provides std::vector.
+#include <vector>
+
+// --- Bot State ---
+
+// One simulated client.
+struct Bot {
+    sf::UdpSocket socket;
+    std::uint16_t entityId = 0;      // Assigned by the server's Welcome (0 = not connected yet).
+    SnapshotHistory history;         // Received snapshots, used as delta baselines.
+    Snapshot latest;                 // Most recently decoded snapshot.
+    std::uint32_t sequence = 0;      // Input packet counter.
+    std::uint8_t buttons = 0;        // Buttons currently held.
+    int ticksUntilDecision = 0;      // When to pick new buttons.
+    std::uint64_t bytesReceived = 0;
+    std::uint64_t snapshotsDecoded = 0;
+    std::uint64_t decodeFailures = 0;
+};
+
+int main(int argc, char** argv) {
+    const int botCount = (argc > 1) ? std::atoi(argv[1]) : 200;
+    const int runSeconds = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    // --- Create the bots ---
+    std::vector<std::unique_ptr<Bot>> bots;
+    for (int i = 0; i < botCount; ++i) {
+        auto bot = std::make_unique<Bot>();
+        if (bot->socket.bind(sf::Socket::AnyPort, sf::IpAddress::LocalHost) != sf::Socket::Status::Done) {
+            std::fprintf(stderr, "Error: could only open %d sockets\n", i);
+            break;
+        }
+        bot->socket.setBlocking(false);
+        bots.push_back(std::move(bot));
+    }
+    std::printf("bots: %zu clients -> 127.0.0.1:%u for %d seconds\n", bots.size(), (unsigned)SERVER_PORT, runSeconds);
+
+    std::mt19937 rng(7);
+    std::uint8_t datagram[sf::UdpSocket::MaxDatagramSize];
+    const auto tickDuration = std::chrono::microseconds(1000000 / SERVER_TICK_RATE);
+    auto nextTick = std::chrono::steady_clock::now();
+    const int totalTicks = runSeconds * SERVER_TICK_RATE;
+
+    for (int tick = 1; tick <= totalTicks; ++tick) {
+        for (auto& botPointer : bots) {
+            Bot& bot = *botPointer;
+
+            // --- Receive everything the server sent this bot ---
+            std::size_t received = 0;
+            std::optional<sf::IpAddress> sender;
+            unsigned short senderPort = 0;
+            while (bot.socket.receive(datagram, sizeof(datagram), received, sender, senderPort) == sf::Socket::Status::Done) {
+                bot.bytesReceived += received;
+                ByteReader in(datagram, received);
+                const PacketType type = (PacketType)in.readU8();
+                if (type == PacketType::Welcome) {
+                    bot.entityId = (std::uint16_t)in.readVarint();
+                } else if (type == PacketType::Snapshot) {
+                    Snapshot snapshot;
+                    if (decodeSnapshot(in, bot.history, snapshot)) {
+                        // Only move forward; UDP may deliver late packets.
+                        if (snapshot.tick > bot.latest.tick) {
+                            bot.history.store(snapshot);
+                            bot.latest = std::move(snapshot);
+                        }
+                        ++bot.snapshotsDecoded;
+                    } else {
+                        ++bot.decodeFailures;
+                    }
+                }
+            }
+
+            // --- Send a connect request or this tick's input ---
+            std::uint8_t packet[16];
+            ByteWriter out(packet, sizeof(packet));
+            if (bot.entityId == 0) {
+                // Keep asking until the Welcome arrives (UDP may drop packets).
+                if (tick % 15 == 1) out.writeU8((std::uint8_t)PacketType::Connect);
+            } else {
+                // Hold random buttons for a random time, like a restless player.
+                if (--bot.ticksUntilDecision <= 0) {
+                    bot.buttons = (std::uint8_t)(rng() % 8);
+                    bot.ticksUntilDecision = 10 + (int)(rng() % 80);
+                }
+                out.writeU8((std::uint8_t)PacketType::Input);
+                out.writeVarint(++bot.sequence);
+                out.writeVarint(bot.latest.tick); // Acknowledge the newest snapshot.
+                out.writeU8(bot.buttons);
+            }
+            if (out.size() > 0) {
+                (void)bot.socket.send(packet, out.size(), sf::IpAddress::LocalHost, SERVER_PORT);
+            }
+        }
+        nextTick += tickDuration;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    // --- Say goodbye and report ---
+    std::uint64_t totalBytes = 0, totalSnapshots = 0, totalFailures = 0;
+    std::size_t connected = 0;
+    for (auto& botPointer : bots) {
+        Bot& bot = *botPointer;
+        const std::uint8_t goodbye = (std::uint8_t)PacketType::Disconnect;
+        (void)bot.socket.send(&goodbye, 1, sf::IpAddress::LocalHost, SERVER_PORT);
+        totalBytes += bot.bytesReceived;
+        totalSnapshots += bot.snapshotsDecoded;
+        totalFailures += bot.decodeFailures;
+        if (bot.entityId != 0) ++connected;
+    }
+    const double seconds = runSeconds > 0 ? runSeconds : 1;
+    std::printf("connected %zu/%zu | received %.1f KiB total | %.0f B/s per client | "
+                "%.0f B/snapshot | %llu snapshots decoded, %llu failed\n",
+                connected, bots.size(), totalBytes / 1024.0,
+                bots.empty() ? 0.0 : totalBytes / seconds / bots.size(),
+                totalSnapshots ? (double)totalBytes / totalSnapshots : 0.0,
+                (unsigned long long)totalSnapshots, (unsigned long long)totalFailures);
+    return 0;
+}
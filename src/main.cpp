@@ -7,8 +7,8 @@
 // window.pollEvent() function. pollEvent might return an event, or it might
 // return nothing (if the event queue is empty), hence the 'optional'.
 #include <optional>
-// This header provides std::vector, a dynamic array container. We use it
-// to create the 2D grid (a vector of vectors) that represents our level map.
+// This header provides std::vector, a dynamic array container. The level
+// map itself is stored in one (see Level.hpp).
 #include <vector>
 // This header provides std::string for working with text, like converting
 // numbers to strings for display (though not used in this specific version yet).
@@ -26,354 +26,299 @@
 // This header provides various algorithm utilities, including std::clamp,
 // used here to restrict the camera's view within the level boundaries.
 #include <algorithm>
+// Our own headers: the game constants, tile types and the Level structure,
+// the Player, and the particle system used for landing dust and coin sparkles.
+#include "Level.hpp"
+#include "Player.hpp"
+#include "Particles.hpp"
+// The per-frame arena for transient data and the global heap counters that
+// prove the steady-state frame makes no general heap allocations (and split
+// the heap between the subsystems).
+#include "FrameArena.hpp"
+#include "HeapStats.hpp"
+// Level files, chunk hashing, the file watcher and the chunked render cache
+// used for level hot reload.
+#include "LevelFile.hpp"
+#include "FileWatcher.hpp"
+#include "LevelRenderCache.hpp"
+// Tile lighting (daylight and torches), applied when drawing the level.
+#include "LightMap.hpp"
+// Falling sand and flowing water.
+#include "SandSimulation.hpp"
+// Downscaled summaries of the level for the minimap and zoomed-out views.
+#include "LevelMipmap.hpp"
+// The gameplay event bus: the player reports events, effects/HUD/telemetry react.
+#include "GameEvents.hpp"
+// Flat game-state snapshots, used for quicksave/quickload.
+#include "GameSnapshot.hpp"
+// Frame stage and job timings, saved as a Chrome trace with F6.
+#include "Trace.hpp"
+// The recent ticks, for stepping back through them (F8).
+#include "TimeTravel.hpp"
+// The scrolling layers behind the level.
+#include "ParallaxBackground.hpp"
+// The player's animated sprite.
+#include "SpriteAnimation.hpp"
+// Textures, fonts and levels loaded on worker threads.
+#include "AssetManager.hpp"
+// The startup timeline, printed once the game is up.
+#include "StartupTimeline.hpp"
+// This header provides std::async and std::future, used to load a changed
+// level file on a worker thread.
+#include <future>
+// This header provides std::unique_ptr.
+#include <memory>
+// This header provides std::to_chars, which formats numbers without allocating.
+#include <charconv>
+
+// Maximum number of particles alive at once. The particle pools are allocated
+// once at startup with this capacity.
+const std::size_t MAX_PARTICLES = 200000;
+// Above this many tiles moved by the sand simulation in one tick, the light
+// map and the mipmap are updated a changed rectangle at a time (one per
+// active chunk) instead of tile by tile.
+const std::size_t SAND_RELIGHT_LIMIT = 256;
+// Size of the per-frame arena that holds transient data (cull lists, debug
+// strings, ...). Everything in it is thrown away at the end of each frame.
+const std::size_t FRAME_ARENA_BYTES = 256 * 1024;
+// Where F5 saves the game state and F9 loads it from.
+const char* const QUICKSAVE_PATH = "quicksave.snapshot";
+// How much of the past F8 can step back through: seconds of ticks, and the
+// bytes their records may take (a still player takes 2 bytes a tick, a
+// running one about 10, falling sand more).
+const std::size_t TIME_TRAVEL_SECONDS = 30;
+const std::size_t TIME_TRAVEL_BYTES = 256 * 1024;
+// Time each frame may spend turning loaded assets into textures (GPU uploads).
+const std::chrono::microseconds ASSET_FINISH_BUDGET(2000);
+// Where F6 saves the recent frame timings (open it in ui.perfetto.dev or chrome://tracing).
+const std::filesystem::path TRACE_PATH = "trace.json";
+// How often (in frames) the F3 debug statistics are printed to the console.
+const int STATS_INTERVAL_FRAMES = 60;
+// Camera zoom levels cycled with Z (world pixels per screen pixel).
+const float ZOOM_LEVELS[] = {1.f, 4.f, 16.f};
+// Below this many screen pixels per tile, the level is drawn from the mipmap.
+const float OVERVIEW_TILE_PIXELS = 4.f;
+// Size (screen pixels) of the square the minimap is fitted into, and its margin.
+const float MINIMAP_SIZE = 200.f;
+const float MINIMAP_MARGIN = 10.f;
 
-// --- Global Constants ---
-// Using constants makes the code easier to read and modify. If we want to
-// change gravity, we only need to change it in one place.
-
-// Downward acceleration applied to the player each frame (pixels/frame^2).
-// Simulates gravity pulling the player down.
-const float GRAVITY = 0.8f;
-// Horizontal speed when the left/right keys are held (pixels/frame).
-const float PLAYER_MOVE_SPEED = 5.0f;
-// Initial vertical velocity when the jump key is pressed (pixels/frame).
-// Negative because SFML's Y-axis points downwards (0 is top, height is bottom).
-const float PLAYER_JUMP_VELOCITY = -18.0f;
-// The dimension (width and height) of a single square tile in pixels.
-// This links the grid-based level data to the pixel-based screen coordinates.
-const int TILE_SIZE = 40;
-// A small value used to prevent floating-point inaccuracies during collision checks,
-// especially when the player is exactly aligned with a tile edge. It helps avoid
-// getting stuck by checking slightly *inside* the player's bounds.
-const float COLLISION_EPSILON = 0.01f;
-// Window dimensions defined as constants for clarity and easy reference,
-// particularly when setting up the initial view size.
-const unsigned int WINDOW_WIDTH = 800;
-const unsigned int WINDOW_HEIGHT = 600;
-
-
-// --- Level Representation ---
-
-// Defines symbolic names for different types of tiles in the level grid.
-// Using an enum improves code readability compared to using raw numbers like 0 or 1.
-enum TileType {
-    Air = 0,   // Represents empty space. Player can move through these tiles.
-    Solid = 1,  // Represents solid ground/walls. Player collides with these.
-    Coin = 2
-};
-
-// Structure (`struct`) to group together all data related to a game level.
-struct Level {
-    // The core level data: a 2D grid represented by a vector of vectors.
-    // `tiles[row][column]` or `tiles[y][x]` holds the TileType for that location.
-    std::vector<std::vector<TileType>> tiles;
-    // The dimensions of the level grid in number of tiles (e.g., 40 tiles wide).
-    sf::Vector2u size; // sf::Vector2u holds two unsigned integers (x, y).
-    // The dimensions of the level converted to pixels. Calculated once for efficiency.
-    // Useful for boundary checks involving pixel coordinates (like the view).
-    sf::Vector2f sizePixels; // sf::Vector2f holds two floats (x, y).
-
-    // Member function to safely retrieve the tile type at given grid coordinates (x, y).
-    // `const` indicates this function doesn't modify the Level object's data.
-    TileType getTile(int x, int y) const {
-        // Boundary check: Ensure x and y are within the valid range of the grid.
-        if (x >= 0 && x < size.x && y >= 0 && y < size.y) {
-            // Valid coordinates: return the tile type from the 2D vector.
-            return tiles[y][x]; // Note: Access is typically [row][column] or [y][x].
-        }
-        // Invalid coordinates (outside the map): Treat as Air to prevent errors
-        // and simplify collision logic near the level edges.
-        return Air;
-    }
-};
-
-// --- Player Representation ---
-
-// Structure to group together data and functions for the player character.
-struct Player {
-    // The player's visual representation. Currently a simple rectangle.
-    // This could be replaced with sf::Sprite to use images/animations.
-    // sf::RectangleShape is a drawable SFML entity.
-    sf::RectangleShape shape;
-    // Player's current speed and direction (pixels per frame). {x, y} components.
-    sf::Vector2f velocity = {0.f, 0.f};
-    // Flag to track if the player is currently standing on a solid surface.
-    // Used primarily to determine if the player can jump.
-    bool isOnGround = false;
-
-    // Constructor: Initializes a new Player object.
-    // Takes the starting position (in pixels) as an argument.
-    Player(sf::Vector2f startPos) {
-        // Set the player rectangle's size, slightly smaller than a tile.
-        shape.setSize({TILE_SIZE * 0.8f, TILE_SIZE * 0.95f});
-        // Set the player's color.
-        shape.setFillColor(sf::Color::Green);
-        // Set the shape's origin (the point around which transformations like
-        // setPosition and rotation occur) to its center. This simplifies positioning.
-        shape.setOrigin(shape.getSize() / 2.f);
-        // Place the player's origin at the specified starting position.
-        shape.setPosition(startPos);
-    }
-
-    // Simulates gravity by modifying the player's vertical velocity.
-    void applyGravity() {
-        // Increase the downward velocity component (y) by the GRAVITY constant.
-        velocity.y += GRAVITY;
-    }
 
-    // Makes the player jump if they are currently on the ground.
-    void jump() {
-        // Only allow jumping if the flag indicates the player is grounded.
-        if (isOnGround) {
-            // Set the vertical velocity to the predefined jump velocity (upwards).
-            velocity.y = PLAYER_JUMP_VELOCITY;
-            // Player is no longer on the ground after jumping.
-            isOnGround = false;
-        }
-    }
+// --- Helper Functions ---
 
-    // Detects and resolves collisions between the player and solid level tiles.
-    // This is a core part of the platformer physics engine.
-    // Takes a constant reference to the level data to check against.
-    void handleCollision(const Level& level) {
-        // Assume the player is not on the ground at the start of the check.
-        // It will be set to true only if a downward collision is confirmed.
-        isOnGround = false;
-        // Get the player's current world-coordinate bounding box.
-        sf::FloatRect playerBounds = shape.getGlobalBounds();
-
-        // --- Vertical Collision Check ---
-        // Check collisions along the Y-axis first. Resolving vertical collisions
-        // before horizontal ones often leads to more stable platformer physics.
-
-        // Create a copy of the bounds to predict where the player *will be* vertically.
-        sf::FloatRect verticalCheckBounds = playerBounds;
-        verticalCheckBounds.position.y += velocity.y; // Add current Y velocity.
-
-        // Determine the range of tile grid coordinates the predicted bounds overlap.
-        // Use static_cast to convert float pixel coordinates to integer tile indices.
-        // Apply COLLISION_EPSILON to check slightly inside the bounds.
-        int leftTileV = static_cast<int>((verticalCheckBounds.position.x + COLLISION_EPSILON) / TILE_SIZE);
-        int rightTileV = static_cast<int>((verticalCheckBounds.position.x + verticalCheckBounds.size.x - COLLISION_EPSILON) / TILE_SIZE);
-        int topTileV = static_cast<int>((verticalCheckBounds.position.y + COLLISION_EPSILON) / TILE_SIZE);
-        int bottomTileV = static_cast<int>((verticalCheckBounds.position.y + verticalCheckBounds.size.y - COLLISION_EPSILON) / TILE_SIZE);
-
-        // Loop through the columns the player might collide with vertically.
-        for (int x = leftTileV; x <= rightTileV; ++x) {
-            // Check for collision below (landing on a tile). Only check if moving down (velocity.y > 0).
-            if (velocity.y > 0 && level.getTile(x, bottomTileV) == Solid) {
-                // Collision detected!
-                // Reposition the player so their bottom edge rests exactly on top of the solid tile.
-                shape.setPosition({shape.getPosition().x, (float)bottomTileV * TILE_SIZE - shape.getSize().y / 2.f});
-                // Stop downward movement.
-                velocity.y = 0;
-                // Set the flag indicating the player is now grounded.
-                isOnGround = true;
-                // IMPORTANT: Update the main playerBounds variable to reflect the position change,
-                // as this corrected position is needed for the subsequent horizontal check.
-                playerBounds = shape.getGlobalBounds();
-                // Collision resolved for this axis, exit the loop.
-                break;
-            }
-            // Check for collision above (hitting a ceiling). Only check if moving up (velocity.y < 0).
-            if (velocity.y < 0 && level.getTile(x, topTileV) == Solid) {
-                 // Collision detected!
-                 // Reposition the player so their top edge is exactly below the solid tile.
-                shape.setPosition({shape.getPosition().x, (float)(topTileV + 1) * TILE_SIZE + shape.getSize().y / 2.f});
-                // Stop upward movement.
-                velocity.y = 0;
-                 // Update playerBounds after the position change.
-                playerBounds = shape.getGlobalBounds();
-                // Collision resolved, exit the loop.
-                break;
-            }
-        }
+// Draws the level tiles that are currently visible within the camera's view.
+// The tiles of each chunk are pre-built into one vertex batch by the render
+// cache, so this issues one draw call per visible chunk. `lights` (optional)
+// tints the tiles by their lighting; without it, chunks the level's occupancy
+// bits know to be all Air are skipped, a whole super-chunk at a time.
+void drawLevel(sf::RenderWindow& window, const Level& level, LevelRenderCache& renderCache, const LightMap* lights) {
+    // --- View Culling Optimization ---
+    sf::View currentView = window.getView();
+    sf::FloatRect viewBounds;
+    viewBounds.position = currentView.getCenter() - currentView.getSize() / 2.f;
+    viewBounds.size = currentView.getSize();
 
-        // --- Horizontal Collision Check ---
-        // Check collisions along the X-axis *after* vertical collisions are resolved.
-        // Uses the potentially updated playerBounds from the vertical check.
-
-        // Predict the horizontal position.
-        sf::FloatRect horizontalCheckBounds = playerBounds;
-        horizontalCheckBounds.position.x += velocity.x;
-
-        // Determine the tile range for the predicted horizontal bounds.
-        int leftTileH = static_cast<int>((horizontalCheckBounds.position.x + COLLISION_EPSILON) / TILE_SIZE);
-        int rightTileH = static_cast<int>((horizontalCheckBounds.position.x + horizontalCheckBounds.size.x - COLLISION_EPSILON) / TILE_SIZE);
-        // Use the *current* vertical tile range (after vertical adjustments).
-        int topTileH = static_cast<int>((playerBounds.position.y + COLLISION_EPSILON) / TILE_SIZE);
-        int bottomTileH = static_cast<int>((playerBounds.position.y + playerBounds.size.y - COLLISION_EPSILON) / TILE_SIZE);
-
-        // Loop through the rows the player might collide with horizontally.
-        for (int y = topTileH; y <= bottomTileH; ++y) {
-             // Check for collision to the right (only if moving right).
-            if (velocity.x > 0 && level.getTile(rightTileH, y) == Solid) {
-                // Collision detected!
-                // Reposition player so their right edge is against the left edge of the tile.
-                shape.setPosition({(float)rightTileH * TILE_SIZE - shape.getSize().x / 2.f, shape.getPosition().y});
-                // Stop rightward movement.
-                velocity.x = 0;
-                // Collision resolved, exit the loop.
-                break;
-            }
-            // Check for collision to the left (only if moving left).
-            if (velocity.x < 0 && level.getTile(leftTileH, y) == Solid) {
-                 // Collision detected!
-                 // Reposition player so their left edge is against the right edge of the tile.
-                shape.setPosition({(float)(leftTileH + 1) * TILE_SIZE + shape.getSize().x / 2.f, shape.getPosition().y});
-                // Stop leftward movement.
-                velocity.x = 0;
-                // Collision resolved, exit the loop.
-                break;
+    // Range of chunks overlapping the view (one chunk is CHUNK_SIZE tiles wide).
+    const float chunkPixels = (float)(CHUNK_SIZE * TILE_SIZE);
+    int startX = std::max(0, static_cast<int>(viewBounds.position.x / chunkPixels));
+    int endX = std::min((int)level.chunkCount.x, static_cast<int>((viewBounds.position.x + viewBounds.size.x) / chunkPixels) + 1);
+    int startY = std::max(0, static_cast<int>(viewBounds.position.y / chunkPixels));
+    int endY = std::min((int)level.chunkCount.y, static_cast<int>((viewBounds.position.y + viewBounds.size.y) / chunkPixels) + 1);
+
+    // Loop only through the potentially visible chunks.
+    // Lit, even Air may be shaded dark, so every chunk is drawn.
+    const int superChunk = TileOccupancy::SUPER_CHUNK_CHUNKS;
+    for (int cy = startY; cy < endY; ++cy) {
+        for (int cx = startX; cx < endX; ++cx) {
+            if (lights == nullptr) {
+                if (level.occupancy.superChunkEmpty(cx / superChunk, cy / superChunk)) {
+                    cx = (cx / superChunk + 1) * superChunk - 1; // On to the next super-chunk.
+                    continue;
+                }
+                if (level.occupancy.chunkEmpty(cx, cy)) continue;
             }
-        }
-    } // End handleCollision
-
-    // Handles collisions with the outer boundaries of the entire level map.
-    void handleLevelBounds(const Level& level) {
-        // Get player's current center position and half-size for easier boundary checks.
-        sf::Vector2f playerPos = shape.getPosition();
-        sf::Vector2f playerHalfSize = shape.getSize() / 2.f;
-
-        // Check left level boundary (position 0)
-        if (playerPos.x - playerHalfSize.x < 0.f) {
-            // Player's left edge is past the boundary.
-            // Reposition player so their left edge is exactly at the boundary.
-            shape.setPosition({playerHalfSize.x, playerPos.y});
-            // Stop any further leftward movement.
-            velocity.x = 0;
-        }
-        // Check right level boundary (level.sizePixels.x)
-        if (playerPos.x + playerHalfSize.x > level.sizePixels.x) {
-            // Player's right edge is past the boundary.
-            // Reposition player so their right edge is exactly at the boundary.
-            shape.setPosition({level.sizePixels.x - playerHalfSize.x, playerPos.y});
-            // Stop any further rightward movement.
-            velocity.x = 0;
-        }
-         // Check top level boundary (position 0)
-        if (playerPos.y - playerHalfSize.y < 0.f) {
-            // Player's top edge is past the boundary.
-            // Reposition player so their top edge is exactly at the boundary.
-            shape.setPosition({playerPos.x, playerHalfSize.y});
-            // Stop any further upward movement.
-            velocity.y = 0;
-        }
-        // Check bottom level boundary (fall out of world)
-        if (playerPos.y + playerHalfSize.y > level.sizePixels.y) {
-            // Player's bottom edge is past the boundary (they fell off).
-            // Example reset behavior: Print message, reset position and velocity.
-            std::cout << "Player fell out of bounds!" << std::endl;
-            // Reset to the initial starting position (adjust as needed).
-            shape.setPosition({TILE_SIZE * 1.5f, TILE_SIZE * (level.size.y - 3.f)});
-            velocity = {0.f, 0.f}; // Reset velocity too.
-            isOnGround = false; // May not be on ground after reset.
+            window.draw(renderCache.getChunk(level, cx, cy, lights));
         }
     }
+}
 
+// Draws the whole level as one sprite of the mip that has about one texel per
+// screen pixel. Used when the camera is zoomed out so far that tiles are only
+// a few pixels big: one draw call instead of thousands of chunk batches.
+void drawLevelOverview(sf::RenderWindow& window, const Level& level, LevelMipmap& mipmap) {
+    const float tilesPerPixel = window.getView().getSize().x / (float)window.getSize().x / (float)TILE_SIZE;
+    const int mip = mipmap.mipForScale(tilesPerPixel);
+    sf::Sprite sprite(mipmap.getTexture(level, mip));
+    const float texelPixels = (float)((1 << mip) * TILE_SIZE); // World pixels per texel.
+    sprite.setScale({texelPixels, texelPixels});
+    window.draw(sprite);
+}
 
-    // Applies the current velocity to the player's shape position.
-    // Called after all physics and collision checks for the frame are done.
-    void updatePosition() {
-        // `move` is a member function of sf::Transformable (base class for shapes/sprites).
-        // It adds the given vector (velocity) to the object's current position.
-        shape.move(velocity);
+// The shapes the minimap is drawn with. Each shape keeps its vertices in heap
+// arrays, so they are made once and only moved and resized every frame (which
+// reuses the arrays), keeping frames free of heap allocations.
+struct MinimapShapes {
+    sf::RectangleShape background;
+    sf::RectangleShape viewRect;
+    sf::RectangleShape marker{{3.f, 3.f}};
+
+    MinimapShapes() {
+        background.setFillColor(sf::Color(100, 150, 255, 160));
+        background.setOutlineColor(sf::Color::White);
+        background.setOutlineThickness(1.f);
+        viewRect.setFillColor(sf::Color::Transparent);
+        viewRect.setOutlineColor(sf::Color::White);
+        viewRect.setOutlineThickness(1.f);
+        marker.setOrigin({1.5f, 1.5f});
+        marker.setFillColor(sf::Color::Red);
     }
-}; // End of Player struct
+};
 
-// --- Helper Functions ---
+// Draws the minimap into the top right corner of the window (call it with
+// the default view set): the level, the camera's view rectangle and the player.
+void drawMinimap(sf::RenderWindow& window, const Level& level, LevelMipmap& mipmap, MinimapShapes& shapes,
+                 const sf::View& gameView, sf::Vector2f playerPosition) {
+    const float tilesPerPixel = (float)std::max(level.size.x, level.size.y) / MINIMAP_SIZE;
+    const int mip = mipmap.mipForScale(tilesPerPixel);
+    // Screen pixels per world pixel.
+    const float scale = MINIMAP_SIZE / ((float)std::max(level.size.x, level.size.y) * TILE_SIZE);
+    const sf::Vector2f origin((float)window.getSize().x - MINIMAP_MARGIN - level.sizePixels.x * scale, MINIMAP_MARGIN);
+
+    shapes.background.setSize({level.sizePixels.x * scale, level.sizePixels.y * scale});
+    shapes.background.setPosition(origin);
+    window.draw(shapes.background);
+
+    sf::Sprite sprite(mipmap.getTexture(level, mip));
+    const float texelScale = (float)((1 << mip) * TILE_SIZE) * scale;
+    sprite.setScale({texelScale, texelScale});
+    sprite.setPosition(origin);
+    window.draw(sprite);
+
+    shapes.viewRect.setSize(gameView.getSize() * scale);
+    shapes.viewRect.setPosition(origin + (gameView.getCenter() - gameView.getSize() / 2.f) * scale);
+    window.draw(shapes.viewRect);
+
+    shapes.marker.setPosition(origin + playerPosition * scale);
+    window.draw(shapes.marker);
+}
 
-// Creates a simple, hardcoded level map for demonstration.
-Level createSimpleLevel() {
+// A level file that has been read and parsed on a background thread, ready to
+// be applied to the running game.
+struct PendingLevelReload {
+    bool ok = false;
+    std::string error;
     Level level;
-    // Set level dimensions in tiles. Made wider to demonstrate scrolling.
-    level.size = {40, 15};
-    // Calculate and store the total level size in pixels.
-    level.sizePixels = {(float)level.size.x * TILE_SIZE, (float)level.size.y * TILE_SIZE};
-    // Allocate the 2D vector for the tile data, initializing all to Air.
-    level.tiles.resize(level.size.y, std::vector<TileType>(level.size.x, Air));
-
-    // --- Define Solid Tiles ---
-    // Floor
-    for (int x = 0; x < level.size.x; ++x) {
-        level.tiles[level.size.y - 1][x] = Solid;
+    LevelChunkHashes hashes;
+};
+
+// Loads and hashes a level file. Runs on a worker thread so reading and parsing
+// never stalls a frame.
+PendingLevelReload loadLevelForReload(std::filesystem::path path) {
+    TRACE_THREAD_NAME("level reload");
+    TRACE_SCOPE("load level");
+    HeapTagScope heapTag(HeapTag::Level);
+    PendingLevelReload reload;
+    reload.ok = loadLevelFile(path, reload.level, reload.error);
+    if (reload.ok) {
+        reload.hashes.update(reload.level);
     }
-    // Platforms
-    for (int x = 5; x < 10; ++x) level.tiles[10][x] = Solid;
-    for (int x = 12; x < 16; ++x) level.tiles[8][x] = Solid;
-    level.tiles[6][15] = Solid;
-    level.tiles[6][16] = Solid;
-    for (int x = 25; x < 30; ++x) level.tiles[10][x] = Solid;
-    for (int x = 32; x < 36; ++x) level.tiles[7][x] = Solid;
-    level.tiles[12][21] = Solid;
-    level.tiles[12][22] = Solid;
-    // Walls
-    for (int y = 11; y < level.size.y -1; ++y) level.tiles[y][2] = Solid;
-    for (int y = 6; y < 11; ++y) level.tiles[y][18] = Solid;
-    for (int y = 8; y < level.size.y -1; ++y) level.tiles[y][38] = Solid;
-
-    // Coins
-    level.tiles[9][7] = Coin;
-    level.tiles[7][14] = Coin;
-
-    return level; // Return the fully defined level structure.
+    return reload;
 }
 
-// Draws the level tiles that are currently visible within the camera's view.
-void drawLevel(sf::RenderWindow& window, const Level& level) {
-    // Create reusable shapes for drawing tiles (more efficient than creating inside loop)
-    sf::RectangleShape solidTileShape({(float)TILE_SIZE, (float)TILE_SIZE});
-    solidTileShape.setFillColor(sf::Color::Blue); // Color for solid tiles
-
-    sf::CircleShape coinShape(TILE_SIZE * 0.3f); // Make coin slightly smaller than tile
-    coinShape.setFillColor(sf::Color::Yellow);
-    // Set origin to center for easier positioning within the tile space
-    coinShape.setOrigin({coinShape.getRadius(), coinShape.getRadius()});
-
-
-    // --- View Culling Optimization ---
-    sf::View currentView = window.getView();
-    sf::FloatRect viewBounds;
-    viewBounds.position = currentView.getCenter() - currentView.getSize() / 2.f;
-    viewBounds.size = currentView.getSize();
-
-    int startX = std::max(0, static_cast<int>(viewBounds.position.x / TILE_SIZE));
-    int endX = std::min((int)level.size.x, static_cast<int>((viewBounds.position.x + viewBounds.size.x) / TILE_SIZE) + 1);
-    int startY = std::max(0, static_cast<int>(viewBounds.position.y / TILE_SIZE));
-    int endY = std::min((int)level.size.y, static_cast<int>((viewBounds.position.y + viewBounds.size.y) / TILE_SIZE) + 1);
+// Appends a number to a frame string without any heap allocation.
+void appendNumber(FrameString& text, unsigned long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    text.append(digits, result.ptr);
+}
 
-    // Loop only through the potentially visible range of tiles.
-    for (int y = startY; y < endY; ++y) {
-        for (int x = startX; x < endX; ++x) {
-            TileType currentTile = level.tiles[y][x];
 
-            // Draw Solid tiles
-            if (currentTile == Solid) {
-                solidTileShape.setPosition({(float)x * TILE_SIZE, (float)y * TILE_SIZE});
-                window.draw(solidTileShape);
-            }
-            // Draw Coin tiles (ADDED)
-            else if (currentTile == Coin) {
-                // Position the center of the coin in the middle of the tile grid cell
-                coinShape.setPosition({(float)x * TILE_SIZE + TILE_SIZE / 2.f,
-                                       (float)y * TILE_SIZE + TILE_SIZE / 2.f});
-                window.draw(coinShape);
-            }
+// --- Main Game Function ---
+// Usage: main [level file]. With a level file, the game reloads the level
+// whenever the file is saved.
+int main(int argc, char** argv) {
+    // Where the time from program start to the first frame goes (see
+    // StartupTimeline.hpp); printed once the first frame is on screen and the
+    // background assets are in.
+    StartupTimeline startup;
+    startup.mark("static initialization");
+    // The subsystem this thread's heap allocations are charged to (F7 prints
+    // the totals); changed as setup and each frame move from one to the next.
+    HeapTagScope heapTag(HeapTag::Level);
+
+    // --- Create Level ---
+    Level currentLevel = createSimpleLevel(); // Generate the level data.
+    // If a level file was given on the command line, load it instead.
+    std::filesystem::path levelPath;
+    if (argc > 1) {
+        levelPath = argv[1];
+        std::string error;
+        if (!loadLevelFile(levelPath, currentLevel, error)) {
+            // Not fatal: keep playing the built-in level.
+            std::cerr << "Error: " << error << ". Using the built-in level." << std::endl;
+            currentLevel = createSimpleLevel();
+            levelPath.clear();
         }
     }
-}
-
+    startup.mark("level");
+
+    // --- Lighting ---
+    // Light levels of every tile (daylight from above, torches). Built once
+    // at startup, then updated around each tile that changes; L toggles it.
+    LightMap lights;
+    bool lightingEnabled = true;
+
+    // --- Minimap and Zoom ---
+    // A pyramid of downscaled copies of the level, kept up to date on every
+    // tile change like the light map. It draws the minimap (M toggles it) and
+    // the level itself when the camera is zoomed out (Z cycles the zoom).
+    heapTag.change(HeapTag::Rendering);
+    LevelMipmap mipmap;
+    MinimapShapes minimapShapes;
+    bool minimapEnabled = true;
+    std::size_t zoomIndex = 0;
+
+    // --- Falling Sand ---
+    // Moves sand and water tiles every tick (see SandSimulation.hpp). It
+    // reports the tiles it moved so the light map can follow them.
+    heapTag.change(HeapTag::Simulation);
+    SandSimulation sand;
+    sand.setRecordChanges(true);
+
+    // The three only read the level (and take a while on big ones), so they
+    // are built on a worker thread while this thread opens the window, which
+    // leaves the level alone.
+    std::future<void> worldReady = std::async(std::launch::async, [&] {
+        TRACE_THREAD_NAME("startup");
+        {
+            StartupStage stage(startup, "light map");
+            HeapTagScope tag(HeapTag::Lighting);
+            lights.rebuild(currentLevel);
+        }
+        {
+            StartupStage stage(startup, "mipmap");
+            HeapTagScope tag(HeapTag::Rendering);
+            mipmap.rebuild(currentLevel);
+        }
+        {
+            StartupStage stage(startup, "falling sand");
+            HeapTagScope tag(HeapTag::Simulation);
+            sand.reset(currentLevel);
+        }
+    });
+    startup.mark("start world setup");
 
-// --- Main Game Function ---
-int main() {
     // --- Window Setup ---
+    heapTag.change(HeapTag::Rendering);
     // Create the main game window using the defined constants.
     sf::RenderWindow window(sf::VideoMode({WINDOW_WIDTH, WINDOW_HEIGHT}), "Scrolling Platformer");
     // Set the vertical sync limit (usually 60 FPS) for smoother rendering.
     window.setFramerateLimit(60);
+    startup.mark("window");
+    worldReady.get();
+    startup.mark("wait for world setup");
 
-    // --- Create Level and Player ---
-    Level currentLevel = createSimpleLevel(); // Generate the level data.
+    // --- Create Player ---
+    heapTag.change(HeapTag::Simulation);
     // Create the player, placing them at a defined starting point.
     Player player({TILE_SIZE * 1.5f, TILE_SIZE * (currentLevel.size.y - 3.f)});
 
@@ -385,13 +330,229 @@ int main() {
     // Optional: Center the view on the player's starting position immediately.
     // gameView.setCenter(player.shape.getPosition());
 
+    // --- Assets ---
+    // Images the game only looks better with (the background, the player's
+    // sprite sheet) are made on worker threads and become textures a few
+    // frames in; until then they aren't drawn, so the first frame doesn't
+    // wait for them. Finished once a frame within ASSET_FINISH_BUDGET.
+    heapTag.change(HeapTag::Rendering);
+    AssetManager assets;
+    const StartupTimeline::Clock::time_point assetsRequested = StartupTimeline::Clock::now();
+    const TextureSettings layerTexture{true, true}; // Parallax layers wrap around.
+
+    // --- Parallax Background ---
+    // Clouds, mountains, hills and a far wall of bricks behind the level,
+    // slower the further away they are (see ParallaxBackground.hpp). They
+    // are placed for a camera at the bottom of the level, where the player
+    // starts (the anchor); above it they rise less than the camera does.
+    ParallaxBackground background;
+    auto backgroundAnchor = [](const Level& level) {
+        return sf::Vector2f(level.sizePixels.x / 2.f, level.sizePixels.y - WINDOW_HEIGHT / 2.f);
+    };
+    background.setAnchor(backgroundAnchor(currentLevel));
+    // Band tops are relative to the anchor: the bottom of the screen there is +300.
+    background.addLayer(
+        assets.generatedTexture("parallax clouds", [] { return makeCloudImage({1024, 160}, 12, 7); }, layerTexture),
+        {{0.05f, 0.05f}, -340.f, 240.f, 1.5f});
+    background.addLayer(assets.generatedTexture(
+                            "parallax mountains",
+                            [] { return makeRidgeImage({1024, 256}, sf::Color(95, 115, 165), 0.9f, 0.5f, 1); },
+                            layerTexture),
+                        {{0.15f, 0.15f}, -120.f, 384.f, 1.5f});
+    background.addLayer(assets.generatedTexture(
+                            "parallax hills",
+                            [] { return makeRidgeImage({1024, 192}, sf::Color(70, 130, 95), 0.6f, 0.35f, 2); },
+                            layerTexture),
+                        {{0.35f, 0.35f}, 20.f, 240.f, 1.25f});
+    background.addLayer(
+        assets.generatedTexture("parallax bricks", [] { return makeTileStripImage(Brick, 16, 8, 4); }, layerTexture),
+        {{0.6f, 0.6f}, 204.f, 96.f, 1.5f, sf::Color(120, 120, 140)});
+
+    // The player's controls for the current frame, filled from the keyboard.
+    PlayerInput input;
+    // Number of simulation ticks run so far (saved with the game state).
+    std::uint64_t tick = 0;
+
+    // --- Level Rendering and Hot Reload ---
+    heapTag.change(HeapTag::Rendering);
+    // Pre-built vertex batches for the level's chunks.
+    LevelRenderCache levelRenderCache;
+    // Watches the level file (if any) for changes. When it is saved, the new
+    // version is loaded on a worker thread and only the chunks whose hashes
+    // changed are copied into the running level.
+    std::unique_ptr<FileWatcher> levelWatcher;
+    if (!levelPath.empty()) {
+        levelWatcher = std::make_unique<FileWatcher>(levelPath);
+    }
+    heapTag.change(HeapTag::Level);
+    LevelChunkHashes levelHashes;        // Chunk hashes of the running level.
+    std::future<PendingLevelReload> pendingReload; // The reload in progress, if any.
+    bool reloadRequested = false;        // File changed; start a reload when possible.
+    sf::Clock reloadClock;               // Measures change-to-applied latency.
+
+    // --- Effects Setup ---
+    // The particle system and the vertex batch it is drawn with. Both are
+    // created once here and reused every frame.
+    heapTag.change(HeapTag::Effects);
+    ParticleSystem particles(MAX_PARTICLES);
+    sf::VertexArray particleVertices(sf::PrimitiveType::Triangles);
+
+    // --- Character Animation ---
+    // The player is drawn as an animated sprite (see SpriteAnimation.hpp)
+    // whose clip follows their state: idle, run, jump or fall. The sheet and
+    // its clips are made once; the sprite only keeps a clip and a time.
+    // Until the sheet is ready the player is drawn as a plain rectangle.
+    heapTag.change(HeapTag::Rendering);
+    AnimationLibrary characterLibrary;
+    const CharacterClips characterClips = addCharacterClips(characterLibrary);
+    const Asset<sf::Texture> characterTexture = assets.generatedTexture("character", makeCharacterSheet);
+    SpriteAnimator sprites(characterLibrary, 1);
+    const std::size_t playerSprite = sprites.add(characterClips.idle, player.shape.getPosition(), player.shape.getSize() / 2.f);
+    sf::VertexArray spriteVertices(sf::PrimitiveType::Triangles);
+    bool playerFacesLeft = false;
+    // Points from collected items so far.
+    int score = 0;
+    heapTag.change(HeapTag::Snapshots);
+    // Bytes of the last quicksave/quickload, reused so F5/F9 don't reallocate.
+    std::vector<std::uint8_t> snapshotBuffer;
+
+    // --- Time Travel ---
+    // The last TIME_TRAVEL_SECONDS of ticks (see TimeTravel.hpp). F8 pauses
+    // the game; while paused, Left/Right step back and forth through the
+    // recorded ticks (ten at a time with Shift), and F8 returns to the
+    // present and resumes.
+    TickHistory history(TIME_TRAVEL_BYTES, TIME_TRAVEL_SECONDS * 60);
+    history.reset(currentLevel);
+    bool timeTraveling = false;
+    std::vector<sf::Vector2i> timeTravelTiles; // The tiles the last seek changed.
+    // Shows the recorded tick `target`: tiles, player and score as they were.
+    auto showRecordedTick = [&](std::uint64_t target) {
+        timeTravelTiles.clear();
+        history.seek(target, currentLevel, timeTravelTiles);
+        for (const sf::Vector2i& tile : timeTravelTiles) {
+            lights.tileChanged(currentLevel, tile.x, tile.y);
+            mipmap.tileChanged(currentLevel, tile.x, tile.y);
+            sand.wake(tile.x, tile.y);
+        }
+        TickHistory::TickState state;
+        if (!history.readTick(history.cursorTick(), state)) return;
+        applySnapshotEntity(state.player, player);
+        player.wake();
+        score = state.score;
+        std::cout << "Tick " << state.tick << " (" << (long long)state.tick - (long long)history.newestTick()
+                  << "): position (" << toFloat(state.player.x) << ", " << toFloat(state.player.y) << "), velocity ("
+                  << toFloat(state.player.vx) << ", " << toFloat(state.player.vy) << "), "
+                  << (state.player.onGround ? "on ground" : "in the air") << ", input "
+                  << (state.input.left ? "L" : "-") << (state.input.right ? "R" : "-") << (state.input.jump ? "J" : "-")
+                  << std::endl;
+    };
+
+    // --- Gameplay Events ---
+    // Gameplay code pushes events into its thread's queue during the tick;
+    // they are handed to the subscribers below in one batch per event type at
+    // the sync point after the simulation (events.dispatch()).
+    heapTag.change(HeapTag::Simulation);
+    GameEventBus events;
+    GameEventQueue& mainThreadEvents = events.createQueue();
+    player.events = &mainThreadEvents;
+    // Telemetry: how many events went through the bus (shown with F3).
+    unsigned long long eventCount = 0;
+
+    // Particles: dust at the player's feet on landing, more for harder landings.
+    events.subscribe<PlayerLandedEvent>([&](const PlayerLandedEvent* landings, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            ParticleBurst dust;
+            dust.position = landings[i].position;
+            dust.count = std::clamp(static_cast<int>(landings[i].speed * 2.f), 4, 40);
+            dust.spread = 2.5f;
+            dust.maxSpeed = 1.f + landings[i].speed * 0.2f;
+            dust.gravity = 0.05f;
+            dust.color = sf::Color(200, 180, 140);
+            particles.emit(dust);
+        }
+    });
+    // Particles: a sparkle in the item's color where it was picked up.
+    events.subscribe<ItemCollectedEvent>([&](const ItemCollectedEvent* items, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            ParticleBurst sparkle;
+            sparkle.position = {(items[i].tile.x + 0.5f) * TILE_SIZE, (items[i].tile.y + 0.5f) * TILE_SIZE};
+            sparkle.count = 32;
+            sparkle.spread = 6.2831853f; // Full circle.
+            sparkle.minSpeed = 2.f;
+            sparkle.maxSpeed = 5.f;
+            sparkle.gravity = 0.1f;
+            sparkle.size = 2.f;
+            sparkle.color = TILE_DEFINITIONS[items[i].type].color;
+            particles.emit(sparkle);
+        }
+    });
+    // Lighting: a picked-up item leaves Air behind (and gems stop glowing).
+    events.subscribe<ItemCollectedEvent>([&](const ItemCollectedEvent* items, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) lights.tileChanged(currentLevel, items[i].tile.x, items[i].tile.y);
+    });
+    // Minimap: the picked-up item disappears from it too.
+    events.subscribe<ItemCollectedEvent>([&](const ItemCollectedEvent* items, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) mipmap.tileChanged(currentLevel, items[i].tile.x, items[i].tile.y);
+    });
+    // Sand: what was resting on a picked-up item starts falling.
+    events.subscribe<ItemCollectedEvent>([&](const ItemCollectedEvent* items, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) sand.wake(items[i].tile.x, items[i].tile.y);
+    });
+    // Score: add the items' points and announce the new total.
+    events.subscribe<ItemCollectedEvent>([&](const ItemCollectedEvent* items, std::size_t count) {
+        int delta = 0;
+        for (std::size_t i = 0; i < count; ++i) delta += TILE_DEFINITIONS[items[i].type].score;
+        if (delta == 0) return;
+        score += delta;
+        mainThreadEvents.push(ScoreChangedEvent{score, delta});
+    });
+    // Console log: falling out of the level.
+    events.subscribe<PlayerFellOutEvent>([&](const PlayerFellOutEvent*, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) std::cout << "Player fell out of bounds!\n";
+    });
+    // Telemetry: count everything.
+    events.subscribe<PlayerLandedEvent>([&](const PlayerLandedEvent*, std::size_t count) { eventCount += count; });
+    events.subscribe<PlayerFellOutEvent>([&](const PlayerFellOutEvent*, std::size_t count) { eventCount += count; });
+    events.subscribe<ItemCollectedEvent>([&](const ItemCollectedEvent*, std::size_t count) { eventCount += count; });
+    events.subscribe<ScoreChangedEvent>([&](const ScoreChangedEvent*, std::size_t count) { eventCount += count; });
+
+    // --- Frame Memory and Debug Statistics ---
+    heapTag.change(HeapTag::Other);
+    // Transient per-frame data is allocated from this arena, which is reset at
+    // the end of every frame (see FrameArena.hpp).
+    FrameArena frameArena(FRAME_ARENA_BYTES);
+    // F3 toggles printing of per-frame statistics to the console.
+    bool showStats = false;
+    // Frame counter, and the largest number of heap allocations / arena bytes
+    // seen in a single frame since the last statistics line was printed.
+    unsigned long long frameNumber = 0;
+    unsigned long long maxHeapAllocations = 0;
+    std::size_t maxArenaBytes = 0;
+    // F7 prints the heap usage per subsystem; allocations per frame are
+    // counted from the previous report (or the start).
+    HeapUsage heapAtLastReport = readHeapUsage();
+    unsigned long long frameAtLastReport = 0;
+    // The startup timeline is printed once the first frame is on screen and
+    // the assets asked for during setup are in.
+    bool startupAssetsPending = true;
+    bool startupReported = false;
+    startup.mark("other setup");
+
 
     // --- Game Loop ---
     // The main loop runs continuously, processing one frame of the game per iteration.
     // Order of operations within the loop is important: Events -> Input -> Update -> Draw.
+    TRACE_THREAD_NAME("main");
     while (window.isOpen()) { // Loop continues as long as the window shouldn't close.
+        // Snapshot of the heap counters, used to count this frame's allocations.
+        HeapCounters heapAtFrameStart = readHeapCounters();
+        // The frame and its stages, for traces (F6).
+        TRACE_SCOPE("frame");
+        TRACE_STAGES(frameStage);
 
         // --- 1. Event Handling ---
+        TRACE_STAGE(frameStage, "events");
+        heapTag.change(HeapTag::Other);
         // Process window events (close button, keyboard presses/releases, mouse clicks, etc.)
         std::optional<sf::Event> optEvent;
         // Check for events in the queue. Use extra parentheses around assignment for clarity.
@@ -406,30 +567,228 @@ int main() {
                 if(auto* keyPressed = optEvent->getIf<sf::Event::KeyPressed>()) {
                     // Check the physical key location (scancode).
                     if (keyPressed->scancode == sf::Keyboard::Scan::Space || keyPressed->scancode == sf::Keyboard::Scan::Up) {
-                        player.jump(); // Trigger the player's jump action.
+                        input.jump = true; // Jump on the next simulation tick.
+                    }
+                    // Toggle the debug statistics.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::F3) {
+                        showStats = !showStats;
+                    }
+                    // Toggle tile lighting.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::L) {
+                        lightingEnabled = !lightingEnabled;
+                    }
+                    // Toggle the minimap.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::M) {
+                        minimapEnabled = !minimapEnabled;
+                    }
+                    // Cycle the camera zoom.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::Z) {
+                        zoomIndex = (zoomIndex + 1) % (sizeof(ZOOM_LEVELS) / sizeof(ZOOM_LEVELS[0]));
+                        gameView.setSize({WINDOW_WIDTH * ZOOM_LEVELS[zoomIndex], WINDOW_HEIGHT * ZOOM_LEVELS[zoomIndex]});
+                    }
+                    // Print how the heap splits between the subsystems.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::F7) {
+                        const HeapUsage usage = readHeapUsage();
+                        std::cout << formatHeapReport(usage, heapAtLastReport, frameNumber - frameAtLastReport) << std::flush;
+                        heapAtLastReport = usage;
+                        frameAtLastReport = frameNumber;
+                    }
+                    // Pause to step through the recorded ticks, or return to
+                    // the present and resume.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::F8) {
+                        if (timeTraveling) {
+                            showRecordedTick(history.newestTick());
+                            timeTraveling = false;
+                            input.jump = false;
+                        } else if (history.tickCount() > 0) {
+                            timeTraveling = true;
+                            std::cout << "Time travel: " << history.tickCount() << " ticks ("
+                                      << history.tickCount() / 60.f << " s) in " << history.usedBytes() / 1024
+                                      << " KB of records, " << history.memoryBytes() / 1024 << " KB in total" << std::endl;
+                        }
+                    }
+                    if (timeTraveling && (keyPressed->scancode == sf::Keyboard::Scan::Left ||
+                                          keyPressed->scancode == sf::Keyboard::Scan::Right)) {
+                        const std::uint64_t step = keyPressed->shift ? 10 : 1;
+                        const std::uint64_t cursor = history.cursorTick();
+                        if (keyPressed->scancode == sf::Keyboard::Scan::Left) {
+                            showRecordedTick(cursor - history.oldestTick() > step ? cursor - step : history.oldestTick());
+                        } else {
+                            showRecordedTick(cursor + step);
+                        }
+                    }
+                    // Save the recent frame timings for a trace viewer.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::F6) {
+                        sf::Clock traceClock;
+                        std::size_t spans = 0;
+                        std::string error;
+                        if (saveChromeTrace(TRACE_PATH, spans, error)) {
+                            std::cout << "Saved " << spans << " trace spans to " << TRACE_PATH.string() << " in "
+                                      << traceClock.getElapsedTime().asMicroseconds() / 1000.f << " ms" << std::endl;
+                        } else {
+                            std::cerr << "Error: " << error << std::endl;
+                        }
+                    }
+                    // Quicksave / quickload the whole game state.
+                    if (keyPressed->scancode == sf::Keyboard::Scan::F5) {
+                        HeapTagScope snapshotTag(HeapTag::Snapshots);
+                        sf::Clock saveClock;
+                        const SnapshotEntity entity = snapshotEntityFromPlayer(player);
+                        writeSnapshot(snapshotBuffer, {tick, particles.randomState(), score}, currentLevel, &entity, 1);
+                        std::string error;
+                        if (saveSnapshotFile(QUICKSAVE_PATH, snapshotBuffer, error)) {
+                            std::cout << "Quicksaved " << snapshotBuffer.size() << " bytes in "
+                                      << saveClock.getElapsedTime().asMicroseconds() / 1000.f << " ms" << std::endl;
+                        } else {
+                            std::cerr << "Error: " << error << std::endl;
+                        }
+                    }
+                    if (keyPressed->scancode == sf::Keyboard::Scan::F9) {
+                        HeapTagScope snapshotTag(HeapTag::Snapshots);
+                        sf::Clock loadClock;
+                        std::string error;
+                        SnapshotView snapshot;
+                        if (loadSnapshotFile(QUICKSAVE_PATH, snapshotBuffer, error) &&
+                            readSnapshot(snapshotBuffer.data(), snapshotBuffer.size(), snapshot, error)) {
+                            snapshotTag.change(HeapTag::Level);
+                            applySnapshotTiles(snapshot, currentLevel);
+                            snapshotTag.change(HeapTag::Lighting);
+                            lights.rebuild(currentLevel);
+                            snapshotTag.change(HeapTag::Rendering);
+                            mipmap.rebuild(currentLevel);
+                            snapshotTag.change(HeapTag::Simulation);
+                            sand.reset(currentLevel);
+                            background.setAnchor(backgroundAnchor(currentLevel));
+                            snapshotTag.change(HeapTag::Snapshots);
+                            if (snapshot.header.entityCount > 0) applySnapshotEntity(snapshot.entities[0], player);
+                            tick = snapshot.header.tick;
+                            particles.setRandomState(snapshot.header.rngState);
+                            score = snapshot.header.score;
+                            history.reset(currentLevel);
+                            timeTraveling = false;
+                            std::cout << "Quickloaded tick " << tick << " in "
+                                      << loadClock.getElapsedTime().asMicroseconds() / 1000.f << " ms" << std::endl;
+                        } else {
+                            std::cerr << "Error: could not quickload: " << error << std::endl;
+                        }
                     }
                 }
             }
         } // End of event polling loop
 
-        // --- 2. Input Handling (Continuous) ---
-        // Check the state of keys for actions that happen while held down (movement).
-        player.velocity.x = 0; // Reset horizontal velocity (player stops if no key is pressed).
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) {
-            player.velocity.x = -PLAYER_MOVE_SPEED; // Set velocity for left movement.
+        // --- Level Hot Reload ---
+        if (levelWatcher && levelWatcher->changed()) {
+            reloadRequested = true;
+        }
+        // Start loading on a worker thread (one reload at a time).
+        if (reloadRequested && !pendingReload.valid()) {
+            reloadRequested = false;
+            reloadClock.restart();
+            pendingReload = std::async(std::launch::async, loadLevelForReload, levelPath);
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) {
-            player.velocity.x = PLAYER_MOVE_SPEED; // Set velocity for right movement.
+        // When the worker is done, apply the changed chunks.
+        if (pendingReload.valid() && pendingReload.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            PendingLevelReload reload = pendingReload.get();
+            if (reload.ok) {
+                HeapTagScope reloadTag(HeapTag::Level);
+                LevelReloadResult result = applyLevelReload(currentLevel, levelHashes, reload.level, reload.hashes);
+                if (result.resized) {
+                    reloadTag.change(HeapTag::Lighting);
+                    lights.rebuild(currentLevel);
+                    reloadTag.change(HeapTag::Rendering);
+                    mipmap.rebuild(currentLevel);
+                    reloadTag.change(HeapTag::Simulation);
+                    sand.reset(currentLevel);
+                    background.setAnchor(backgroundAnchor(currentLevel));
+                } else {
+                    // Same size: only the copied chunks are relit, summarized
+                    // again and woken up for the falling sand.
+                    for (const sf::Vector2i& chunk : result.changedChunks) {
+                        const int x0 = chunk.x * CHUNK_SIZE, y0 = chunk.y * CHUNK_SIZE;
+                        const int x1 = std::min(x0 + CHUNK_SIZE, (int)currentLevel.size.x) - 1;
+                        const int y1 = std::min(y0 + CHUNK_SIZE, (int)currentLevel.size.y) - 1;
+                        reloadTag.change(HeapTag::Lighting);
+                        lights.regionChanged(currentLevel, x0, y0, x1, y1);
+                        reloadTag.change(HeapTag::Rendering);
+                        mipmap.regionChanged(currentLevel, x0, y0, x1, y1);
+                        reloadTag.change(HeapTag::Simulation);
+                        sand.wake(x0, y0, x1, y1);
+                    }
+                }
+                if (result.chunksChanged > 0) {
+                    // The recorded ticks are changes to the old tiles, so
+                    // time travel can't step back past a reload.
+                    reloadTag.change(HeapTag::Snapshots);
+                    history.reset(currentLevel);
+                    timeTraveling = false;
+                }
+                std::cout << "Reloaded " << levelPath.string() << " in "
+                          << reloadClock.getElapsedTime().asMicroseconds() / 1000.f << " ms: "
+                          << result.chunksChanged << "/" << result.chunksTotal << " chunks changed"
+                          << (result.resized ? " (level resized)" : "") << std::endl;
+            } else {
+                std::cerr << "Error: could not reload level: " << reload.error << std::endl;
+            }
         }
 
-        // --- 3. Game Logic / Updates ---
-        // Update the state of all game objects based on physics, input, AI, etc.
-        player.applyGravity();                // Apply gravity to the player.
-        player.handleCollision(currentLevel); // Resolve collisions with solid tiles.
-        player.handleLevelBounds(currentLevel);// Resolve collisions with level edges.
-        player.updatePosition();              // Apply final velocity to move the player.
+        TRACE_STAGE(frameStage, "physics");
+        heapTag.change(HeapTag::Simulation);
+        // While time traveling the game stands still at the tick shown.
+        if (!timeTraveling) {
+            // --- 2. Input Handling (Continuous) ---
+            // Check the state of keys for actions that happen while held down (movement).
+            input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left);
+            input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right);
+
+            // --- 3. Game Logic / Updates ---
+            // Update the state of all game objects based on physics, input, AI, etc.
+            // Jump, move, apply gravity and resolve collisions (see Player::step).
+            const PlayerInput tickInput = input;
+            player.step(input, currentLevel);
+            input.jump = false; // A jump press is only used for one tick.
+            ++tick;
+            // Collectibles: pick up any the player touches (reported as events).
+            player.collectItems(currentLevel);
+            // Hazards: touching one (e.g. spikes) sends the player back to the start.
+            if (player.touchesTile<TILE_HAZARD>(currentLevel)) {
+                player.respawn(currentLevel);
+            }
+            // Sand and water move after the player, so collision next tick sees
+            // where they ended up. A few moved tiles are relit (and updated in the
+            // mipmap) one by one; a big avalanche is cheaper to redo a chunk's
+            // changed rectangle at a time.
+            sand.step(currentLevel);
+            if (sand.changedTiles().size() > SAND_RELIGHT_LIMIT) {
+                for (const SandSimulation::Rect& region : sand.changedRegions()) {
+                    lights.regionChanged(currentLevel, region.x0, region.y0, region.x1, region.y1);
+                    mipmap.regionChanged(currentLevel, region.x0, region.y0, region.x1, region.y1);
+                }
+            } else {
+                for (const sf::Vector2i& tile : sand.changedTiles()) {
+                    lights.tileChanged(currentLevel, tile.x, tile.y);
+                    mipmap.tileChanged(currentLevel, tile.x, tile.y);
+                }
+            }
+            // Clear the occupancy bits of chunks this tick emptied (collected
+            // coins, sand that fell away), so scans skip them from now on.
+            currentLevel.refreshOccupancy();
+
+            // --- Gameplay Events ---
+            // Sync point: everything reported during the tick reaches its
+            // subscribers (effects, score, log, telemetry) here.
+            events.dispatch();
+            heapTag.change(HeapTag::Effects);
+            particles.update(); // Move all particles and remove expired ones.
+            sprites.update();   // Advance the sprites' animations by a tick.
+
+            // --- Time Travel ---
+            heapTag.change(HeapTag::Snapshots);
+            history.record(tick, currentLevel, snapshotEntityFromPlayer(player), tickInput, score);
+        }
 
         // --- Update View Position ---
+        TRACE_STAGE(frameStage, "camera");
+        heapTag.change(HeapTag::Other);
         // Center the camera (view) on the player's current position.
         sf::Vector2f viewCenter = player.shape.getPosition();
 
@@ -461,6 +820,15 @@ int main() {
 
         // --- 4. Rendering ---
         // Draw the visual representation of the game state to the window.
+        TRACE_STAGE(frameStage, "draw");
+        heapTag.change(HeapTag::Rendering);
+        if (frameNumber == 0) startup.mark("first frame: events, physics");
+        // Turn the assets that finished loading into textures.
+        assets.update(ASSET_FINISH_BUDGET);
+        if (startupAssetsPending && assets.pendingCount() == 0) {
+            startup.record("background assets", assetsRequested, StartupTimeline::Clock::now());
+            startupAssetsPending = false;
+        }
 
         // Clear the previous frame's content with a background color.
         window.clear(sf::Color(100, 150, 255));
@@ -470,20 +838,105 @@ int main() {
         // position and zoom level, effectively applying the camera.
         window.setView(gameView);
 
+        // The parallax layers go behind everything in the world.
+        background.draw(window, gameView);
+
         // Draw elements that exist within the game world (affected by the camera).
-        drawLevel(window, currentLevel); // Draw the visible parts of the level.
-        window.draw(player.shape);       // Draw the player.
-
-        // --- Optional: Draw HUD/UI Elements ---
-        // If you had a score display, health bar, etc., that should stay fixed on the
-        // screen regardless of camera movement, you would:
-        // 1. Reset the view to the window's default view:
-        //    window.setView(window.getDefaultView());
-        // 2. Draw the HUD elements using screen coordinates:
-        //    window.draw(scoreTextHUD); // Assuming scoreTextHUD was defined and positioned earlier.
-
-        // Display the completed frame on the window.
+        // Draw the visible parts of the level, or all of it from the mipmap
+        // when zoomed out so far that tiles are only a few pixels big.
+        if (TILE_SIZE / ZOOM_LEVELS[zoomIndex] < OVERVIEW_TILE_PIXELS) {
+            drawLevelOverview(window, currentLevel, mipmap);
+        } else {
+            drawLevel(window, currentLevel, levelRenderCache, lightingEnabled ? &lights : nullptr);
+        }
+        // Draw every particle with a single draw call.
+        particles.buildVertices(particleVertices);
+        window.draw(particleVertices);
+        // Draw the player's sprite in the pose their state calls for, facing
+        // the way they last moved.
+        if (player.velocity.x != PhysicsScalar()) playerFacesLeft = player.velocity.x < PhysicsScalar();
+        if (const sf::Texture* sheet = characterTexture.get()) {
+            sprites.play(playerSprite, characterClip(characterClips, player));
+            sprites.setPosition(playerSprite, player.shape.getPosition(), playerFacesLeft);
+            sprites.buildVertices(spriteVertices);
+            window.draw(spriteVertices, sheet);
+        } else {
+            window.draw(player.shape);
+        }
+
+        // --- Draw HUD/UI Elements ---
+        // HUD elements stay fixed on the screen regardless of camera movement,
+        // so they are drawn in the window's default view, in screen coordinates.
+        if (minimapEnabled) {
+            window.setView(window.getDefaultView());
+            drawMinimap(window, currentLevel, mipmap, minimapShapes, gameView, player.shape.getPosition());
+        }
+
+        if (frameNumber == 0) startup.mark("first frame: draw");
+
+        // Display the completed frame on the window (this waits for vsync).
+        TRACE_STAGE(frameStage, "display");
         window.display();
+        if (frameNumber == 0) startup.mark("first frame: display");
+        if (!startupReported && !startupAssetsPending) {
+            std::cout << startup.report() << std::flush;
+            startupReported = true;
+        }
+
+        TRACE_STAGE(frameStage, "statistics");
+        heapTag.change(HeapTag::Other);
+
+        // --- 5. Frame Statistics ---
+        // Count the heap allocations made during this frame. After the first few
+        // frames (when containers reach their working size) this should be 0.
+        HeapCounters heapAtFrameEnd = readHeapCounters();
+        maxHeapAllocations = std::max(maxHeapAllocations, (unsigned long long)(heapAtFrameEnd.allocations - heapAtFrameStart.allocations));
+        maxArenaBytes = std::max(maxArenaBytes, frameArena.used());
+        ++frameNumber;
+        if (showStats && frameNumber % STATS_INTERVAL_FRAMES == 0) {
+            // The statistics line itself is built in the frame arena.
+            FrameString line{FrameAllocator<char>(frameArena)};
+            line.reserve(256);
+            line += "frame ";
+            appendNumber(line, frameNumber);
+            line += " | heap allocs/frame (max) ";
+            appendNumber(line, maxHeapAllocations);
+            line += ", live ";
+            appendNumber(line, heapAtFrameEnd.liveBytes / 1024);
+            line += " KB";
+            line += " | arena ";
+            appendNumber(line, maxArenaBytes);
+            line += "/";
+            appendNumber(line, frameArena.capacity());
+            line += " bytes, overflows ";
+            appendNumber(line, frameArena.overflowAllocations());
+            line += " | particles ";
+            appendNumber(line, particles.size());
+            line += " | score ";
+            appendNumber(line, (unsigned long long)score);
+            line += " | events ";
+            appendNumber(line, eventCount);
+            line += " (dropped ";
+            appendNumber(line, events.dropped());
+            line += ")";
+            line += player.isAsleep() ? " | player asleep" : " | player awake";
+            line += " | parallax ";
+            appendNumber(line, background.lastDrawnLayers());
+            line += "/";
+            appendNumber(line, background.layerCount());
+            line += " layers";
+            line += " | history ";
+            appendNumber(line, history.tickCount());
+            line += " ticks, ";
+            appendNumber(line, history.usedBytes() / 1024);
+            line += " KB";
+            line += '\n';
+            std::cout.write(line.data(), (std::streamsize)line.size());
+            maxHeapAllocations = 0;
+            maxArenaBytes = 0;
+        }
+        // Everything allocated from the arena this frame is released at once.
+        frameArena.reset();
     } // End of main game loop
 
     return 0; // Indicate successful program termination.
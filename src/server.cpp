@@ -0,0 +1,219 @@
+// --- Headless Game Server ---
+// Runs the Level/Player simulation without a window. Clients (see bots.cpp)
+// connect over UDP on localhost, send their inputs, and receive a snapshot of
+// all players every tick, delta compressed against the last snapshot they
+// acknowledged (see NetProtocol.hpp).
+//
+// Usage: server [seconds]   (runs until closed if no duration is given)
+// Once per second it prints the tick cost and the bandwidth sent per client.
+
+// --- Includes ---
+// SFML's network module provides sf::UdpSocket and sf::IpAddress.
+#include <SFML/Network.hpp>
+// Our own headers: the level, the player simulation and the wire format.
+#include "Level.hpp"
+#include "Player.hpp"
+#include "NetProtocol.hpp"
+// This header provides std::sort and std::max.
+#include <algorithm>
+// This header provides std::chrono clocks, used for the fixed tick rate and timing.
+#include <chrono>
+// This header provides std::printf for the statistics lines.
+#include <cstdio>
+// This header provides std::atoi for the command line argument.
+#include <cstdlib>
+// This header provides std::optional, used by sf::UdpSocket::receive.
+#include <optional>
+// This header provides std::this_thread::sleep_until, used to wait for the next tick.
+#include <thread>
+// This header provides std::unordered_map, used to look clients up by address.
+#include <unordered_map>
+// This header provides std::vector.
+#include <vector>
+
+// --- Connected Clients ---
+
+// Everything the server knows about one connected client.
+struct Client {
+    sf::IpAddress address;                // Where to send this client's snapshots.
+    unsigned short port;
+    std::uint16_t entityId;               // The player entity this client controls.
+    Player player;                        // That player's simulation state.
+    PlayerInput input;                    // Buttons currently held.
+    bool jumpHeld = false;                // Jump button state last tick (for edge detection).
+    std::uint32_t lastInputSequence = 0;  // Newest input packet seen (older ones are ignored).
+    std::uint32_t ackedTick = 0;          // Newest snapshot the client confirmed receiving.
+    std::uint32_t lastHeardTick = 0;      // Server tick of the last packet from this client.
+    bool disconnected = false;            // Said goodbye; removed at the next tick.
+
+    Client(sf::IpAddress address, unsigned short port, std::uint16_t entityId, sf::Vector2f spawn)
+        : address(address), port(port), entityId(entityId), player(spawn) {}
+};
+
+// Combines an IPv4 address and port into one key for the client lookup table.
+static std::uint64_t endpointKey(sf::IpAddress address, unsigned short port) {
+    return ((std::uint64_t)address.toInteger() << 16) | port;
+}
+
+int main(int argc, char** argv) {
+    // How long to run (0 = forever), from the first command line argument.
+    const int runSeconds = (argc > 1) ? std::atoi(argv[1]) : 0;
+
+    // --- Network Setup ---
+    sf::UdpSocket socket;
+    if (socket.bind(SERVER_PORT, sf::IpAddress::LocalHost) != sf::Socket::Status::Done) {
+        std::fprintf(stderr, "Error: could not bind UDP port %u\n", (unsigned)SERVER_PORT);
+        return 1;
+    }
+    // Non-blocking: receive() returns NotReady instead of waiting for data.
+    socket.setBlocking(false);
+
+    // --- World Setup ---
+    Level level = createSimpleLevel();
+    // The server's level never changes, so one scan of its occupancy bits
+    // lasts the whole session.
+    level.refreshOccupancy();
+    const sf::Vector2f spawn = {TILE_SIZE * 1.5f, TILE_SIZE * (level.size.y - 3.f)};
+    std::vector<Client> clients;
+    std::unordered_map<std::uint64_t, std::size_t> clientIndex; // endpoint -> index in `clients`
+    std::uint16_t nextEntityId = 1;
+
+    SnapshotHistory history; // Recent world snapshots, used as delta baselines.
+    Snapshot world;          // The snapshot being built this tick.
+    std::uint32_t tick = 0;
+
+    // --- Statistics ---
+    double tickSeconds = 0.0;     // Time spent simulating + encoding + sending.
+    double worstTickSeconds = 0.0;
+    std::uint64_t bytesSent = 0;
+    std::uint64_t snapshotsSent = 0;
+    std::uint64_t fullSnapshots = 0; // Snapshots sent without a baseline.
+
+    std::printf("server: listening on 127.0.0.1:%u at %d ticks/second\n", (unsigned)SERVER_PORT, SERVER_TICK_RATE);
+
+    const auto tickDuration = std::chrono::microseconds(1000000 / SERVER_TICK_RATE);
+    auto nextTick = std::chrono::steady_clock::now();
+    std::uint8_t datagram[sf::UdpSocket::MaxDatagramSize];
+
+    while (runSeconds == 0 || tick < (std::uint32_t)(runSeconds * SERVER_TICK_RATE)) {
+        ++tick;
+
+        // --- 1. Receive ---
+        // Drain every datagram that arrived since the last tick.
+        std::size_t received = 0;
+        std::optional<sf::IpAddress> sender;
+        unsigned short senderPort = 0;
+        while (socket.receive(datagram, sizeof(datagram), received, sender, senderPort) == sf::Socket::Status::Done) {
+            if (!sender || received == 0) continue;
+            ByteReader in(datagram, received);
+            const PacketType type = (PacketType)in.readU8();
+            const std::uint64_t key = endpointKey(*sender, senderPort);
+            auto known = clientIndex.find(key);
+
+            if (type == PacketType::Connect) {
+                // New client (or a repeated connect whose Welcome got lost).
+                if (known == clientIndex.end()) {
+                    clientIndex[key] = clients.size();
+                    clients.emplace_back(*sender, senderPort, nextEntityId++, spawn);
+                    known = clientIndex.find(key);
+                }
+                Client& client = clients[known->second];
+                client.lastHeardTick = tick;
+                std::uint8_t reply[8];
+                ByteWriter out(reply, sizeof(reply));
+                out.writeU8((std::uint8_t)PacketType::Welcome);
+                out.writeVarint(client.entityId);
+                (void)socket.send(reply, out.size(), client.address, client.port);
+            } else if (known != clientIndex.end()) {
+                Client& client = clients[known->second];
+                client.lastHeardTick = tick;
+                if (type == PacketType::Input) {
+                    const std::uint32_t sequence = in.readVarint();
+                    const std::uint32_t ack = in.readVarint();
+                    const std::uint8_t buttons = in.readU8();
+                    if (!in.ok()) continue;
+                    if (ack > client.ackedTick && ack <= tick) client.ackedTick = ack;
+                    if (sequence <= client.lastInputSequence) continue; // Late, reordered packet.
+                    client.lastInputSequence = sequence;
+                    client.input.left = (buttons & ButtonLeft) != 0;
+                    client.input.right = (buttons & ButtonRight) != 0;
+                    // Jump is triggered when the button goes down, not while held.
+                    const bool jumpDown = (buttons & ButtonJump) != 0;
+                    if (jumpDown && !client.jumpHeld) client.input.jump = true;
+                    client.jumpHeld = jumpDown;
+                } else if (type == PacketType::Disconnect) {
+                    client.disconnected = true; // Removed below.
+                }
+            }
+        }
+
+        auto tickStart = std::chrono::steady_clock::now();
+
+        // --- 2. Drop silent clients ---
+        for (std::size_t i = 0; i < clients.size();) {
+            if (clients[i].disconnected || tick - clients[i].lastHeardTick > CLIENT_TIMEOUT_TICKS) {
+                clientIndex.erase(endpointKey(clients[i].address, clients[i].port));
+                if (i != clients.size() - 1) {
+                    clients[i] = std::move(clients.back());
+                    clientIndex[endpointKey(clients[i].address, clients[i].port)] = i;
+                }
+                clients.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        // --- 3. Simulate ---
+        // Exactly the same player code as the game (Player::step).
+        for (Client& client : clients) {
+            client.player.step(client.input, level);
+            client.input.jump = false;
+        }
+
+        // --- 4. Build and remember this tick's snapshot ---
+        world.tick = tick;
+        world.entities.clear();
+        for (const Client& client : clients) {
+            world.entities.push_back(NetEntity::fromPlayer(client.entityId, client.player));
+        }
+        std::sort(world.entities.begin(), world.entities.end(),
+                  [](const NetEntity& a, const NetEntity& b) { return a.id < b.id; });
+        history.store(world);
+
+        // --- 5. Send each client its delta ---
+        for (const Client& client : clients) {
+            const Snapshot* baseline = history.find(client.ackedTick);
+            if (baseline == nullptr) ++fullSnapshots;
+            ByteWriter out(datagram, sizeof(datagram));
+            encodeSnapshot(world, baseline, out);
+            if (out.overflow()) continue; // World too large for one datagram.
+            (void)socket.send(datagram, out.size(), client.address, client.port);
+            bytesSent += out.size();
+            ++snapshotsSent;
+        }
+
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tickStart).count();
+        tickSeconds += elapsed;
+        worstTickSeconds = std::max(worstTickSeconds, elapsed);
+
+        // --- 6. Report once per second ---
+        if (tick % SERVER_TICK_RATE == 0) {
+            const double perClient = clients.empty() ? 0.0 : (double)bytesSent / clients.size();
+            std::size_t asleep = 0;
+            for (const Client& client : clients) asleep += client.player.isAsleep() ? 1 : 0;
+            std::printf("tick %u | clients %zu (%zu awake, %zu asleep) | tick cost avg %.3f ms, max %.3f ms | "
+                        "sent %.1f KiB/s total, %.0f B/s per client, %.0f B/snapshot | full snapshots %llu\n",
+                        tick, clients.size(), clients.size() - asleep, asleep, tickSeconds * 1000.0 / SERVER_TICK_RATE,
+                        worstTickSeconds * 1000.0,
+                        bytesSent / 1024.0, perClient, snapshotsSent ? (double)bytesSent / snapshotsSent : 0.0,
+                        (unsigned long long)fullSnapshots);
+            tickSeconds = worstTickSeconds = 0.0;
+            bytesSent = snapshotsSent = fullSnapshots = 0;
+        }
+
+        // --- 7. Wait for the next tick ---
+        nextTick += tickDuration;
+        std::this_thread::sleep_until(nextTick);
+    }
+    return 0;
+}
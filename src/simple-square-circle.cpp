@@ -13,6 +13,8 @@
 // Include the C++ standard library header for filesystem operations, specifically std::filesystem::path for file paths.
 // Required for SFML 3's font loading function.
 #include <filesystem>
+// Include our asset manager, which loads the font on a worker thread (see AssetManager.hpp).
+#include "AssetManager.hpp"
 
 // The main function - entry point of the program.
 int main() {
@@ -26,30 +28,21 @@ int main() {
     window.setFramerateLimit(60);
 
     // --- Font and Text Setup ---
-    // Create an sf::Font object to hold font data.
-    sf::Font font;
+    // The asset manager loads files on worker threads, so the game starts
+    // right away instead of waiting for the font.
+    AssetManager assets;
     // Define the path to the font file using std::filesystem::path.
-    // IMPORTANT: Ensure this font file (e.g., "arial.ttf") exists in the same
-    // directory as the compiled executable, or provide the full, correct path.
+    // Ensure this font file (e.g., "arial.ttf") exists in the same directory as
+    // the compiled executable, or provide the full, correct path. Without it
+    // the game still runs, just without the score text.
     std::filesystem::path fontPath = "arial.ttf";
-    // Attempt to load the font data from the specified file path.
-    // SFML 3 uses openFromFile for loading resources like fonts.
-    if (!font.openFromFile(fontPath)) {
-        // If loading fails, print an error message to the standard error stream.
-        std::cerr << "Error: Could not load font '" << fontPath.string() << "'. Make sure it's in the correct path." << std::endl;
-        // Return a non-zero value to indicate an error occurred.
-        return 1;
-    }
-
-    // Create an sf::Text object to display text on the screen.
-    // Initialize it with the initial string, the loaded font object, and the character size (in pixels).
-    // Note: Character size needs to be explicitly cast to unsigned int for the SFML 3 constructor.
-    sf::Text scoreText(font,"Score: 0");
-    // Set the color of the text. sf::Color provides predefined colors.
-    scoreText.setFillColor(sf::Color::White);
-    // Set the position of the text's top-left corner on the window.
-    // Uses braced initialization {} for the sf::Vector2f position.
-    scoreText.setPosition({10.f, 10.f});
+    // Start loading the font. The handle's font is ready a few frames later.
+    Asset<sf::Font> font = assets.font(fontPath);
+
+    // The sf::Text that displays the score. It needs a font to be created, so
+    // it is created once the font is ready (std::optional holds "no text yet").
+    std::optional<sf::Text> scoreText;
+    bool fontErrorShown = false;
 
     // --- Game Object Setup ---
     // Player (Circle)
@@ -82,6 +75,21 @@ int main() {
     // --- Game Loop ---
     // The main loop continues as long as the window is open.
     while (window.isOpen()) {
+        // --- Assets ---
+        // Finish loaded assets, spending at most 2 ms of the frame on it.
+        assets.update(std::chrono::microseconds(2000));
+        if (!scoreText && font.ready()) {
+            // Initialize the text with the string, the loaded font, and set its color and position.
+            scoreText.emplace(*font.get(), "Score: " + std::to_string(score));
+            scoreText->setFillColor(sf::Color::White);
+            scoreText->setPosition({10.f, 10.f});
+        }
+        if (font.failed() && !fontErrorShown) {
+            // If loading failed, print an error message once and carry on without text.
+            std::cerr << "Error: Could not load font '" << fontPath.string() << "': " << font.error() << std::endl;
+            fontErrorShown = true;
+        }
+
         // --- Event Handling ---
         // Process events that have occurred since the last loop iteration.
         // sf::Event is a union holding data about different event types.
@@ -155,7 +163,7 @@ int main() {
             score++;
             // Update the score text string displayed on the screen.
             // std::to_string converts the integer score to a std::string.
-            scoreText.setString("Score: " + std::to_string(score));
+            if (scoreText) scoreText->setString("Score: " + std::to_string(score));
 
             // Respawn the enemy at a new position.
             // This uses simple modulo arithmetic for a pseudo-random effect.
@@ -194,7 +202,7 @@ int main() {
         // The order of drawing matters; objects drawn later appear on top.
         window.draw(player);    // Draw the player circle.
         window.draw(enemy);     // Draw the enemy rectangle.
-        window.draw(scoreText); // Draw the score text.
+        if (scoreText) window.draw(*scoreText); // Draw the score text (once the font is loaded).
 
         // Display the contents of the back buffer on the screen.
         // This swaps the buffers and makes everything drawn since the last clear visible.